@@ -19,6 +19,8 @@ public class JsonBP : ModuleRules
 			new string[]
 			{
 				"Core",
+				"CoreUObject",
+				"Engine",
 				// ... add other public dependencies that you statically link with here ...
 			});
 			
@@ -26,10 +28,9 @@ public class JsonBP : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
-				"CoreUObject",
-                "Engine",
                 "Json",
                 "JsonUtilities",
+                "Projects",
 				// ... add private dependencies that you statically link with here ...	
 			});
     }
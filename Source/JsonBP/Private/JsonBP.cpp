@@ -2,21 +2,171 @@
 
 #include "JsonBP.h"
 #include "JsonObject.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPReader.h"
+#include "JsonBPWriter.h"
+#include "JsonBPValueBuilder.h"
+#include "JsonBPPath.h"
+#include "JsonBPDocument.h"
+#include "JsonBPPool.h"
+#include "JsonBPParallel.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/CoreDelegates.h"
+
+DEFINE_LOG_CATEGORY(LogJsonBP);
+
+DEFINE_STAT(STAT_JsonBP_Parse);
+DEFINE_STAT(STAT_JsonBP_BuildTree);
+DEFINE_STAT(STAT_JsonBP_ParseDocument);
+DEFINE_STAT(STAT_JsonBP_Stringify);
+DEFINE_STAT(STAT_JsonBP_ToCPPVersion);
+DEFINE_STAT(STAT_JsonBP_MakeFromCPPVersion);
+DEFINE_STAT(STAT_JsonBP_StructConversion);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live UJsonValues"), STAT_JsonBP_LiveValues, STATGROUP_JsonBP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("UJsonValues made per frame"), STAT_JsonBP_ValuesCreated, STATGROUP_JsonBP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes parsed per frame"), STAT_JsonBP_BytesParsed, STATGROUP_JsonBP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes written per frame"), STAT_JsonBP_BytesEmitted, STATGROUP_JsonBP);
+
+CSV_DEFINE_CATEGORY(JsonBP, true);
+
+#if JSONBP_STATS
+FThreadSafeCounter FJsonBPCounters::LiveValues;
+FThreadSafeCounter FJsonBPCounters::ValuesCreated;
+FThreadSafeCounter FJsonBPCounters::BytesParsed;
+FThreadSafeCounter FJsonBPCounters::BytesEmitted;
+
+static void JsonBPPublishCounters()
+{
+	const int32 liveValues = FJsonBPCounters::LiveValues.GetValue();
+	const int32 valuesCreated = FJsonBPCounters::ValuesCreated.Reset();
+	const int32 bytesParsed = FJsonBPCounters::BytesParsed.Reset();
+	const int32 bytesEmitted = FJsonBPCounters::BytesEmitted.Reset();
+
+	SET_DWORD_STAT(STAT_JsonBP_LiveValues, liveValues);
+	SET_DWORD_STAT(STAT_JsonBP_ValuesCreated, valuesCreated);
+	SET_DWORD_STAT(STAT_JsonBP_BytesParsed, bytesParsed);
+	SET_DWORD_STAT(STAT_JsonBP_BytesEmitted, bytesEmitted);
+
+	CSV_CUSTOM_STAT(JsonBP, LiveValues, liveValues, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(JsonBP, ValuesCreated, valuesCreated, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(JsonBP, BytesParsed, bytesParsed, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(JsonBP, BytesEmitted, bytesEmitted, ECsvCustomStatOp::Set);
+}
+#endif
+
+static TAutoConsoleVariable<int32> CVarJsonBPParallelMinLength(
+	TEXT("JsonBP.Parallel.MinLength"),
+	256 * 1024,
+	TEXT("shortest text in characters that is parsed in parallel when asked to, shorter text is parsed on the calling thread"));
+
+static TAutoConsoleVariable<int32> CVarJsonBPParallelMinItemsPerChunk(
+	TEXT("JsonBP.Parallel.MinItemsPerChunk"),
+	64,
+	TEXT("fewest top level items a parallel piece gets, containers with less than two pieces worth of items are done on the calling thread"));
 
 
 void FJsonBPModule::StartupModule()
 {
+#if JSONBP_STATS
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&JsonBPPublishCounters);
+#endif
 }
 
 void FJsonBPModule::ShutdownModule()
 {
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
 }
 
 IMPLEMENT_MODULE(FJsonBPModule, JsonBP)
 
 
 
-TSharedPtr<FJsonValue> HelperParseJSON(const FString& jsonValue)
+int32 JsonBPGetParallelChunks(int32 numItems)
+{
+	//a few pieces per worker so uneven items still keep all of them busy
+	const int32 minItemsPerChunk = FMath::Max(CVarJsonBPParallelMinItemsPerChunk.GetValueOnAnyThread(), 1);
+	const int32 maxChunks = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1) * 4;
+	return FMath::Clamp(numItems / minItemsPerChunk, 1, maxChunks);
+}
+
+bool JsonBPShouldParseParallel(int32 length)
+{
+	return length >= CVarJsonBPParallelMinLength.GetValueOnAnyThread() && FPlatformProcess::SupportsMultithreading();
+}
+
+/*
+parses the items of a top level array/object in pieces on worker threads and puts them together in order.
+anything that isn't a large array/object goes to the serial reader, so do invalid items: the error is the same as without bParallel
+*/
+template<typename CharType> static TSharedPtr<FJsonValue> HelperParseJSONParallel(const CharType* text, int32 length)
+{
+	bool bObject = false;
+	TArray<FJsonBPItemBounds> items;
+	if (!JsonBPSplitTopLevel(text, length, bObject, items))
+		return nullptr;
+
+	const int32 numChunks = JsonBPGetParallelChunks(items.Num());
+	if (numChunks < 2)
+		return nullptr;
+
+	TArray<TSharedPtr<FJsonValue>> values;
+	TArray<FString> keys;
+	values.SetNum(items.Num());
+	if (bObject)
+		keys.SetNum(items.Num());
+
+	FThreadSafeBool bFailed = false;
+	ParallelFor(numChunks, [&](int32 chunk)
+	{
+		const int32 first = (int32)((int64)items.Num() * chunk / numChunks);
+		const int32 last = (int32)((int64)items.Num() * (chunk + 1) / numChunks);
+		for (int32 i = first; i < last && !bFailed; i++)
+		{
+			const FJsonBPItemBounds& item = items[i];
+			int32 valueStart = item.Start;
+			if (bObject)
+			{
+				//the key is read as a string value, which unescapes it the same way
+				FJsonBPCPPValueBuilder keyBuilder;
+				TJsonBPReader<CharType> keyReader(text + item.Start, item.Colon == INDEX_NONE ? 0 : item.Colon - item.Start);
+				if (item.Colon == INDEX_NONE || !keyReader.ReadFragment(keyBuilder, 1) || keyBuilder.GetResult()->Type != EJson::String)
+				{
+					bFailed = true;
+					return;
+				}
+				keys[i] = keyBuilder.GetResult()->AsString();
+				valueStart = item.Colon + 1;
+			}
+
+			FJsonBPCPPValueBuilder builder;
+			TJsonBPReader<CharType> reader(text + valueStart, item.End - valueStart);
+			if (!reader.ReadFragment(builder, 1))
+			{
+				bFailed = true;
+				return;
+			}
+			values[i] = builder.GetResult();
+		}
+	});
+
+	if (bFailed)
+		return nullptr;
+
+	if (!bObject)
+		return MakeShared<FJsonValueArray>(values);
+
+	//in order, a repeated key keeps the last value like the serial reader does
+	TSharedPtr<FJsonObject> jsObject = MakeShared<FJsonObject>();
+	jsObject->Values.Reserve(items.Num());
+	for (int32 i = 0; i < items.Num(); i++)
+		jsObject->Values.Add(MoveTemp(keys[i]), MoveTemp(values[i]));
+	return MakeShared<FJsonValueObject>(jsObject);
+}
+
+TSharedPtr<FJsonValue> HelperParseJSON(const FString& jsonValue, bool bParallel)
 {
 #if 0
 	static FString Str_null("null");
@@ -48,21 +198,46 @@ TSharedPtr<FJsonValue> HelperParseJSON(const FString& jsonValue)
 	/*
 	#Note
 		FJsonSerializer::Deserialize cant handle types other than [] and {}
+		so we read with TJsonBPReader which accepts any value and doesn't need the "[...]" wrapper copy
 	*/
-	FString arrayedJson;
-	arrayedJson.Reserve(jsonValue.Len() + 8);
-	arrayedJson += TEXT("[");
-	arrayedJson += jsonValue;
-	arrayedJson += TEXT("]");
+	JSONBP_SCOPE(Parse);
+	JSONBP_COUNT(BytesParsed, jsonValue.Len() * sizeof(TCHAR));
+	if (bParallel && JsonBPShouldParseParallel(jsonValue.Len()))
+	{
+		TSharedPtr<FJsonValue> result = HelperParseJSONParallel(*jsonValue, jsonValue.Len());
+		if (result.IsValid())
+			return result;
+	}
+
+	TJsonBPReader<TCHAR> reader(*jsonValue, jsonValue.Len());
+	FJsonBPCPPValueBuilder builder;
+	if (!reader.ReadDocument(builder))
+	{
+		return nullptr;
+	}
+
+	return builder.GetResult();
+}
+
+TSharedPtr<FJsonValue> HelperParseJSONUTF8(TArrayView<const uint8> bytes, bool bParallel)
+{
+	JSONBP_SCOPE(Parse);
+	JSONBP_COUNT(BytesParsed, bytes.Num());
+	if (bParallel && JsonBPShouldParseParallel(bytes.Num()))
+	{
+		TSharedPtr<FJsonValue> result = HelperParseJSONParallel((const ANSICHAR*)bytes.GetData(), bytes.Num());
+		if (result.IsValid())
+			return result;
+	}
 
-	TArray<TSharedPtr<FJsonValue>> resultArray;
-	TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(arrayedJson);
-	if (!FJsonSerializer::Deserialize(JsonReader, resultArray) || resultArray.Num() == 0)
+	TJsonBPReader<ANSICHAR> reader((const ANSICHAR*)bytes.GetData(), bytes.Num());
+	FJsonBPCPPValueBuilder builder;
+	if (!reader.ReadDocument(builder))
 	{
 		return nullptr;
 	}
 
-	return resultArray[0];
+	return builder.GetResult();
 }
 
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const float number)
@@ -82,12 +257,13 @@ JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const FString& string)
 
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const uint32 number)
 {
-	return HelperToJSON((float)number);
+	//through double, float can't hold every 32 bit integer
+	return MakeShared<FJsonValueNumber>((double)number);
 }
 
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const int number)
 {
-	return HelperToJSON((float)number);
+	return MakeShared<FJsonValueNumber>((double)number);
 }
 
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const FText& string)
@@ -95,7 +271,114 @@ JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const FText& string)
 	return HelperToJSON(string.ToString());
 }
 
-FString HelperStringifyJSON(TSharedPtr<FJsonValue> jsValue, bool bPretty)
+template<typename CharType> static void HelperWriteJSON(TJsonBPWriter<CharType>& writer, const TSharedPtr<FJsonValue>& jsValue)
+{
+	if (!jsValue.IsValid())
+	{
+		writer.WriteNull();
+		return;
+	}
+
+	switch (jsValue->Type)
+	{
+	case EJson::None:
+	case EJson::Null:
+		writer.WriteNull();
+		break;
+	case EJson::String:
+		writer.WriteString(jsValue->AsString());
+		break;
+	case EJson::Number:
+		writer.WriteNumber(jsValue->AsNumber());
+		break;
+	case EJson::Boolean:
+		writer.WriteBoolean(jsValue->AsBool());
+		break;
+	case EJson::Array:
+		writer.BeginArray();
+		if (const FJsonBPValuePacked* pPacked = FJsonBPValuePacked::Find(jsValue))
+		{
+			pPacked->GetElements().WriteElements(writer);
+		}
+		else
+		{
+			for (const TSharedPtr<FJsonValue>& element : jsValue->AsArray())
+				HelperWriteJSON(writer, element);
+		}
+		writer.EndArray();
+		break;
+	case EJson::Object:
+		writer.BeginObject();
+		for (const auto& pair : jsValue->AsObject()->Values)
+		{
+			writer.WriteKey(pair.Key);
+			HelperWriteJSON(writer, pair.Value);
+		}
+		writer.EndObject();
+		break;
+	}
+}
+
+//writes the items of a large top level array/object in pieces on worker threads, then appends the pieces in order
+template<typename CharType> static void HelperWriteJSONParallel(TJsonBPWriter<CharType>& writer, const TSharedPtr<FJsonValue>& jsValue)
+{
+	const bool bArray = jsValue.IsValid() && jsValue->Type == EJson::Array;
+	const bool bObject = jsValue.IsValid() && jsValue->Type == EJson::Object;
+	const int32 numItems = bArray ? jsValue->AsArray().Num() : (bObject ? jsValue->AsObject()->Values.Num() : 0);
+	const int32 numChunks = FPlatformProcess::SupportsMultithreading() ? JsonBPGetParallelChunks(numItems) : 1;
+	//packed elements are written faster in one loop than split across threads
+	if (numChunks < 2 || FJsonBPValuePacked::Find(jsValue))
+	{
+		HelperWriteJSON(writer, jsValue);
+		return;
+	}
+
+	//the map can't be indexed, the fields are listed first
+	TArray<const TPair<FString, TSharedPtr<FJsonValue>>*> fields;
+	if (bObject)
+	{
+		fields.Reserve(numItems);
+		for (const auto& pair : jsValue->AsObject()->Values)
+			fields.Add(&pair);
+	}
+
+	TArray<TArray<CharType>> fragments;
+	fragments.SetNum(numChunks);
+	ParallelFor(numChunks, [&](int32 chunk)
+	{
+		const int32 first = (int32)((int64)numItems * chunk / numChunks);
+		const int32 last = (int32)((int64)numItems * (chunk + 1) / numChunks);
+		TJsonBPWriter<CharType> chunkWriter(fragments[chunk], writer.IsPretty());
+		chunkWriter.BeginFragment(1, chunk > 0);
+		for (int32 i = first; i < last; i++)
+		{
+			if (bObject)
+			{
+				chunkWriter.WriteKey(fields[i]->Key);
+				HelperWriteJSON(chunkWriter, fields[i]->Value);
+			}
+			else
+			{
+				HelperWriteJSON(chunkWriter, jsValue->AsArray()[i]);
+			}
+		}
+	});
+
+	if (bArray)
+		writer.BeginArray();
+	else
+		writer.BeginObject();
+
+	for (const TArray<CharType>& fragment : fragments)
+		writer.AppendFragment(fragment.GetData(), fragment.Num());
+
+	if (bArray)
+		writer.EndArray();
+	else
+		writer.EndObject();
+}
+
+FString HelperStringifyJSON(TSharedPtr<FJsonValue> jsValue, bool bPretty, bool bParallel)
 {
 	check(jsValue.IsValid());
 
@@ -113,41 +396,73 @@ FString HelperStringifyJSON(TSharedPtr<FJsonValue> jsValue, bool bPretty)
 
 	/*
 	#Note
-		FJsonSerializer::Serialize returns false for types other than {} and []
-		it returns false but fills the 'OutputString' with valid value but started with ',' or ',\r\n' depending on pretty printing
-		we do a trick to fix that :)
-
-	#TODO should not I report it as bug ?
-
+		FJsonSerializer::Serialize returns false for types other than {} and [] and writes a leading ',' for them.
+		TJsonBPWriter has no such limit so no trick is required anymore.
 	*/
+	JSONBP_SCOPE(Stringify);
 	FString OutputString;
-	if (bPretty)
-	{
-		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
-		if (!FJsonSerializer::Serialize(jsValue, FString(), Writer))
-		{
-		}
-	}
+	TJsonBPWriter<TCHAR> writer(OutputString.GetCharArray(), bPretty);
+	if (bParallel)
+		HelperWriteJSONParallel(writer, jsValue);
 	else
-	{
-		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>> > Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutputString);
-		if (!FJsonSerializer::Serialize(jsValue, FString(), Writer))
-		{
-		}
-	}
+		HelperWriteJSON(writer, jsValue);
+	JSONBP_COUNT(BytesEmitted, OutputString.GetCharArray().Num() * sizeof(TCHAR));
+	OutputString.GetCharArray().Add(TEXT('\0'));
+
+	return OutputString;
+}
+
+void HelperStringifyJSONUTF8(TSharedPtr<FJsonValue> jsValue, TArray<uint8>& out, bool bPretty, bool bParallel)
+{
+	check(jsValue.IsValid());
+
+	JSONBP_SCOPE(Stringify);
+	out.Reset();
+	TJsonBPWriter<uint8> writer(out, bPretty);
+	if (bParallel)
+		HelperWriteJSONParallel(writer, jsValue);
+	else
+		HelperWriteJSON(writer, jsValue);
+	JSONBP_COUNT(BytesEmitted, out.Num());
+}
 
-	if (OutputString.Len() > 0 && OutputString[0] == TEXT(','))
+
+JSONBP_API double JsonBPFloatToDouble(float value)
+{
+	if (!FMath::IsFinite(value))
+		return value;
+	//whole numbers are exact, which is most elements of bulk arrays
+	if (FMath::Abs(value) < 16777216.0f && value == (float)(int32)value)
+		return value;
+
+	//the shortest decimal that reads back as the same float, so 0.1f becomes 0.1 and not 0.100000001490116
+	ANSICHAR buffer[32];
+	for (int32 precision = 6; precision < 9; precision++)
 	{
-		OutputString.RemoveAt(0, bPretty ? 3 : 1, false);
+		FCStringAnsi::Snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+		const double shortest = FCStringAnsi::Atod(buffer);
+		if ((float)shortest == value)
+			return shortest;
 	}
 
-	return OutputString;
+	return value;
 }
 
+#if !UE_BUILD_SHIPPING
+thread_local int64 JsonBPValuesMadeOnThread = 0;
+#endif
 
 UJsonValue* MakeJsonValue()
 {
 	static FName NameJsonValue("JsonValue");
+	JSONBP_COUNT(ValuesCreated, 1);
+#if !UE_BUILD_SHIPPING
+	JsonBPValuesMadeOnThread++;
+#endif
+	//values come from the innermost active pool if there is one
+	if (UJsonValuePool* pPool = UJsonValuePool::GetActivePool())
+		return pPool->Acquire();
+
 	//return NewObject<UJsonValue>((UObject*)GetTransientPackage(), UJsonValue::StaticClass(), NameJsonValue, RF_Transient);
 	return NewObject<UJsonValue>();
 }
@@ -155,6 +470,34 @@ UJsonValue* MakeJsonValue()
 UJsonValue::UJsonValue()
 {
 	JsonType = EJsonType::JSON_None;
+	LazyNode = INDEX_NONE;
+	bPooled = false;
+	bShared = false;
+	JSONBP_COUNT(LiveValues, 1);
+}
+
+UJsonValue::~UJsonValue()
+{
+	JSONBP_COUNT(LiveValues, -1);
+}
+
+void UJsonValue::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UJsonValue* pThis = CastChecked<UJsonValue>(InThis);
+	for (auto& pair : pThis->ValueObject)
+		Collector.AddReferencedObject(pair.Value, pThis);
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+//interns the keys of a map coming from blueprint or user code
+static FJsonBPObjectMap JsonBPInternKeys(const TMap<FString, UJsonValue*>& value)
+{
+	FJsonBPObjectMap result;
+	result.Reserve(value.Num());
+	for (const auto& pair : value)
+		result.Add(FJsonBPKey(pair.Key), pair.Value);
+	return result;
 }
 
 bool UJsonValue::GetValueAsString(FString& value)
@@ -178,6 +521,26 @@ bool UJsonValue::GetValueAsBoolean(bool& value)
 }
 
 bool UJsonValue::GetValueAsNumber(float& value)
+{
+	if (JsonType == EJsonType::JSON_Number)
+	{
+		value = (float)ValueNumber;
+		return true;
+	}
+	return false;
+}
+
+bool UJsonValue::GetValueAsInteger(int64& value) const
+{
+	if (JsonType == EJsonType::JSON_Number)
+	{
+		value = bIntegerNumber ? ValueInteger : JsonBPDoubleToInt64(ValueNumber);
+		return true;
+	}
+	return false;
+}
+
+bool UJsonValue::GetValueAsDouble(double& value) const
 {
 	if (JsonType == EJsonType::JSON_Number)
 	{
@@ -191,6 +554,7 @@ bool UJsonValue::GetValueAsArray(TArray<UJsonValue*>& value)
 {
 	if (JsonType == EJsonType::JSON_Array)
 	{
+		Expand();
 		value = ValueArray;
 		return true;
 	}
@@ -201,7 +565,11 @@ bool UJsonValue::GetValueAsObject(TMap<FString, UJsonValue*>& value)
 {
 	if (JsonType == EJsonType::JSON_Object)
 	{
-		value = ValueObject;
+		Expand();
+		value.Reset();
+		value.Reserve(ValueObject.Num());
+		for (const auto& pair : ValueObject)
+			value.Add(pair.Key.ToString(), pair.Value);
 		return true;
 	}
 	return false;
@@ -221,6 +589,20 @@ UJsonValue* UJsonValue::MakeNumber(float value)
 	return pObj;
 }
 
+UJsonValue* UJsonValue::MakeInteger(int64 value)
+{
+	UJsonValue* pObj = MakeJsonValue();
+	pObj->SetValueInteger(value);
+	return pObj;
+}
+
+UJsonValue* UJsonValue::MakeDouble(double value)
+{
+	UJsonValue* pObj = MakeJsonValue();
+	pObj->SetValueDouble(value);
+	return pObj;
+}
+
 UJsonValue* UJsonValue::MakeBoolean(bool value)
 {
 	UJsonValue* pObj = MakeJsonValue();
@@ -249,21 +631,90 @@ UJsonValue* UJsonValue::MakeObject(const TMap<FString, UJsonValue*>& value)
 	return pObj;
 }
 
+UJsonValue* UJsonValue::MakeArray(TArray<UJsonValue*>&& value)
+{
+	UJsonValue* pObj = MakeJsonValue();
+	pObj->SetValueArray(MoveTemp(value));
+	return pObj;
+}
+
+UJsonValue* UJsonValue::MakeObject(TMap<FString, UJsonValue*>&& value)
+{
+	UJsonValue* pObj = MakeJsonValue();
+	pObj->SetValueObject(MoveTemp(value));
+	return pObj;
+}
+
+UJsonValue* UJsonValue::MakeObject(FJsonBPObjectMap&& value)
+{
+	UJsonValue* pObj = MakeJsonValue();
+	pObj->SetValueObject(MoveTemp(value));
+	return pObj;
+}
+
 UJsonValue* UJsonValue::MakeFromString(const FString& jsonValue)
 {
-	TSharedPtr<FJsonValue> parsed = HelperParseJSON(jsonValue);
-	if (!parsed)
+	JSONBP_SCOPE(BuildTree);
+	JSONBP_COUNT(BytesParsed, jsonValue.Len() * sizeof(TCHAR));
+	//single pass, UJsonValue objects are created while reading. no FJsonValue tree in between
+	TJsonBPReader<TCHAR> reader(*jsonValue, jsonValue.Len());
+	FJsonBPValueBuilder builder;
+	if (!reader.ReadDocument(builder))
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("MakeFromString failed: %s"), *reader.GetErrorText());
+		return nullptr;
+	}
+
+	return builder.GetResult();
+}
+
+UJsonValue* UJsonValue::MakeFromUTF8(const ANSICHAR* text, int32 length)
+{
+	JSONBP_SCOPE(BuildTree);
+	JSONBP_COUNT(BytesParsed, length);
+	TJsonBPReader<ANSICHAR> reader(text, length);
+	FJsonBPValueBuilder builder;
+	if (!reader.ReadDocument(builder))
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("MakeFromUTF8 failed: %s"), *reader.GetErrorText());
 		return nullptr;
+	}
 
-	return MakeFromCPPVersion(parsed);
+	return builder.GetResult();
+}
+
+UJsonValue* UJsonValue::MakeFromUTF8(TArrayView<const uint8> bytes)
+{
+	return MakeFromUTF8((const ANSICHAR*)bytes.GetData(), bytes.Num());
+}
+
+UJsonValue* UJsonValue::MakeFromUTF8Bytes(const TArray<uint8>& bytes)
+{
+	return MakeFromUTF8((const ANSICHAR*)bytes.GetData(), bytes.Num());
 }
 
 bool UJsonValue::SetFieldValue(const FString& field, const UJsonValue* value)
 {
-	if (JsonType != EJsonType::JSON_Object)
+	if (JsonType != EJsonType::JSON_Object || !CanModify())
+		return false;
+
+	Expand();
+	const FJsonBPKey key(field);
+	DetachFromTextCache(ValueObject.FindRef(key));
+	ValueObject.Add(key, (UJsonValue*)value);
+	AttachToTextCache((UJsonValue*)value);
+	return true;
+}
+
+bool UJsonValue::SetFieldValue(FJsonBPKey field, const UJsonValue* value)
+{
+	if (JsonType != EJsonType::JSON_Object || !field.IsValid() || !CanModify())
 		return false;
 
+	Expand();
+	DetachFromTextCache(ValueObject.FindRef(field));
 	ValueObject.Add(field, (UJsonValue*)value);
+	AttachToTextCache((UJsonValue*)value);
 	return true;
 }
 
@@ -277,6 +728,16 @@ bool UJsonValue::SetFieldNumber(const FString& field, float value)
 	return SetFieldValue(field, MakeNumber(value));
 }
 
+bool UJsonValue::SetFieldInteger(const FString& field, int64 value)
+{
+	return SetFieldValue(field, MakeInteger(value));
+}
+
+bool UJsonValue::SetFieldDouble(const FString& field, double value)
+{
+	return SetFieldValue(field, MakeDouble(value));
+}
+
 bool UJsonValue::SetFieldBoolean(const FString& field, bool value)
 {
 	return SetFieldValue(field, MakeBoolean(value));
@@ -302,11 +763,18 @@ UJsonValue* UJsonValue::GetFieldValue(const FString& field) const
 	if (JsonType != EJsonType::JSON_Object)
 		return nullptr;
 
-	auto ppValue = ValueObject.Find(field);
-	if (!ppValue)
+	//a string that was never interned can't be a key of any object
+	return GetFieldValue(FJsonBPKey::Find(field));
+}
+
+UJsonValue* UJsonValue::GetFieldValue(FJsonBPKey field) const
+{
+	if (JsonType != EJsonType::JSON_Object || !field.IsValid())
 		return nullptr;
 
-	return *ppValue;
+	Expand();
+	UJsonValue** ppField = const_cast<FJsonBPObjectMap&>(ValueObject).Find(field);
+	return ppField ? UnshareChild(*ppField) : nullptr;
 }
 
 bool UJsonValue::GetFieldValueString(const FString& field, FString& value) const
@@ -327,6 +795,24 @@ bool UJsonValue::GetFieldValueNumber(const FString& field, float& value) const
 	return pValue->GetValueAsNumber(value);
 }
 
+bool UJsonValue::GetFieldValueInteger(const FString& field, int64& value) const
+{
+	auto pValue = GetFieldValue(field);
+	if (!pValue)
+		return false;
+
+	return pValue->GetValueAsInteger(value);
+}
+
+bool UJsonValue::GetFieldValueDouble(const FString& field, double& value) const
+{
+	auto pValue = GetFieldValue(field);
+	if (!pValue)
+		return false;
+
+	return pValue->GetValueAsDouble(value);
+}
+
 bool UJsonValue::GetFieldValueBoolean(const FString& field, bool& value) const
 {
 	auto pValue = GetFieldValue(field);
@@ -354,8 +840,155 @@ bool UJsonValue::GetFieldValueObject(const FString& field, TMap<FString, UJsonVa
 	return pValue->GetValueAsObject(value);
 }
 
+int32 UJsonValue::GetArrayLength() const
+{
+	if (IsLazy())
+		return JsonType == EJsonType::JSON_Array ? LazyDocument->Num(LazyNode) : 0;
+	if (Packed)
+		return Packed->Num();
+
+	return JsonType == EJsonType::JSON_Array ? ValueArray.Num() : 0;
+}
+
+UJsonValue* UJsonValue::GetArrayElement(int32 index) const
+{
+	if (JsonType != EJsonType::JSON_Array)
+		return nullptr;
+
+	Expand();
+	return ValueArray.IsValidIndex(index) ? UnshareChild(const_cast<UJsonValue*&>(ValueArray[index])) : nullptr;
+}
+
+bool UJsonValue::SetArrayElement(int32 index, UJsonValue* value)
+{
+	if (JsonType != EJsonType::JSON_Array || !CanModify())
+		return false;
+
+	Expand();
+	if (!ValueArray.IsValidIndex(index))
+		return false;
+
+	DetachFromTextCache(ValueArray[index]);
+	ValueArray[index] = value;
+	AttachToTextCache(value);
+	return true;
+}
+
+bool UJsonValue::AddArrayElement(UJsonValue* value)
+{
+	if (JsonType != EJsonType::JSON_Array || !CanModify())
+		return false;
+
+	Expand();
+	ValueArray.Add(value);
+	AttachToTextCache(value);
+	return true;
+}
+
+bool UJsonValue::InsertArrayElement(int32 index, UJsonValue* value)
+{
+	if (JsonType != EJsonType::JSON_Array || !CanModify())
+		return false;
+
+	Expand();
+	if (index < 0 || index > ValueArray.Num())
+		return false;
+
+	ValueArray.Insert(value, index);
+	AttachToTextCache(value);
+	return true;
+}
+
+bool UJsonValue::RemoveArrayElement(int32 index)
+{
+	if (JsonType != EJsonType::JSON_Array || !CanModify())
+		return false;
+
+	Expand();
+	if (!ValueArray.IsValidIndex(index))
+		return false;
+
+	DetachFromTextCache(ValueArray[index]);
+	ValueArray.RemoveAt(index);
+	return true;
+}
+
+int32 UJsonValue::GetFieldCount() const
+{
+	if (IsLazy())
+		return JsonType == EJsonType::JSON_Object ? LazyDocument->NumDistinctFields(LazyNode) : 0;
+
+	return JsonType == EJsonType::JSON_Object ? ValueObject.Num() : 0;
+}
+
+bool UJsonValue::HasField(const FString& field) const
+{
+	Expand();
+	return JsonType == EJsonType::JSON_Object && ValueObject.Contains(FJsonBPKey::Find(field));
+}
+
+void UJsonValue::GetFieldNames(TArray<FString>& names) const
+{
+	names.Reset();
+	if (JsonType != EJsonType::JSON_Object)
+		return;
+
+	Expand();
+	names.Reserve(ValueObject.Num());
+	for (const auto& pair : ValueObject)
+		names.Add(pair.Key.ToString());
+}
+
+bool UJsonValue::RemoveField(const FString& field)
+{
+	if (JsonType != EJsonType::JSON_Object || !CanModify())
+		return false;
+
+	Expand();
+	const FJsonBPKey key = FJsonBPKey::Find(field);
+	UJsonValue* pRemoved = nullptr;
+	if (!key.IsValid() || !ValueObject.RemoveAndCopyValue(key, pRemoved))
+		return false;
+
+	DetachFromTextCache(pRemoved);
+	return true;
+}
+
+const TArray<UJsonValue*>& UJsonValue::GetArrayRef() const
+{
+	static const TArray<UJsonValue*> EmptyArray;
+	Expand();
+	return JsonType == EJsonType::JSON_Array ? ValueArray : EmptyArray;
+}
+
+const FJsonBPObjectMap& UJsonValue::GetObjectRef() const
+{
+	static const FJsonBPObjectMap EmptyObject;
+	Expand();
+	return JsonType == EJsonType::JSON_Object ? ValueObject : EmptyObject;
+}
+
+void UJsonValue::ForEachField(TFunctionRef<void(const FString&, UJsonValue*)> func) const
+{
+	if (JsonType != EJsonType::JSON_Object)
+		return;
+
+	Expand();
+	for (const auto& pair : ValueObject)
+		func(pair.Key.ToString(), pair.Value);
+}
+
+UJsonValue* UJsonValue::FindByPath(const FString& path)
+{
+	UJsonPath* pPath = UJsonPath::GetCachedPath(path);
+	return pPath ? pPath->Find(this) : nullptr;
+}
+
 void UJsonValue::SetValueString(const FString& value)
 {
+	if (!CanModify())
+		return;
+
 	Clear();
 	JsonType = EJsonType::JSON_String;
 	ValueString = value;
@@ -363,6 +996,9 @@ void UJsonValue::SetValueString(const FString& value)
 
 void UJsonValue::SetValueBoolean(bool value)
 {
+	if (!CanModify())
+		return;
+
 	Clear();
 	JsonType = EJsonType::JSON_Boolean;
 	ValueBool = value;
@@ -370,6 +1006,26 @@ void UJsonValue::SetValueBoolean(bool value)
 
 void UJsonValue::SetValueNumber(float value)
 {
+	SetValueDouble(JsonBPFloatToDouble(value));
+}
+
+void UJsonValue::SetValueInteger(int64 value)
+{
+	if (!CanModify())
+		return;
+
+	Clear();
+	JsonType = EJsonType::JSON_Number;
+	bIntegerNumber = true;
+	ValueInteger = value;
+	ValueNumber = (double)value;
+}
+
+void UJsonValue::SetValueDouble(double value)
+{
+	if (!CanModify())
+		return;
+
 	Clear();
 	JsonType = EJsonType::JSON_Number;
 	ValueNumber = value;
@@ -377,46 +1033,239 @@ void UJsonValue::SetValueNumber(float value)
 
 void UJsonValue::SetValueNull()
 {
+	if (!CanModify())
+		return;
+
 	Clear();
 	JsonType = EJsonType::JSON_Null;
 }
 
 void UJsonValue::SetValueArray(const TArray<UJsonValue*>& value)
 {
+	if (!CanModify())
+		return;
+
 	Clear();
 	JsonType = EJsonType::JSON_Array;
 	ValueArray = value;
+	AttachChildrenToTextCache();
 }
 
 void UJsonValue::SetValueObject(const TMap<FString, UJsonValue*>& value)
 {
+	if (!CanModify())
+		return;
+
 	Clear();
 	JsonType = EJsonType::JSON_Object;
-	ValueObject = value;
+	ValueObject = JsonBPInternKeys(value);
+	AttachChildrenToTextCache();
+}
+
+void UJsonValue::SetValueArray(TArray<UJsonValue*>&& value)
+{
+	if (!CanModify())
+		return;
+
+	Clear();
+	JsonType = EJsonType::JSON_Array;
+	ValueArray = MoveTemp(value);
+	AttachChildrenToTextCache();
+}
+
+void UJsonValue::SetValueObject(TMap<FString, UJsonValue*>&& value)
+{
+	if (!CanModify())
+		return;
+
+	Clear();
+	JsonType = EJsonType::JSON_Object;
+	ValueObject = JsonBPInternKeys(value);
+	AttachChildrenToTextCache();
+}
+
+void UJsonValue::SetValueObject(FJsonBPObjectMap&& value)
+{
+	if (!CanModify())
+		return;
+
+	Clear();
+	JsonType = EJsonType::JSON_Object;
+	ValueObject = MoveTemp(value);
+	AttachChildrenToTextCache();
 }
 
 void UJsonValue::Clear()
 {
+	if (!CanModify())
+		return;
+
+	InvalidateText();
 	JsonType = EJsonType::JSON_None;
 
+	LazyDocument.Reset();
+	LazyNode = INDEX_NONE;
+	Packed.Reset();
 	ValueArray.Reset();
 	ValueObject.Reset();
 	ValueBool = false;
+	bIntegerNumber = false;
+	ValueInteger = 0;
 	ValueNumber = 0;
 	ValueString = FString();
 }
 
 FString UJsonValue::ToString(bool bPretty) const
 {
-	TSharedPtr<FJsonValue> jsValue = ToCPPVersion();
-	if (!jsValue)
+	if (JsonType == EJsonType::JSON_None)
 		return FString();
 
-	return HelperStringifyJSON(jsValue, bPretty);
+	JSONBP_SCOPE(Stringify);
+	FString result;
+	TArray<TCHAR>& chars = result.GetCharArray();
+	chars.Reserve(EstimateTextLength(bPretty) + 1);
+
+	TJsonBPWriter<TCHAR> writer(chars, bPretty);
+	if (TextCache && !bPretty)
+		WriteCached(writer);
+	else
+		WriteTo(writer);
+	JSONBP_COUNT(BytesEmitted, chars.Num() * sizeof(TCHAR));
+	chars.Add(TEXT('\0'));
+
+	return result;
+}
+
+void UJsonValue::ToUTF8Bytes(bool bPretty, TArray<uint8>& bytes) const
+{
+	bytes.Reset();
+	AppendUTF8(bytes, bPretty);
+}
+
+void UJsonValue::AppendUTF8(TArray<uint8>& out, bool bPretty) const
+{
+	if (JsonType == EJsonType::JSON_None)
+		return;
+
+	JSONBP_SCOPE(Stringify);
+	const int32 start = out.Num();
+	out.Reserve(start + EstimateTextLength(bPretty));
+	TJsonBPWriter<uint8> writer(out, bPretty);
+	WriteTo(writer);
+	JSONBP_COUNT(BytesEmitted, out.Num() - start);
+}
+
+template<typename CharType> void UJsonValue::WriteTo(TJsonBPWriter<CharType>& writer) const
+{
+	//a lazy container is written straight from its document, nothing gets expanded
+	if (IsLazy())
+	{
+		LazyDocument->WriteTo(writer, LazyNode);
+		return;
+	}
+	if (Packed)
+	{
+		writer.BeginArray();
+		Packed->WriteElements(writer);
+		writer.EndArray();
+		return;
+	}
+
+	switch (JsonType)
+	{
+	case EJsonType::JSON_None:
+	case EJsonType::JSON_Null:
+		writer.WriteNull();
+		break;
+	case EJsonType::JSON_String:
+		writer.WriteString(ValueString);
+		break;
+	case EJsonType::JSON_Number:
+		if (bIntegerNumber)
+			writer.WriteInteger(ValueInteger);
+		else
+			writer.WriteNumber(ValueNumber);
+		break;
+	case EJsonType::JSON_Boolean:
+		writer.WriteBoolean(ValueBool);
+		break;
+	case EJsonType::JSON_Array:
+		writer.BeginArray();
+		for (const UJsonValue* pElement : ValueArray)
+		{
+			if (pElement)
+				pElement->WriteTo(writer);
+			else
+				writer.WriteNull();
+		}
+		writer.EndArray();
+		break;
+	case EJsonType::JSON_Object:
+		writer.BeginObject();
+		for (const auto& pair : ValueObject)
+		{
+			writer.WriteKey(pair.Key.ToString());
+			if (pair.Value)
+				pair.Value->WriteTo(writer);
+			else
+				writer.WriteNull();
+		}
+		writer.EndObject();
+		break;
+	}
+}
+
+template void UJsonValue::WriteTo<TCHAR>(TJsonBPWriter<TCHAR>& writer) const;
+template void UJsonValue::WriteTo<ANSICHAR>(TJsonBPWriter<ANSICHAR>& writer) const;
+template void UJsonValue::WriteTo<uint8>(TJsonBPWriter<uint8>& writer) const;
+
+int32 UJsonValue::EstimateTextLength(bool bPretty) const
+{
+	//separators plus a few indentation characters per item when pretty
+	const int32 perItem = bPretty ? 6 : 1;
+	if (IsLazy())
+		return LazyDocument->EstimateTextLength(LazyNode, bPretty);
+	if (Packed)
+		return Packed->EstimateTextLength() + (bPretty ? Packed->Num() * perItem : 0);
+	if (!bPretty && TextCache && TextCache->bValid && !TextCache->Text.IsEmpty())
+		return TextCache->Text.Len();
+
+	switch (JsonType)
+	{
+	case EJsonType::JSON_String: return ValueString.Len() + 2;
+	case EJsonType::JSON_Number: return 12;
+	case EJsonType::JSON_Boolean: return 5;
+	case EJsonType::JSON_Array:
+	{
+		int32 length = 2;
+		for (const UJsonValue* pElement : ValueArray)
+			length += (pElement ? pElement->EstimateTextLength(bPretty) : 4) + perItem;
+		return length;
+	}
+	case EJsonType::JSON_Object:
+	{
+		int32 length = 2;
+		for (const auto& pair : ValueObject)
+			length += pair.Key.ToString().Len() + 3 + (pair.Value ? pair.Value->EstimateTextLength(bPretty) : 4) + perItem;
+		return length;
+	}
+	}
+
+	return 4;
 }
 
 TSharedPtr<FJsonValue> UJsonValue::ToCPPVersion() const
 {
+	JSONBP_SCOPE(ToCPPVersion);
+	return MakeCPPValue();
+}
+
+TSharedPtr<FJsonValue> UJsonValue::MakeCPPValue() const
+{
+	if (Packed)
+		return MakeShared<FJsonBPValuePacked>(FJsonBPPackedElements(*Packed));
+
+	Expand();
 	switch (JsonType)
 	{
 	case EJsonType::JSON_None:
@@ -426,6 +1275,7 @@ TSharedPtr<FJsonValue> UJsonValue::ToCPPVersion() const
 	case EJsonType::JSON_String:
 		return MakeShared<FJsonValueString>(ValueString);
 	case EJsonType::JSON_Number:
+		//ValueNumber holds the integer as double too
 		return MakeShared<FJsonValueNumber>(ValueNumber);
 	case EJsonType::JSON_Boolean:
 		return MakeShared<FJsonValueBoolean>(ValueBool);
@@ -434,7 +1284,7 @@ TSharedPtr<FJsonValue> UJsonValue::ToCPPVersion() const
 		TArray<TSharedPtr<FJsonValue>> elements;
 		for (const UJsonValue* pElement : ValueArray)
 		{
-			elements.Add(pElement ? pElement->ToCPPVersion() : nullptr);
+			elements.Add(pElement ? pElement->MakeCPPValue() : nullptr);
 		}
 
 		return MakeShared<FJsonValueArray>(elements);
@@ -444,7 +1294,7 @@ TSharedPtr<FJsonValue> UJsonValue::ToCPPVersion() const
 		TSharedPtr<FJsonObject> jsObject = MakeShared<FJsonObject>();
 		for (const auto& pair : ValueObject) 
 		{
-			jsObject->Values.Add(pair.Key, pair.Value ? pair.Value->ToCPPVersion() : nullptr);
+			jsObject->Values.Add(pair.Key.ToString(), pair.Value ? pair.Value->MakeCPPValue() : nullptr);
 		}
 		return MakeShared<FJsonValueObject>(jsObject);
 	}
@@ -454,6 +1304,12 @@ TSharedPtr<FJsonValue> UJsonValue::ToCPPVersion() const
 }
 
 UJsonValue* UJsonValue::MakeFromCPPVersion(TSharedPtr<FJsonValue> value)
+{
+	JSONBP_SCOPE(MakeFromCPPVersion);
+	return MakeFromCPPValue(value);
+}
+
+UJsonValue* UJsonValue::MakeFromCPPValue(const TSharedPtr<FJsonValue>& value)
 {
 	if (!value)
 		return nullptr;
@@ -466,13 +1322,25 @@ UJsonValue* UJsonValue::MakeFromCPPVersion(TSharedPtr<FJsonValue> value)
 	case EJson::String: return MakeString(value->AsString());
 
 	case EJson::Number: 
-		//#NOTE double is not supported in blueprint we cast to float
-		return MakeNumber((float)value->AsNumber());
+	{
+		//FJsonValue keeps a double, integral values that it can hold exactly become integers again. -0 has no integer
+		const double number = value->AsNumber();
+		if (FMath::Abs(number) <= JsonBPMaxExactDoubleInteger && number == FMath::FloorToDouble(number) && !(number == 0 && FMath::IsNegativeDouble(number)))
+			return MakeInteger((int64)number);
+		return MakeDouble(number);
+	}
 
 	case EJson::Boolean: return MakeBoolean(value->AsBool());
 
 	case EJson::Array:
 	{
+		if (const FJsonBPValuePacked* pPacked = FJsonBPValuePacked::Find(value))
+		{
+			UJsonValue* pArray = MakeJsonValue();
+			pArray->SetValuePacked(FJsonBPPackedElements(pPacked->GetElements()));
+			return pArray;
+		}
+
 		const TArray<TSharedPtr<FJsonValue>>& jsArray = value->AsArray();
 
 		UJsonValue* pArray = MakeJsonValue();
@@ -482,7 +1350,7 @@ UJsonValue* UJsonValue::MakeFromCPPVersion(TSharedPtr<FJsonValue> value)
 		check(pArray->ValueArray.Num() == jsArray.Num());
 
 		for(int i = 0; i < jsArray.Num(); i++)
-			pArray->ValueArray[i] = MakeFromCPPVersion(jsArray[i]);
+			pArray->ValueArray[i] = MakeFromCPPValue(jsArray[i]);
 		
 		return pArray;
 	}
@@ -494,8 +1362,9 @@ UJsonValue* UJsonValue::MakeFromCPPVersion(TSharedPtr<FJsonValue> value)
 		check(pObject);
 		pObject->JsonType = EJsonType::JSON_Object;
 		
+		pObject->ValueObject.Reserve(jsObject->Values.Num());
 		for (const auto& pair : jsObject->Values)
-			pObject->ValueObject.Add(pair.Key, MakeFromCPPVersion(pair.Value));
+			pObject->ValueObject.Add(FJsonBPKey(pair.Key), MakeFromCPPValue(pair.Value));
 
 		return pObject;
 	}
@@ -504,121 +1373,3 @@ UJsonValue* UJsonValue::MakeFromCPPVersion(TSharedPtr<FJsonValue> value)
 
 	return nullptr;
 }
-
-#if 0
-void UJsonValue::Test0()
-{
-	const bool pretty = false;
-
-#pragma region deserialize test
-	{
-		auto jsValue = HelperParseJSON(FString(TEXT("123")));
-		ensureAlways(jsValue->AsNumber() == 123);
-
-	}
-#pragma endregion
-
-#pragma region serialize test
-	{
-		TArray<TSharedPtr<FJsonValue>> elements;
-		elements.Add(MakeShared<FJsonValueNumber>(123));
-		elements.Add(MakeShared<FJsonValueNumber>(456));
-		elements.Add(MakeShared<FJsonValueNull>());
-		FString jsonArray = HelperStringifyJSON(MakeShared<FJsonValueArray>(elements), pretty);
-		ensureAlways(jsonArray == FString("[123,456,null]"));
-	}
-	{
-		TSharedPtr<FJsonObject> elements = MakeShared<FJsonObject>();
-		elements->Values.Add("number", MakeShared<FJsonValueString>("hehe"));
-		FString jsObject = HelperStringifyJSON(MakeShared<FJsonValueObject>(elements), pretty);
-		ensureAlways(jsObject == FString("{\"number\":\"hehe\"}"));
-	}
-	{
-		FString json123 = HelperStringifyJSON(MakeShared<FJsonValueNumber>(123), pretty);
-		ensureAlways(json123 == FString("123"));
-	}
-
-	{
-		FString jsonHello = HelperStringifyJSON(MakeShared<FJsonValueString>("hello"), pretty);
-		ensureAlways(jsonHello == FString("\"hello\""));
-	}
-	{
-		FString jsonHello = HelperStringifyJSON(MakeShared<FJsonValueBoolean>(true), pretty);
-		ensureAlways(jsonHello == FString("true"));
-	}
-	{
-		FString jsonHello = HelperStringifyJSON(MakeShared<FJsonValueNull>(), pretty);
-		ensureAlways(jsonHello == FString("null"));
-	}
-#pragma endregion
-
-
-	{
-		UJsonValue* madeFromStr = MakeFromString(FString(R"({asd)"));
-		check(madeFromStr == nullptr);
-	}
-	{
-		FString theNumber("123");
-		UJsonValue* madeFromStr = MakeFromString(theNumber);
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_Number);
-		ensureAlways(madeFromStr->ToString(false).Equals(theNumber));
-	}
-	{
-		UJsonValue* madeFromStr = MakeFromString(FString("false"));
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_Boolean);
-		ensureAlways(madeFromStr->ToString(false).Equals("false"));
-	}
-	{
-		UJsonValue* madeFromStr = MakeFromString(FString("true"));
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_Boolean);
-		ensureAlways(madeFromStr->ToString(false).Equals("true"));
-	}
-	{
-		UJsonValue* madeFromStr = MakeFromString(FString("null"));
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_Null);
-		ensureAlways(madeFromStr->ToString(false).Equals("null"));
-	}
-	{
-		FString theJSON(R"("string")");
-		UJsonValue* madeFromStr = MakeFromString(theJSON);
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_String);
-		ensureAlways(madeFromStr->ValueString.Equals(FString("string")));
-		ensureAlways(madeFromStr->ToString(false).Equals(theJSON));
-	}
-	{
-		FString theJSON(R"("")");
-		UJsonValue* madeFromStr = MakeFromString(theJSON);
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_String);
-		ensureAlways(madeFromStr->ValueString.IsEmpty());
-		ensureAlways(madeFromStr->ToString(false).Equals(theJSON));
-	}
-	{
-		UJsonValue* madeFromStr = MakeFromString(FString("{}"));
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_Object);
-		ensureAlways(madeFromStr->ToString(false).Equals("{}"));
-		
-	}
-	{
-		UJsonValue* madeFromStr = MakeFromString(FString("[]"));
-		ensureAlways(madeFromStr && madeFromStr->GetType() == EJsonType::JSON_Array);
-		ensureAlways(madeFromStr->ToString(false).Equals("[]"));
-	}
-	{
-		FString strJson0 = R"({"str":"ssss","num":22,"bool":true,"array":[1,2,3],"null":null,"obj":{"a":"a","b":"b"}})";
-		UJsonValue* madeFromStr = MakeFromString(strJson0);
-		check(madeFromStr);
-		TSharedPtr<FJsonValue> ccped = madeFromStr->ToCPPVersion();
-		UJsonValue* remade = MakeFromCPPVersion(ccped);
-		FString reStringed = remade->ToString(false);
-		FString reStringedPretty = remade->ToString(true);
-
-		UJsonValue* remadeFrom_reStringed = MakeFromString(reStringed);
-		FString reReStringed = remadeFrom_reStringed->ToString(false);
-		ensureAlways(reStringed.Equals(reReStringed));
-		ensureAlways(true);
-	}
-	{
-	}
-	//ensureAlways(false);
-}
-#endif
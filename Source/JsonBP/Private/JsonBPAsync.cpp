@@ -0,0 +1,223 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPAsync.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPDocument.h"
+#include "JsonBPReader.h"
+#include "JsonBPWriter.h"
+#include "JsonBPDocumentBuilder.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarJsonBPAsyncMaxConcurrentJobs(
+	TEXT("JsonBP.Async.MaxConcurrentJobs"),
+	4,
+	TEXT("maximum number of async json parse/stringify jobs running on worker threads at the same time"));
+
+struct FJsonBPAsyncJob
+{
+	//set by Cancel() on the game thread, polled by the worker
+	FThreadSafeBool bCancelled;
+	//parse input or stringify output
+	FString Text;
+	bool bPretty = false;
+	bool bSucceeded = false;
+	FJsonBPDocumentData Data;
+};
+
+/*
+forwards to another handler but stops the reader as soon as the job is cancelled
+*/
+template<typename HandlerType> class TJsonBPCancelableHandler
+{
+public:
+	TJsonBPCancelableHandler(HandlerType& inner, const FThreadSafeBool& bCancelled) : Inner(inner), bCancelled(bCancelled) {}
+
+	bool OnNull() { return !bCancelled && Inner.OnNull(); }
+	bool OnBoolean(bool value) { return !bCancelled && Inner.OnBoolean(value); }
+	bool OnNumber(double value) { return !bCancelled && Inner.OnNumber(value); }
+	bool OnInteger(int64 value) { return !bCancelled && Inner.OnInteger(value); }
+	bool OnString(const FString& value) { return !bCancelled && Inner.OnString(value); }
+	bool OnArrayBegin() { return !bCancelled && Inner.OnArrayBegin(); }
+	bool OnArrayEnd() { return !bCancelled && Inner.OnArrayEnd(); }
+	bool OnObjectBegin() { return !bCancelled && Inner.OnObjectBegin(); }
+	bool OnObjectKey(const FString& key) { return !bCancelled && Inner.OnObjectKey(key); }
+	bool OnObjectEnd() { return !bCancelled && Inner.OnObjectEnd(); }
+
+private:
+	HandlerType& Inner;
+	const FThreadSafeBool& bCancelled;
+};
+
+/*
+runs jobs on the thread pool limiting how many are in flight. game thread only.
+*/
+class FJsonBPAsyncQueue
+{
+public:
+	static FJsonBPAsyncQueue& Get()
+	{
+		static FJsonBPAsyncQueue instance;
+		return instance;
+	}
+
+	//work runs on a worker thread, completion on the game thread
+	void Enqueue(TFunction<void()> work, TFunction<void()> completion)
+	{
+		check(IsInGameThread());
+		FEntry& entry = Waiting.AddDefaulted_GetRef();
+		entry.Work = MoveTemp(work);
+		entry.Completion = MoveTemp(completion);
+		StartWaiting();
+	}
+
+private:
+	struct FEntry
+	{
+		TFunction<void()> Work;
+		TFunction<void()> Completion;
+	};
+
+	void StartWaiting()
+	{
+		const int32 maxJobs = FMath::Max(1, CVarJsonBPAsyncMaxConcurrentJobs.GetValueOnGameThread());
+		while (NumRunning < maxJobs && Waiting.Num() > 0)
+		{
+			FEntry entry = MoveTemp(Waiting[0]);
+			Waiting.RemoveAt(0, 1, false);
+			NumRunning++;
+
+			Async(EAsyncExecution::ThreadPool, [entry]()
+			{
+				entry.Work();
+				AsyncTask(ENamedThreads::GameThread, [entry]()
+				{
+					entry.Completion();
+
+					FJsonBPAsyncQueue& queue = FJsonBPAsyncQueue::Get();
+					queue.NumRunning--;
+					queue.StartWaiting();
+				});
+			});
+		}
+	}
+
+	TArray<FEntry> Waiting;
+	int32 NumRunning = 0;
+};
+
+
+
+UJsonParseAsyncAction* UJsonParseAsyncAction::ParseJsonAsync(UObject* worldContextObject, const FString& json)
+{
+	UJsonParseAsyncAction* pAction = NewObject<UJsonParseAsyncAction>();
+	pAction->Job = MakeShared<FJsonBPAsyncJob, ESPMode::ThreadSafe>();
+	pAction->Job->Text = json;
+	pAction->RegisterWithGameInstance(worldContextObject);
+	return pAction;
+}
+
+void UJsonParseAsyncAction::Activate()
+{
+	TSharedPtr<FJsonBPAsyncJob, ESPMode::ThreadSafe> job = Job;
+	TWeakObjectPtr<UJsonParseAsyncAction> weakThis(this);
+
+	FJsonBPAsyncQueue::Get().Enqueue(
+		[job]()
+		{
+			if (job->bCancelled)
+				return;
+
+			JSONBP_SCOPE(ParseDocument);
+			JSONBP_COUNT(BytesParsed, job->Text.Len() * sizeof(TCHAR));
+			TJsonBPReader<TCHAR> reader(*job->Text, job->Text.Len());
+			FJsonBPDocumentBuilder builder(job->Data, job->Text.Len());
+			TJsonBPCancelableHandler<FJsonBPDocumentBuilder> handler(builder, job->bCancelled);
+			job->bSucceeded = reader.ReadDocument(handler);
+			if (!job->bSucceeded && !job->bCancelled)
+				UE_LOG(LogJsonBP, Verbose, TEXT("ParseJsonAsync failed: %s"), *reader.GetErrorText());
+
+			//the text is not needed anymore
+			job->Text.Empty();
+		},
+		[weakThis]()
+		{
+			if (UJsonParseAsyncAction* pThis = weakThis.Get())
+				pThis->OnCompleted();
+		});
+}
+
+void UJsonParseAsyncAction::OnCompleted()
+{
+	if (!Job->bCancelled)
+	{
+		if (Job->bSucceeded)
+			OnSuccess.Broadcast(Job->Data.MakeJsonValue(Job->Data.Root));
+		else
+			OnFailure.Broadcast(nullptr);
+	}
+
+	Job->Data.Reset();
+	SetReadyToDestroy();
+}
+
+void UJsonParseAsyncAction::Cancel()
+{
+	if (Job.IsValid())
+		Job->bCancelled = true;
+}
+
+
+
+UJsonStringifyAsyncAction* UJsonStringifyAsyncAction::StringifyJsonAsync(UObject* worldContextObject, UJsonValue* value, bool bPretty)
+{
+	UJsonStringifyAsyncAction* pAction = NewObject<UJsonStringifyAsyncAction>();
+	pAction->Job = MakeShared<FJsonBPAsyncJob, ESPMode::ThreadSafe>();
+	pAction->Job->bPretty = bPretty;
+	pAction->Value = value;
+	pAction->RegisterWithGameInstance(worldContextObject);
+	return pAction;
+}
+
+void UJsonStringifyAsyncAction::Activate()
+{
+	//snapshot now, the value may change while the worker is writing
+	Job->Data.Assign(Value);
+	Value = nullptr;
+
+	TSharedPtr<FJsonBPAsyncJob, ESPMode::ThreadSafe> job = Job;
+	TWeakObjectPtr<UJsonStringifyAsyncAction> weakThis(this);
+
+	FJsonBPAsyncQueue::Get().Enqueue(
+		[job]()
+		{
+			if (job->bCancelled || job->Data.Root == INDEX_NONE)
+				return;
+
+			TArray<TCHAR>& chars = job->Text.GetCharArray();
+			TJsonBPWriter<TCHAR> writer(chars, job->bPretty);
+			job->Data.WriteTo(writer, job->Data.Root);
+			chars.Add(TEXT('\0'));
+			job->Data.Reset();
+		},
+		[weakThis]()
+		{
+			if (UJsonStringifyAsyncAction* pThis = weakThis.Get())
+				pThis->OnJobCompleted();
+		});
+}
+
+void UJsonStringifyAsyncAction::OnJobCompleted()
+{
+	if (!Job->bCancelled)
+		OnCompleted.Broadcast(Job->Text);
+
+	Job->Text.Empty();
+	SetReadyToDestroy();
+}
+
+void UJsonStringifyAsyncAction::Cancel()
+{
+	if (Job.IsValid())
+		Job->bCancelled = true;
+}
@@ -0,0 +1,287 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBP.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPDocument.h"
+#include "JsonBPBenchmark.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+
+#if !UE_BUILD_SHIPPING
+
+//the parse path before TJsonBPReader: wrapper copy, FJsonValue tree, then UJsonValue tree
+UJsonValue* JsonBPLegacyMakeFromString(const FString& jsonValue)
+{
+	FString arrayedJson;
+	arrayedJson.Reserve(jsonValue.Len() + 8);
+	arrayedJson += TEXT("[");
+	arrayedJson += jsonValue;
+	arrayedJson += TEXT("]");
+
+	TArray<TSharedPtr<FJsonValue>> resultArray;
+	TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(arrayedJson);
+	if (!FJsonSerializer::Deserialize(JsonReader, resultArray) || resultArray.Num() == 0)
+		return nullptr;
+
+	return UJsonValue::MakeFromCPPVersion(resultArray[0]);
+}
+
+//the stringify path before TJsonBPWriter: FJsonValue tree, FJsonSerializer, then the leading comma fix up
+FString JsonBPLegacyToString(const UJsonValue* pValue, bool bPretty)
+{
+	TSharedPtr<FJsonValue> jsValue = pValue->ToCPPVersion();
+	FString OutputString;
+	if (bPretty)
+	{
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
+		FJsonSerializer::Serialize(jsValue, FString(), Writer);
+	}
+	else
+	{
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutputString);
+		FJsonSerializer::Serialize(jsValue, FString(), Writer);
+	}
+
+	if (OutputString.Len() > 0 && OutputString[0] == TEXT(','))
+		OutputString.RemoveAt(0, bPretty ? 3 : 1, false);
+
+	return OutputString;
+}
+
+//an array of small records, used when no file is given
+FString JsonBPMakeSampleDocument(int32 numRecords)
+{
+	FString json;
+	json.Reserve(numRecords * 96);
+	json += TEXT("[");
+	for (int32 i = 0; i < numRecords; i++)
+	{
+		if (i)
+			json += TEXT(",");
+		json += FString::Printf(TEXT(R"({"id":%d,"name":"record_%d","score":%f,"alive":%s,"tags":["a","b"],"pos":{"x":%d,"y":%d}})"),
+			i, i, i * 0.25f, (i & 1) ? TEXT("true") : TEXT("false"), i % 100, i % 37);
+	}
+	json += TEXT("]");
+	return json;
+}
+
+FString JsonBPMakeWideDocument(int32 numFields)
+{
+	FString json;
+	json.Reserve(numFields * 32);
+	json += TEXT("{");
+	for (int32 i = 0; i < numFields; i++)
+	{
+		if (i)
+			json += TEXT(",");
+		switch (i % 4)
+		{
+		case 0: json += FString::Printf(TEXT(R"("field_%d":%d)"), i, i * 7); break;
+		case 1: json += FString::Printf(TEXT(R"("field_%d":"value_%d")"), i, i); break;
+		case 2: json += FString::Printf(TEXT(R"("field_%d":%s)"), i, (i & 4) ? TEXT("true") : TEXT("null")); break;
+		default: json += FString::Printf(TEXT(R"("field_%d":%f)"), i, i * 0.5f); break;
+		}
+	}
+	json += TEXT("}");
+	return json;
+}
+
+FString JsonBPMakeDeepDocument(int32 depth)
+{
+	FString json;
+	json.Reserve(depth * 48);
+	for (int32 i = 0; i < depth; i++)
+	{
+		//an object and an array per level so both kinds of nesting are covered
+		if (i & 1)
+			json += FString::Printf(TEXT(R"([%d,"level_%d",)"), i, i);
+		else
+			json += FString::Printf(TEXT(R"({"level":%d,"name":"level_%d","child":)"), i, i);
+	}
+	json += TEXT("null");
+	for (int32 i = depth - 1; i >= 0; i--)
+		json += (i & 1) ? TEXT("]") : TEXT("}");
+	return json;
+}
+
+FString JsonBPMakeNumericDocument(int32 numArrays)
+{
+	FString json;
+	json.Reserve(numArrays * 2048);
+	json += TEXT("{");
+	for (int32 i = 0; i < numArrays; i++)
+	{
+		if (i)
+			json += TEXT(",");
+		json += FString::Printf(TEXT(R"("samples_%d":[)"), i);
+		//integers and doubles alternate between the arrays
+		for (int32 j = 0; j < 128; j++)
+		{
+			if (j)
+				json += TEXT(",");
+			if (i & 1)
+				json += FString::FromInt(i * j - 64);
+			else
+				json += FString::Printf(TEXT("%f"), (i + j) * 0.125f);
+		}
+		json += FString::Printf(TEXT(R"(],"names_%d":[)"), i);
+		for (int32 j = 0; j < 32; j++)
+			json += FString::Printf(TEXT(R"(%s"name_%d")"), j ? TEXT(",") : TEXT(""), j);
+		json += TEXT("]");
+	}
+	json += TEXT("}");
+	return json;
+}
+
+int32 JsonBPCountValues(const UJsonValue* pValue)
+{
+	if (!pValue)
+		return 0;
+
+	if (pValue->IsPacked())
+		return 1 + pValue->GetArrayLength();
+
+	int32 count = 1;
+	for (const UJsonValue* pElement : pValue->GetArrayRef())
+		count += JsonBPCountValues(pElement);
+	for (const auto& pair : pValue->GetObjectRef())
+		count += JsonBPCountValues(pair.Value);
+	return count;
+}
+
+static void JsonBPBenchParse(const TArray<FString>& args)
+{
+	FString json;
+	if (args.Num() > 0 && !args[0].IsNumeric())
+	{
+		if (!FFileHelper::LoadFileToString(json, *args[0]))
+		{
+			UE_LOG(LogJsonBP, Error, TEXT("failed to load %s"), *args[0]);
+			return;
+		}
+	}
+	else
+	{
+		json = JsonBPMakeSampleDocument(args.Num() > 0 ? FCString::Atoi(*args[0]) : 20000);
+	}
+
+	const int32 iterations = args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*args[1])) : 5;
+	const double megaBytes = json.Len() * sizeof(TCHAR) / (1024.0 * 1024.0);
+
+	const FJsonBPBenchResult legacy = JsonBPMeasure(iterations, [&json]() { JsonBPLegacyMakeFromString(json); });
+	const FJsonBPBenchResult direct = JsonBPMeasure(iterations, [&json]() { UJsonValue::MakeFromString(json); });
+	const FJsonBPBenchResult document = JsonBPMeasure(iterations, [&json]() { UJsonDocument::MakeDocumentFromString(json); });
+
+	UE_LOG(LogJsonBP, Display, TEXT("JsonBP parse benchmark, %.2f MB of text, %d iterations"), megaBytes, iterations);
+	UE_LOG(LogJsonBP, Display, TEXT("  legacy : %8.2f ms  %8.2f MB/s  peak %8.2f MB  %lld values"),
+		legacy.Seconds * 1000, megaBytes / legacy.Seconds, legacy.PeakBytes / (1024.0 * 1024.0), legacy.NumValues);
+	UE_LOG(LogJsonBP, Display, TEXT("  direct : %8.2f ms  %8.2f MB/s  peak %8.2f MB  %lld values"),
+		direct.Seconds * 1000, megaBytes / direct.Seconds, direct.PeakBytes / (1024.0 * 1024.0), direct.NumValues);
+	UE_LOG(LogJsonBP, Display, TEXT("  document : %8.2f ms  %8.2f MB/s  peak %8.2f MB  %lld values"),
+		document.Seconds * 1000, megaBytes / document.Seconds, document.PeakBytes / (1024.0 * 1024.0), document.NumValues);
+}
+
+static void JsonBPBenchStringify(const TArray<FString>& args)
+{
+	const int32 numRecords = args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*args[0])) : 20000;
+	const int32 iterations = args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*args[1])) : 5;
+
+	UJsonValue* pValue = UJsonValue::MakeFromString(JsonBPMakeSampleDocument(numRecords));
+	check(pValue);
+	//keep it alive across the garbage collections done between the measurements
+	pValue->AddToRoot();
+
+	for (const bool bPretty : { false, true })
+	{
+		const double megaBytes = pValue->ToString(bPretty).Len() * sizeof(TCHAR) / (1024.0 * 1024.0);
+		const FJsonBPBenchResult legacy = JsonBPMeasure(iterations, [pValue, bPretty]() { JsonBPLegacyToString(pValue, bPretty); });
+		const FJsonBPBenchResult direct = JsonBPMeasure(iterations, [pValue, bPretty]() { pValue->ToString(bPretty); });
+
+		UE_LOG(LogJsonBP, Display, TEXT("JsonBP stringify benchmark (%s), %.2f MB of text, %d iterations"), bPretty ? TEXT("pretty") : TEXT("condensed"), megaBytes, iterations);
+		UE_LOG(LogJsonBP, Display, TEXT("  legacy : %8.2f ms  %8.2f MB/s  peak %8.2f MB  %lld values"),
+			legacy.Seconds * 1000, megaBytes / legacy.Seconds, legacy.PeakBytes / (1024.0 * 1024.0), legacy.NumValues);
+		UE_LOG(LogJsonBP, Display, TEXT("  direct : %8.2f ms  %8.2f MB/s  peak %8.2f MB  %lld values"),
+			direct.Seconds * 1000, megaBytes / direct.Seconds, direct.PeakBytes / (1024.0 * 1024.0), direct.NumValues);
+	}
+
+	pValue->RemoveFromRoot();
+}
+
+static void JsonBPBenchMsgPack(const TArray<FString>& args)
+{
+	const int32 numRecords = args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*args[0])) : 20000;
+	const int32 iterations = args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*args[1])) : 5;
+
+	const FString json = JsonBPMakeSampleDocument(numRecords);
+	UJsonValue* pValue = UJsonValue::MakeFromString(json);
+	check(pValue);
+	pValue->AddToRoot();
+
+	TArray<uint8> utf8;
+	TArray<uint8> msgPack;
+	pValue->ToUTF8Bytes(false, utf8);
+	pValue->ToMsgPack(msgPack);
+
+	const FJsonBPBenchResult textWrite = JsonBPMeasure(iterations, [pValue]() { pValue->ToString(false); });
+	const FJsonBPBenchResult utf8Write = JsonBPMeasure(iterations, [pValue, &utf8]() { pValue->ToUTF8Bytes(false, utf8); });
+	const FJsonBPBenchResult msgPackWrite = JsonBPMeasure(iterations, [pValue, &msgPack]() { pValue->ToMsgPack(msgPack); });
+	const FJsonBPBenchResult textRead = JsonBPMeasure(iterations, [&json]() { UJsonValue::MakeFromString(json); });
+	const FJsonBPBenchResult utf8Read = JsonBPMeasure(iterations, [&utf8]() { UJsonValue::MakeFromUTF8Bytes(utf8); });
+	const FJsonBPBenchResult msgPackRead = JsonBPMeasure(iterations, [&msgPack]() { UJsonValue::MakeFromMsgPack(msgPack); });
+
+	pValue->RemoveFromRoot();
+
+	UE_LOG(LogJsonBP, Display, TEXT("JsonBP MessagePack benchmark, %d records, %d iterations"), numRecords, iterations);
+	UE_LOG(LogJsonBP, Display, TEXT("  size    : text %lld bytes  UTF-8 %d bytes  MessagePack %d bytes (%.1f%% of UTF-8)"),
+		(int64)(json.Len() * sizeof(TCHAR)), utf8.Num(), msgPack.Num(), 100.0 * msgPack.Num() / FMath::Max(utf8.Num(), 1));
+	UE_LOG(LogJsonBP, Display, TEXT("  write   : ToString %8.2f ms  ToUTF8Bytes %8.2f ms  ToMsgPack %8.2f ms"),
+		textWrite.Seconds * 1000, utf8Write.Seconds * 1000, msgPackWrite.Seconds * 1000);
+	UE_LOG(LogJsonBP, Display, TEXT("  read    : MakeFromString %8.2f ms  MakeFromUTF8Bytes %8.2f ms  MakeFromMsgPack %8.2f ms"),
+		textRead.Seconds * 1000, utf8Read.Seconds * 1000, msgPackRead.Seconds * 1000);
+}
+
+static void JsonBPBenchParallel(const TArray<FString>& args)
+{
+	const int32 numRecords = args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*args[0])) : 100000;
+	const int32 iterations = args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*args[1])) : 5;
+
+	//the sample document is one big array of records, the case the parallel mode is for
+	const FString json = JsonBPMakeSampleDocument(numRecords);
+	TSharedPtr<FJsonValue> jsValue = HelperParseJSON(json);
+	check(jsValue.IsValid());
+
+	const FJsonBPBenchResult serialRead = JsonBPMeasure(iterations, [&json]() { HelperParseJSON(json); });
+	const FJsonBPBenchResult parallelRead = JsonBPMeasure(iterations, [&json]() { HelperParseJSON(json, true); });
+	const FJsonBPBenchResult serialWrite = JsonBPMeasure(iterations, [&jsValue]() { HelperStringifyJSON(jsValue); });
+	const FJsonBPBenchResult parallelWrite = JsonBPMeasure(iterations, [&jsValue]() { HelperStringifyJSON(jsValue, false, true); });
+	const bool bSame = HelperStringifyJSON(jsValue) == HelperStringifyJSON(jsValue, false, true);
+
+	UE_LOG(LogJsonBP, Display, TEXT("JsonBP parallel benchmark, %d records, %d iterations, %d worker threads"), numRecords, iterations, FTaskGraphInterface::Get().GetNumWorkerThreads());
+	UE_LOG(LogJsonBP, Display, TEXT("  HelperParseJSON     : serial %8.2f ms  parallel %8.2f ms  (%.2fx)"),
+		serialRead.Seconds * 1000, parallelRead.Seconds * 1000, serialRead.Seconds / FMath::Max(parallelRead.Seconds, 1e-9));
+	UE_LOG(LogJsonBP, Display, TEXT("  HelperStringifyJSON : serial %8.2f ms  parallel %8.2f ms  (%.2fx)  output %s"),
+		serialWrite.Seconds * 1000, parallelWrite.Seconds * 1000, serialWrite.Seconds / FMath::Max(parallelWrite.Seconds, 1e-9), bSame ? TEXT("identical") : TEXT("DIFFERENT"));
+}
+
+static FAutoConsoleCommand GJsonBPBenchParseCommand(
+	TEXT("JsonBP.Bench.Parse"),
+	TEXT("compares MakeFromString against the old FJsonSerializer based path. usage: JsonBP.Bench.Parse [file | numRecords] [iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&JsonBPBenchParse));
+
+static FAutoConsoleCommand GJsonBPBenchStringifyCommand(
+	TEXT("JsonBP.Bench.Stringify"),
+	TEXT("compares UJsonValue::ToString against the old ToCPPVersion + FJsonSerializer path. usage: JsonBP.Bench.Stringify [numRecords] [iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&JsonBPBenchStringify));
+
+static FAutoConsoleCommand GJsonBPBenchMsgPackCommand(
+	TEXT("JsonBP.Bench.MsgPack"),
+	TEXT("compares the size and speed of MessagePack against text. usage: JsonBP.Bench.MsgPack [numRecords] [iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&JsonBPBenchMsgPack));
+
+static FAutoConsoleCommand GJsonBPBenchParallelCommand(
+	TEXT("JsonBP.Bench.Parallel"),
+	TEXT("compares serial and parallel HelperParseJSON/HelperStringifyJSON. usage: JsonBP.Bench.Parallel [numRecords] [iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&JsonBPBenchParallel));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+#include "JsonBPPrivate.h"
+#include "UObject/UObjectGlobals.h"
+
+class UJsonValue;
+
+#if !UE_BUILD_SHIPPING
+
+struct FJsonBPBenchResult
+{
+	double Seconds = 0;
+	//growth of the process memory over one run, page granular
+	int64 PeakBytes = 0;
+	//values made on the calling thread in one run
+	int64 NumValues = 0;
+};
+
+template<typename FuncType> FJsonBPBenchResult JsonBPMeasure(int32 iterations, FuncType func)
+{
+	FJsonBPBenchResult result;
+
+	//memory is measured on a single run, timing on all of them
+	{
+		const int64 valuesBefore = JsonBPValuesMadeOnThread;
+		const FPlatformMemoryStats before = FPlatformMemory::GetStats();
+		func();
+		const FPlatformMemoryStats after = FPlatformMemory::GetStats();
+		result.NumValues = JsonBPValuesMadeOnThread - valuesBefore;
+		//the process peak only moves if the run went past it, otherwise what the run still holds is the best estimate
+		const uint64 high = after.PeakUsedPhysical > before.PeakUsedPhysical ? after.PeakUsedPhysical : after.UsedPhysical;
+		result.PeakBytes = FMath::Max<int64>(0, (int64)high - (int64)before.UsedPhysical);
+	}
+
+	const double startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < iterations; i++)
+		func();
+	result.Seconds = (FPlatformTime::Seconds() - startTime) / FMath::Max(iterations, 1);
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	return result;
+}
+
+//the parse path before TJsonBPReader: wrapper copy, FJsonValue tree, then UJsonValue tree
+UJsonValue* JsonBPLegacyMakeFromString(const FString& jsonValue);
+//the stringify path before TJsonBPWriter: FJsonValue tree, FJsonSerializer, then the leading comma fix up
+FString JsonBPLegacyToString(const UJsonValue* pValue, bool bPretty);
+
+//an array of small records
+FString JsonBPMakeSampleDocument(int32 numRecords);
+//one object with numFields fields of mixed types
+FString JsonBPMakeWideDocument(int32 numFields);
+//objects and arrays nested depth levels deep, with a few values on each level
+FString JsonBPMakeDeepDocument(int32 depth);
+//samples of numbers and names in long arrays of one element type each, numArrays of them
+FString JsonBPMakeNumericDocument(int32 numArrays);
+
+//number of values in the tree, containers included. packed elements count without being expanded
+int32 JsonBPCountValues(const UJsonValue* pValue);
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,111 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBP.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPDocument.h"
+
+
+UJsonValue* UJsonValue::CopyNode() const
+{
+	UJsonValue* pCopy = MakeJsonValue();
+	pCopy->JsonType = JsonType;
+	pCopy->ValueBool = ValueBool;
+	pCopy->ValueString = ValueString;
+	pCopy->bIntegerNumber = bIntegerNumber;
+	pCopy->ValueInteger = ValueInteger;
+	pCopy->ValueNumber = ValueNumber;
+	//a lazy container shares its document, the copy expands on its own
+	pCopy->LazyDocument = LazyDocument;
+	pCopy->LazyNode = LazyNode;
+	if (Packed)
+		pCopy->Packed = MakeUnique<FJsonBPPackedElements>(*Packed);
+	return pCopy;
+}
+
+UJsonValue* UJsonValue::DeepCopy() const
+{
+	UJsonValue* pCopy = CopyNode();
+
+	pCopy->ValueArray.Reserve(ValueArray.Num());
+	for (const UJsonValue* pElement : ValueArray)
+		pCopy->ValueArray.Add(pElement ? pElement->DeepCopy() : nullptr);
+
+	pCopy->ValueObject.Reserve(ValueObject.Num());
+	for (const auto& pair : ValueObject)
+		pCopy->ValueObject.Add(pair.Key, pair.Value ? pair.Value->DeepCopy() : nullptr);
+
+	return pCopy;
+}
+
+UJsonValue* UJsonValue::ShallowCopy() const
+{
+	UJsonValue* pCopy = CopyNode();
+	pCopy->ValueArray = ValueArray;
+	pCopy->ValueObject = ValueObject;
+	return pCopy;
+}
+
+bool UJsonValue::MoveFrom(UJsonValue* source)
+{
+	if (!source || source == this || source->bShared || !CanModify())
+		return false;
+
+	Clear();
+	JsonType = source->JsonType;
+	ValueBool = source->ValueBool;
+	ValueString = MoveTemp(source->ValueString);
+	bIntegerNumber = source->bIntegerNumber;
+	ValueInteger = source->ValueInteger;
+	ValueNumber = source->ValueNumber;
+	ValueArray = MoveTemp(source->ValueArray);
+	ValueObject = MoveTemp(source->ValueObject);
+	LazyDocument = MoveTemp(source->LazyDocument);
+	LazyNode = source->LazyNode;
+	Packed = MoveTemp(source->Packed);
+	//the children now report their changes to this value
+	AttachChildrenToTextCache(source);
+	source->Clear();
+	return true;
+}
+
+void UJsonValue::MarkShared()
+{
+	if (bShared)
+		return;
+
+	//children of a lazy container are marked when they are created
+	bShared = true;
+	for (UJsonValue* pElement : ValueArray)
+	{
+		if (pElement)
+			pElement->MarkShared();
+	}
+	for (const auto& pair : ValueObject)
+	{
+		if (pair.Value)
+			pair.Value->MarkShared();
+	}
+}
+
+UJsonValue* UJsonValue::CopyOnWrite()
+{
+	MarkShared();
+	//the new root is not shared, its children are
+	return ShallowCopy();
+}
+
+UJsonValue* UJsonValue::UnshareChild(UJsonValue*& child) const
+{
+	if (child && child->bShared && !bShared)
+	{
+		child = child->ShallowCopy();
+		const_cast<UJsonValue*>(this)->AttachToTextCache(child);
+	}
+	return child;
+}
+
+bool UJsonValue::ReportSharedModify() const
+{
+	UE_LOG(LogJsonBP, Warning, TEXT("a shared json value can't be changed, change a CopyOnWrite or DeepCopy of it instead"));
+	return false;
+}
@@ -0,0 +1,559 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPDocument.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPReader.h"
+#include "JsonBPDocumentBuilder.h"
+
+
+void FJsonBPDocumentData::Reset()
+{
+	Nodes.Reset();
+	Strings.Reset();
+	Root = INDEX_NONE;
+}
+
+template<typename CharType> static bool ParseDocumentData(FJsonBPDocumentData& data, const CharType* text, int32 length, FString* outError)
+{
+	JSONBP_SCOPE(ParseDocument);
+	JSONBP_COUNT(BytesParsed, length * sizeof(CharType));
+	data.Reset();
+
+	TJsonBPReader<CharType> reader(text, length);
+	FJsonBPDocumentBuilder builder(data, length);
+	if (!reader.ReadDocument(builder))
+	{
+		if (outError)
+			*outError = reader.GetErrorText();
+		data.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FJsonBPDocumentData::Parse(const TCHAR* text, int32 length, FString* outError)
+{
+	return ParseDocumentData(*this, text, length, outError);
+}
+
+bool FJsonBPDocumentData::ParseUTF8(const ANSICHAR* text, int32 length, FString* outError)
+{
+	return ParseDocumentData(*this, text, length, outError);
+}
+
+int32 FJsonBPDocumentData::Num(int32 index) const
+{
+	const EJsonType type = GetType(index);
+	if (type == EJsonType::JSON_Array || type == EJsonType::JSON_Object)
+		return Nodes[index].Range.Count;
+
+	return 0;
+}
+
+int32 FJsonBPDocumentData::NumDistinctFields(int32 index) const
+{
+	if (GetType(index) != EJsonType::JSON_Object)
+		return 0;
+
+	const FNode& node = Nodes[index];
+	if (!node.bDuplicateKeys)
+		return node.Range.Count;
+
+	//a field counts once, at its last key
+	int32 count = 0;
+	for (int32 i = node.Range.First; i < node.Range.First + node.Range.Count; i++)
+	{
+		const FRange& key = Nodes[i].Key;
+		if (FindField(index, Strings.GetData() + key.First, key.Count) == i)
+			count++;
+	}
+	return count;
+}
+
+FString FJsonBPDocumentData::GetString(int32 index) const
+{
+	if (GetType(index) != EJsonType::JSON_String)
+		return FString();
+
+	const FRange& range = Nodes[index].Range;
+	return FString(range.Count, Strings.GetData() + range.First);
+}
+
+double FJsonBPDocumentData::GetNumber(int32 index) const
+{
+	if (GetType(index) != EJsonType::JSON_Number)
+		return 0;
+
+	const FNode& node = Nodes[index];
+	return node.bInteger ? (double)node.Integer : node.Number;
+}
+
+int64 FJsonBPDocumentData::GetInteger(int32 index) const
+{
+	if (GetType(index) != EJsonType::JSON_Number)
+		return 0;
+
+	const FNode& node = Nodes[index];
+	return node.bInteger ? node.Integer : JsonBPDoubleToInt64(node.Number);
+}
+
+FString FJsonBPDocumentData::GetKey(int32 index) const
+{
+	if (!Nodes.IsValidIndex(index))
+		return FString();
+
+	const FRange& key = Nodes[index].Key;
+	return FString(key.Count, Strings.GetData() + key.First);
+}
+
+int32 FJsonBPDocumentData::GetChild(int32 index, int32 element) const
+{
+	if (element < 0 || element >= Num(index))
+		return INDEX_NONE;
+
+	return Nodes[index].Range.First + element;
+}
+
+int32 FJsonBPDocumentData::FindField(int32 index, const TCHAR* key, int32 keyLength) const
+{
+	if (GetType(index) != EJsonType::JSON_Object)
+		return INDEX_NONE;
+
+	//from the end, the last of repeated keys wins like it does in UJsonValue
+	const FRange& children = Nodes[index].Range;
+	for (int32 i = children.First + children.Count - 1; i >= children.First; i--)
+	{
+		const FRange& childKey = Nodes[i].Key;
+		if (childKey.Count == keyLength && FMemory::Memcmp(Strings.GetData() + childKey.First, key, keyLength * sizeof(TCHAR)) == 0)
+			return i;
+	}
+
+	return INDEX_NONE;
+}
+
+UJsonValue* FJsonBPDocumentData::MakeJsonValue(int32 index) const
+{
+	if (!Nodes.IsValidIndex(index))
+		return nullptr;
+
+	const FNode& node = Nodes[index];
+	switch (node.Type)
+	{
+	case EJsonType::JSON_None: return nullptr;
+	case EJsonType::JSON_Null: return UJsonValue::MakeNull();
+	case EJsonType::JSON_String: return UJsonValue::MakeString(GetString(index));
+	case EJsonType::JSON_Number: return node.bInteger ? UJsonValue::MakeInteger(node.Integer) : UJsonValue::MakeDouble(node.Number);
+	case EJsonType::JSON_Boolean: return UJsonValue::MakeBoolean(node.Bool);
+	case EJsonType::JSON_Array:
+	{
+		UJsonValue* pArray = ::MakeJsonValue();
+		pArray->JsonType = EJsonType::JSON_Array;
+		pArray->ValueArray.Reserve(node.Range.Count);
+		for (int32 i = 0; i < node.Range.Count; i++)
+			pArray->ValueArray.Add(MakeJsonValue(node.Range.First + i));
+
+		return pArray;
+	}
+	case EJsonType::JSON_Object:
+	{
+		UJsonValue* pObject = ::MakeJsonValue();
+		pObject->JsonType = EJsonType::JSON_Object;
+		pObject->ValueObject.Reserve(node.Range.Count);
+		for (int32 i = 0; i < node.Range.Count; i++)
+		{
+			const FRange& key = Nodes[node.Range.First + i].Key;
+			pObject->ValueObject.Add(FJsonBPKey(Strings.GetData() + key.First, key.Count), MakeJsonValue(node.Range.First + i));
+		}
+
+		return pObject;
+	}
+	}
+
+	return nullptr;
+}
+
+int32 FJsonBPDocumentData::EstimateTextLength(int32 index, bool bPretty) const
+{
+	const FNode& node = Nodes[index];
+	switch (node.Type)
+	{
+	case EJsonType::JSON_String: return node.Range.Count + 2;
+	case EJsonType::JSON_Number: return 12;
+	case EJsonType::JSON_Boolean: return 5;
+	case EJsonType::JSON_Array:
+	case EJsonType::JSON_Object:
+	{
+		const int32 perItem = bPretty ? 6 : 1;
+		int32 length = 2;
+		for (int32 i = 0; i < node.Range.Count; i++)
+		{
+			const FNode& child = Nodes[node.Range.First + i];
+			length += EstimateTextLength(node.Range.First + i, bPretty) + perItem + (node.Type == EJsonType::JSON_Object ? child.Key.Count + 3 : 0);
+		}
+		return length;
+	}
+	}
+
+	return 4;
+}
+
+void FJsonBPDocumentData::Assign(const UJsonValue* pValue)
+{
+	Reset();
+	if (!pValue || pValue->JsonType == EJsonType::JSON_None)
+		return;
+
+	FJsonBPDocumentBuilder builder(*this, pValue->EstimateTextLength(false));
+	FeedJsonValue(builder, pValue);
+}
+
+bool FJsonBPDocumentData::FeedJsonValue(FJsonBPDocumentBuilder& builder, const UJsonValue* pValue)
+{
+	if (!pValue)
+		return builder.OnNull();
+
+	//lazy and packed values are copied from what they hold, expanding them would make a UJsonValue per element
+	if (pValue->IsLazy())
+		return FeedDocumentNode(builder, *pValue->LazyDocument, pValue->LazyNode);
+	if (pValue->Packed)
+	{
+		const FJsonBPPackedElements& elements = *pValue->Packed;
+		builder.OnArrayBegin();
+		if (elements.bStrings)
+		{
+			for (const FString& element : elements.Strings)
+				builder.OnString(element);
+		}
+		else
+		{
+			for (double element : elements.Numbers)
+			{
+				if (elements.bIntegers)
+					builder.OnInteger((int64)element);
+				else
+					builder.OnNumber(element);
+			}
+		}
+		return builder.OnArrayEnd();
+	}
+
+	switch (pValue->JsonType)
+	{
+	case EJsonType::JSON_None:
+	case EJsonType::JSON_Null:
+		return builder.OnNull();
+	case EJsonType::JSON_String: return builder.OnString(pValue->ValueString);
+	case EJsonType::JSON_Number: return pValue->bIntegerNumber ? builder.OnInteger(pValue->ValueInteger) : builder.OnNumber(pValue->ValueNumber);
+	case EJsonType::JSON_Boolean: return builder.OnBoolean(pValue->ValueBool);
+	case EJsonType::JSON_Array:
+		builder.OnArrayBegin();
+		for (const UJsonValue* pElement : pValue->ValueArray)
+			FeedJsonValue(builder, pElement);
+		return builder.OnArrayEnd();
+	case EJsonType::JSON_Object:
+		builder.OnObjectBegin();
+		for (const auto& pair : pValue->ValueObject)
+		{
+			builder.OnObjectKey(pair.Key.ToString());
+			FeedJsonValue(builder, pair.Value);
+		}
+		return builder.OnObjectEnd();
+	}
+
+	return false;
+}
+
+bool FJsonBPDocumentData::FeedDocumentNode(FJsonBPDocumentBuilder& builder, const FJsonBPDocumentData& source, int32 index)
+{
+	//every field is copied like WriteTo writes them, repeated keys included
+	const FNode& node = source.Nodes[index];
+	switch (node.Type)
+	{
+	case EJsonType::JSON_None:
+	case EJsonType::JSON_Null:
+		return builder.OnNull();
+	case EJsonType::JSON_String: return builder.OnString(source.Strings.GetData() + node.Range.First, node.Range.Count);
+	case EJsonType::JSON_Number: return node.bInteger ? builder.OnInteger(node.Integer) : builder.OnNumber(node.Number);
+	case EJsonType::JSON_Boolean: return builder.OnBoolean(node.Bool);
+	case EJsonType::JSON_Array:
+		builder.OnArrayBegin();
+		for (int32 i = 0; i < node.Range.Count; i++)
+			FeedDocumentNode(builder, source, node.Range.First + i);
+		return builder.OnArrayEnd();
+	case EJsonType::JSON_Object:
+		builder.OnObjectBegin();
+		for (int32 i = 0; i < node.Range.Count; i++)
+		{
+			const FRange& key = source.Nodes[node.Range.First + i].Key;
+			builder.OnObjectKey(source.Strings.GetData() + key.First, key.Count);
+			FeedDocumentNode(builder, source, node.Range.First + i);
+		}
+		return builder.OnObjectEnd();
+	}
+
+	return false;
+}
+
+
+
+UJsonDocument::UJsonDocument()
+	: Data(MakeShared<FJsonBPDocumentData, ESPMode::ThreadSafe>())
+{
+}
+
+UJsonDocument* UJsonDocument::MakeDocumentFromString(const FString& value)
+{
+	TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> data = MakeShared<FJsonBPDocumentData, ESPMode::ThreadSafe>();
+	FString error;
+	if (!data->Parse(*value, value.Len(), &error))
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("MakeDocumentFromString failed: %s"), *error);
+		return nullptr;
+	}
+
+	return MakeDocument(data);
+}
+
+UJsonDocument* UJsonDocument::MakeDocumentFromUTF8(const ANSICHAR* text, int32 length)
+{
+	TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> data = MakeShared<FJsonBPDocumentData, ESPMode::ThreadSafe>();
+	FString error;
+	if (!data->ParseUTF8(text, length, &error))
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("MakeDocumentFromUTF8 failed: %s"), *error);
+		return nullptr;
+	}
+
+	return MakeDocument(data);
+}
+
+UJsonDocument* UJsonDocument::MakeDocument(TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> data)
+{
+	UJsonDocument* pDocument = NewObject<UJsonDocument>();
+	pDocument->Data = data;
+	return pDocument;
+}
+
+FJsonNode UJsonDocument::GetRoot()
+{
+	FJsonNode node;
+	node.Document = this;
+	node.Index = Data->Root;
+	return node;
+}
+
+const FJsonBPDocumentData* UJsonDocument::GetNodeData(const FJsonNode& node)
+{
+	if (!node.Document || !node.Document->Data->IsValidIndex(node.Index))
+		return nullptr;
+
+	return &node.Document->Data.Get();
+}
+
+bool UJsonDocument::IsValidNode(const FJsonNode& node)
+{
+	return GetNodeData(node) != nullptr;
+}
+
+EJsonType UJsonDocument::GetNodeType(const FJsonNode& node)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	return pData ? pData->GetType(node.Index) : EJsonType::JSON_None;
+}
+
+bool UJsonDocument::GetNodeAsString(const FJsonNode& node, FString& value)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (!pData || pData->GetType(node.Index) != EJsonType::JSON_String)
+		return false;
+
+	value = pData->GetString(node.Index);
+	return true;
+}
+
+bool UJsonDocument::GetNodeAsNumber(const FJsonNode& node, float& value)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (!pData || pData->GetType(node.Index) != EJsonType::JSON_Number)
+		return false;
+
+	value = (float)pData->GetNumber(node.Index);
+	return true;
+}
+
+bool UJsonDocument::GetNodeAsInteger(const FJsonNode& node, int64& value)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (!pData || pData->GetType(node.Index) != EJsonType::JSON_Number)
+		return false;
+
+	value = pData->GetInteger(node.Index);
+	return true;
+}
+
+bool UJsonDocument::GetNodeAsBoolean(const FJsonNode& node, bool& value)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (!pData || pData->GetType(node.Index) != EJsonType::JSON_Boolean)
+		return false;
+
+	value = pData->Nodes[node.Index].Bool;
+	return true;
+}
+
+int32 UJsonDocument::GetNodeLength(const FJsonNode& node)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	return pData ? pData->Num(node.Index) : 0;
+}
+
+FJsonNode UJsonDocument::GetNodeElement(const FJsonNode& node, int32 index)
+{
+	FJsonNode element;
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (pData && pData->GetType(node.Index) == EJsonType::JSON_Array)
+	{
+		element.Index = pData->GetChild(node.Index, index);
+		element.Document = element.Index != INDEX_NONE ? node.Document : nullptr;
+	}
+	return element;
+}
+
+FJsonNode UJsonDocument::GetNodeField(const FJsonNode& node, const FString& field)
+{
+	FJsonNode child;
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (pData)
+	{
+		child.Index = pData->FindField(node.Index, field);
+		child.Document = child.Index != INDEX_NONE ? node.Document : nullptr;
+	}
+	return child;
+}
+
+FJsonNode UJsonDocument::GetNodeFieldAt(const FJsonNode& node, int32 index, FString& field)
+{
+	FJsonNode child;
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (pData && pData->GetType(node.Index) == EJsonType::JSON_Object)
+	{
+		child.Index = pData->GetChild(node.Index, index);
+		if (child.Index != INDEX_NONE)
+		{
+			child.Document = node.Document;
+			field = pData->GetKey(child.Index);
+		}
+	}
+	return child;
+}
+
+UJsonValue* UJsonDocument::NodeToJsonValue(const FJsonNode& node)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	return pData ? pData->MakeJsonValue(node.Index) : nullptr;
+}
+
+FString UJsonDocument::NodeToString(const FJsonNode& node, bool bPretty)
+{
+	const FJsonBPDocumentData* pData = GetNodeData(node);
+	if (!pData)
+		return FString();
+
+	FString result;
+	TJsonBPWriter<TCHAR> writer(result.GetCharArray(), bPretty);
+	pData->WriteTo(writer, node.Index);
+	result.GetCharArray().Add(TEXT('\0'));
+	return result;
+}
+
+void UJsonDocument::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Data->GetAllocatedSize());
+}
+
+
+
+UJsonValue* UJsonValue::MakeLazyFromString(const FString& value)
+{
+	TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> data = MakeShared<FJsonBPDocumentData, ESPMode::ThreadSafe>();
+	FString error;
+	if (!data->Parse(*value, value.Len(), &error))
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("MakeLazyFromString failed: %s"), *error);
+		return nullptr;
+	}
+
+	return MakeLazy(data, data->Root);
+}
+
+UJsonValue* UJsonValue::MakeLazyFromUTF8(const ANSICHAR* text, int32 length)
+{
+	TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> data = MakeShared<FJsonBPDocumentData, ESPMode::ThreadSafe>();
+	FString error;
+	if (!data->ParseUTF8(text, length, &error))
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("MakeLazyFromUTF8 failed: %s"), *error);
+		return nullptr;
+	}
+
+	return MakeLazy(data, data->Root);
+}
+
+UJsonValue* UJsonValue::MakeLazy(const TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe>& document, int32 index)
+{
+	if (!document->IsValidIndex(index))
+		return nullptr;
+
+	//scalars are made right away, they have nothing to defer
+	const FJsonBPDocumentData::FNode& node = document->Nodes[index];
+	if (node.Type != EJsonType::JSON_Array && node.Type != EJsonType::JSON_Object)
+		return document->MakeJsonValue(index);
+
+	UJsonValue* pValue = ::MakeJsonValue();
+	pValue->JsonType = node.Type;
+	//empty containers have nothing to expand
+	if (node.Range.Count > 0)
+	{
+		pValue->LazyDocument = document;
+		pValue->LazyNode = index;
+	}
+	return pValue;
+}
+
+void UJsonValue::ExpandLazy() const
+{
+	//logically const, the children were there all along
+	UJsonValue* pThis = const_cast<UJsonValue*>(this);
+	const TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> document = pThis->LazyDocument.ToSharedRef();
+	const FJsonBPDocumentData::FNode& node = document->Nodes[LazyNode];
+	pThis->LazyDocument.Reset();
+	pThis->LazyNode = INDEX_NONE;
+
+	if (node.Type == EJsonType::JSON_Array)
+	{
+		pThis->ValueArray.Reserve(node.Range.Count);
+		for (int32 i = 0; i < node.Range.Count; i++)
+		{
+			UJsonValue* pChild = MakeLazy(document, node.Range.First + i);
+			//children of a shared value are shared too
+			pChild->bShared = bShared;
+			pThis->ValueArray.Add(pChild);
+		}
+	}
+	else
+	{
+		pThis->ValueObject.Reserve(node.Range.Count);
+		for (int32 i = 0; i < node.Range.Count; i++)
+		{
+			const FJsonBPDocumentData::FRange& key = document->Nodes[node.Range.First + i].Key;
+			UJsonValue* pChild = MakeLazy(document, node.Range.First + i);
+			pChild->bShared = bShared;
+			pThis->ValueObject.Add(FJsonBPKey(document->Strings.GetData() + key.First, key.Count), pChild);
+		}
+	}
+
+	//the new children join the text cache
+	pThis->AttachChildrenToTextCache();
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "JsonBPDocument.h"
+#include "Misc/Crc.h"
+
+/*
+TJsonBPReader handler that fills a FJsonBPDocumentData.
+finished values wait in Pending until their container ends, then the container's children are moved to Nodes as one contiguous range.
+*/
+class FJsonBPDocumentBuilder
+{
+public:
+	typedef FJsonBPDocumentData::FNode FNode;
+	typedef FJsonBPDocumentData::FRange FRange;
+
+	FJsonBPDocumentBuilder(FJsonBPDocumentData& data, int32 textLength)
+		: Data(data)
+	{
+		//rough guesses, most documents have a node every few characters and a good share of string characters
+		Data.Nodes.Reserve(textLength / 8 + 1);
+		Data.Strings.Reserve(textLength / 2 + 1);
+		CurrentKey.First = 0;
+		CurrentKey.Count = 0;
+	}
+
+	bool OnNull()
+	{
+		return AddNode(MakeNode(EJsonType::JSON_Null));
+	}
+	bool OnBoolean(bool value)
+	{
+		FNode node = MakeNode(EJsonType::JSON_Boolean);
+		node.Bool = value;
+		return AddNode(node);
+	}
+	bool OnNumber(double value)
+	{
+		FNode node = MakeNode(EJsonType::JSON_Number);
+		node.Number = value;
+		return AddNode(node);
+	}
+	bool OnInteger(int64 value)
+	{
+		FNode node = MakeNode(EJsonType::JSON_Number);
+		node.bInteger = true;
+		node.Integer = value;
+		return AddNode(node);
+	}
+	bool OnString(const FString& value) { return OnString(*value, value.Len()); }
+	bool OnString(const TCHAR* value, int32 length)
+	{
+		FNode node = MakeNode(EJsonType::JSON_String);
+		node.Range = AddString(value, length);
+		return AddNode(node);
+	}
+
+	bool OnArrayBegin() { return BeginContainer(); }
+	bool OnObjectBegin() { return BeginContainer(); }
+	bool OnArrayEnd() { return EndContainer(EJsonType::JSON_Array); }
+	bool OnObjectEnd() { return EndContainer(EJsonType::JSON_Object); }
+
+	bool OnObjectKey(const FString& key) { return OnObjectKey(*key, key.Len()); }
+	bool OnObjectKey(const TCHAR* key, int32 length)
+	{
+		CurrentKey = AddString(key, length);
+		return true;
+	}
+
+private:
+	struct FFrame
+	{
+		int32 FirstPending;
+		FRange Key;
+	};
+
+	FRange AddString(const TCHAR* value, int32 length)
+	{
+		FRange range;
+		range.First = Data.Strings.Num();
+		range.Count = length;
+		Data.Strings.Append(value, length);
+		return range;
+	}
+
+	FNode MakeNode(EJsonType type)
+	{
+		FNode node;
+		node.Type = type;
+		node.bInteger = false;
+		node.bDuplicateKeys = false;
+		node.Key = CurrentKey;
+		node.Range.First = 0;
+		node.Range.Count = 0;
+		CurrentKey.Count = 0;
+		return node;
+	}
+
+	bool AddNode(const FNode& node)
+	{
+		//the root is the last node to finish, it goes after all the others
+		if (Frames.Num() == 0)
+			Data.Root = Data.Nodes.Add(node);
+		else
+			Pending.Add(node);
+
+		return true;
+	}
+
+	bool BeginContainer()
+	{
+		FFrame& frame = Frames.AddUninitialized_GetRef();
+		frame.FirstPending = Pending.Num();
+		frame.Key = CurrentKey;
+		CurrentKey.Count = 0;
+		return true;
+	}
+
+	bool EndContainer(EJsonType type)
+	{
+		const FFrame frame = Frames.Pop(false);
+		const int32 count = Pending.Num() - frame.FirstPending;
+
+		const bool bDuplicateKeys = type == EJsonType::JSON_Object && HasDuplicateKeys(Pending.GetData() + frame.FirstPending, count);
+
+		FRange children;
+		children.First = Data.Nodes.Num();
+		children.Count = count;
+		Data.Nodes.Append(Pending.GetData() + frame.FirstPending, count);
+		Pending.SetNum(frame.FirstPending, false);
+
+		CurrentKey = frame.Key;
+		FNode node = MakeNode(type);
+		node.Range = children;
+		node.bDuplicateKeys = bDuplicateKeys;
+		return AddNode(node);
+	}
+
+	bool SameKey(const FNode& a, const FNode& b) const
+	{
+		return a.Key.Count == b.Key.Count && FMemory::Memcmp(Data.Strings.GetData() + a.Key.First, Data.Strings.GetData() + b.Key.First, a.Key.Count * sizeof(TCHAR)) == 0;
+	}
+
+	//repeated keys are rare, objects are checked once so lookups only pay for them when they are there
+	bool HasDuplicateKeys(const FNode* fields, int32 count)
+	{
+		//small objects compare every pair, bigger ones only the keys whose hashes are equal
+		if (count <= 16)
+		{
+			for (int32 i = 1; i < count; i++)
+			{
+				for (int32 j = 0; j < i; j++)
+				{
+					if (SameKey(fields[i], fields[j]))
+						return true;
+				}
+			}
+			return false;
+		}
+
+		KeyHashes.Reset(count);
+		for (int32 i = 0; i < count; i++)
+			KeyHashes.Emplace(FCrc::MemCrc32(Data.Strings.GetData() + fields[i].Key.First, fields[i].Key.Count * sizeof(TCHAR)), i);
+		KeyHashes.Sort([](const TPair<uint32, int32>& a, const TPair<uint32, int32>& b) { return a.Key < b.Key; });
+		for (int32 i = 1; i < count; i++)
+		{
+			for (int32 j = i - 1; j >= 0 && KeyHashes[j].Key == KeyHashes[i].Key; j--)
+			{
+				if (SameKey(fields[KeyHashes[i].Value], fields[KeyHashes[j].Value]))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	FJsonBPDocumentData& Data;
+	TArray<FNode> Pending;
+	TArray<FFrame, TInlineAllocator<32>> Frames;
+	FRange CurrentKey;
+	//scratch for HasDuplicateKeys
+	TArray<TPair<uint32, int32>> KeyHashes;
+};
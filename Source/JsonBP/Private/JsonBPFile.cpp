@@ -0,0 +1,156 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBP.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPDocument.h"
+#include "JsonBPReader.h"
+#include "JsonBPWriter.h"
+#include "JsonBPStream.h"
+#include "JsonBPValueBuilder.h"
+#include "JsonBPDocumentBuilder.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+
+static bool JsonBPIsUTF16(const uint8* bytes, int64 size)
+{
+	return size >= 2 && ((bytes[0] == 0xFF && bytes[1] == 0xFE) || (bytes[0] == 0xFE && bytes[1] == 0xFF));
+}
+
+/*
+reads a whole json file reporting it to the handler.
+UTF-8 files are memory mapped and read in place, if the platform can't map them (or they are 2GB or more) they are read in chunks.
+UTF-16 files, FFileHelper writes those for strings that are not ansi, are loaded into a string first.
+*/
+template<typename HandlerType> static bool JsonBPReadFile(const FString& filePath, HandlerType& handler, FString& outError)
+{
+	bool bUTF16 = false;
+
+	{
+		IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+		TUniquePtr<IMappedFileHandle> mappedFile(platformFile.OpenMapped(*filePath));
+		//empty files can't be mapped, they go the archive way and fail there as empty input
+		const int64 fileSize = mappedFile ? mappedFile->GetFileSize() : 0;
+		//destroyed before the handle
+		TUniquePtr<IMappedFileRegion> region(fileSize > 0 && fileSize <= MAX_int32 ? mappedFile->MapRegion(0, fileSize) : nullptr);
+		if (region)
+		{
+			const uint8* pBytes = region->GetMappedPtr();
+			bUTF16 = JsonBPIsUTF16(pBytes, region->GetMappedSize());
+			if (!bUTF16)
+			{
+				TJsonBPReader<ANSICHAR> reader((const ANSICHAR*)pBytes, (int32)region->GetMappedSize());
+				if (!reader.ReadDocument(handler))
+				{
+					outError = reader.GetErrorText();
+					return false;
+				}
+				return true;
+			}
+		}
+	}
+
+	if (!bUTF16)
+	{
+		TUniquePtr<FArchive> archive(IFileManager::Get().CreateFileReader(*filePath));
+		if (!archive)
+		{
+			outError = FString::Printf(TEXT("failed to open %s"), *filePath);
+			return false;
+		}
+
+		uint8 byteOrderMark[2] = { 0, 0 };
+		if (archive->TotalSize() >= 2)
+		{
+			archive->Serialize(byteOrderMark, 2);
+			archive->Seek(0);
+		}
+
+		bUTF16 = JsonBPIsUTF16(byteOrderMark, 2);
+		if (!bUTF16)
+		{
+			FJsonBPArchiveSource source(*archive);
+			TJsonBPReader<ANSICHAR> reader(source);
+			if (!reader.ReadDocument(handler))
+			{
+				outError = reader.GetErrorText();
+				return false;
+			}
+			return true;
+		}
+	}
+
+	FString text;
+	if (!FFileHelper::LoadFileToString(text, *filePath))
+	{
+		outError = FString::Printf(TEXT("failed to load %s"), *filePath);
+		return false;
+	}
+
+	TJsonBPReader<TCHAR> reader(*text, text.Len());
+	if (!reader.ReadDocument(handler))
+	{
+		outError = reader.GetErrorText();
+		return false;
+	}
+	return true;
+}
+
+UJsonValue* UJsonValue::LoadJsonFromFile(const FString& filePath)
+{
+	FJsonBPValueBuilder builder;
+	FString error;
+	if (!JsonBPReadFile(filePath, builder, error))
+	{
+		UE_LOG(LogJsonBP, Warning, TEXT("LoadJsonFromFile failed to read %s: %s"), *filePath, *error);
+		return nullptr;
+	}
+
+	return builder.GetResult();
+}
+
+bool UJsonValue::SaveJsonToFile(const FString& filePath, bool bPretty) const
+{
+	TUniquePtr<FArchive> archive(IFileManager::Get().CreateFileWriter(*filePath));
+	if (!archive)
+	{
+		UE_LOG(LogJsonBP, Warning, TEXT("SaveJsonToFile failed to open %s"), *filePath);
+		return false;
+	}
+
+	//same as ToString, a JSON_None value writes nothing
+	if (JsonType != EJsonType::JSON_None)
+	{
+		TArray<uint8> buffer;
+		FJsonBPArchiveSink sink(*archive);
+		TJsonBPWriter<uint8> writer(buffer, bPretty, sink);
+		WriteTo(writer);
+		writer.Flush();
+	}
+
+	if (!archive->Close())
+	{
+		UE_LOG(LogJsonBP, Warning, TEXT("SaveJsonToFile failed to write %s"), *filePath);
+		return false;
+	}
+
+	return true;
+}
+
+UJsonDocument* UJsonDocument::LoadDocumentFromFile(const FString& filePath)
+{
+	TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> data = MakeShared<FJsonBPDocumentData, ESPMode::ThreadSafe>();
+	const int64 fileSize = IFileManager::Get().FileSize(*filePath);
+	FJsonBPDocumentBuilder builder(*data, (int32)FMath::Clamp<int64>(fileSize, 0, MAX_int32));
+
+	FString error;
+	if (!JsonBPReadFile(filePath, builder, error))
+	{
+		UE_LOG(LogJsonBP, Warning, TEXT("LoadDocumentFromFile failed to read %s: %s"), *filePath, *error);
+		return nullptr;
+	}
+
+	return MakeDocument(data);
+}
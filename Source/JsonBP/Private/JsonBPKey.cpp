@@ -0,0 +1,192 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPKey.h"
+#include "JsonBPPrivate.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeRWLock.h"
+
+/*
+the strings live in fixed size blocks that never move, so ToString can read them without taking the lock.
+the ids are found through an open addressing table of entry indices, rebuilt under the write lock when it gets half full.
+the limits only ever get closer, so a string refused once is refused forever and Find can tell an owned key from a missing one.
+*/
+class FJsonBPKeyTable
+{
+public:
+	static FJsonBPKeyTable& Get()
+	{
+		//never destroyed, keys may be used by objects that outlive static destruction
+		static FJsonBPKeyTable* pTable = new FJsonBPKeyTable();
+		return *pTable;
+	}
+
+	int32 Find(const TCHAR* key, int32 length)
+	{
+		const uint32 hash = HashKey(key, length);
+		FRWScopeLock lock(Lock, SLT_ReadOnly);
+		return FindLocked(key, length, hash);
+	}
+
+	int32 FindOrAdd(const TCHAR* key, int32 length)
+	{
+		const uint32 hash = HashKey(key, length);
+		{
+			FRWScopeLock lock(Lock, SLT_ReadOnly);
+			const int32 id = FindLocked(key, length, hash);
+			if (id != INDEX_NONE)
+				return id;
+		}
+
+		FRWScopeLock lock(Lock, SLT_Write);
+		//another thread may have added it in between
+		int32 id = FindLocked(key, length, hash);
+		if (id != INDEX_NONE)
+			return id;
+
+		if (!CanAdd(length))
+		{
+			if (length <= MaxKeyLength && !bWarnedFull)
+			{
+				UE_LOG(LogJsonBP, Warning, TEXT("JsonBP key table is full, new object keys won't be interned"));
+				bWarnedFull = true;
+			}
+			return INDEX_NONE;
+		}
+
+		id = NumEntries;
+		const int32 block = id / BlockSize;
+		if (!Blocks[block])
+			Blocks[block] = new FEntry[BlockSize];
+
+		FEntry& entry = Blocks[block][id % BlockSize];
+		entry.String = FString(length, key);
+		entry.Hash = hash;
+		NumEntries++;
+		NumChars += length;
+
+		if (NumEntries * 2 > Slots.Num())
+			Rehash(Slots.Num() * 2);
+		else
+			Insert(id, hash);
+
+		return id;
+	}
+
+	const FString& GetString(int32 id) const
+	{
+		return Blocks[id / BlockSize][id % BlockSize].String;
+	}
+
+	int32 Num() const { return NumEntries; }
+
+	//true if the string isn't in the table and never will be, keys for it own their string
+	bool IsRefused(int32 length)
+	{
+		FRWScopeLock lock(Lock, SLT_ReadOnly);
+		return !CanAdd(length);
+	}
+
+private:
+	static const int32 BlockSize = 1024;
+	static const int32 MaxBlocks = 64;
+	//longer keys are rarely field names worth sharing
+	static const int32 MaxKeyLength = 256;
+	static const int32 MaxChars = 1024 * 1024;
+
+	struct FEntry
+	{
+		FString String;
+		uint32 Hash = 0;
+	};
+
+	FJsonBPKeyTable() : NumEntries(0), NumChars(0), bWarnedFull(false)
+	{
+		FMemory::Memzero(Blocks);
+		Slots.Init(INDEX_NONE, 1024);
+	}
+
+	static uint32 HashKey(const TCHAR* key, int32 length)
+	{
+		//case sensitive, unlike GetTypeHash(FString)
+		return FCrc::MemCrc32(key, length * sizeof(TCHAR));
+	}
+
+	bool CanAdd(int32 length) const
+	{
+		return length <= MaxKeyLength && NumEntries < BlockSize * MaxBlocks && NumChars + length <= MaxChars;
+	}
+
+	int32 FindLocked(const TCHAR* key, int32 length, uint32 hash) const
+	{
+		const int32 mask = Slots.Num() - 1;
+		for (int32 slot = hash & mask; ; slot = (slot + 1) & mask)
+		{
+			const int32 id = Slots[slot];
+			if (id == INDEX_NONE)
+				return INDEX_NONE;
+
+			const FEntry& entry = Blocks[id / BlockSize][id % BlockSize];
+			if (entry.Hash == hash && entry.String.Len() == length && FMemory::Memcmp(*entry.String, key, length * sizeof(TCHAR)) == 0)
+				return id;
+		}
+	}
+
+	void Insert(int32 id, uint32 hash)
+	{
+		const int32 mask = Slots.Num() - 1;
+		int32 slot = hash & mask;
+		while (Slots[slot] != INDEX_NONE)
+			slot = (slot + 1) & mask;
+		Slots[slot] = id;
+	}
+
+	void Rehash(int32 numSlots)
+	{
+		Slots.Init(INDEX_NONE, numSlots);
+		for (int32 id = 0; id < NumEntries; id++)
+			Insert(id, Blocks[id / BlockSize][id % BlockSize].Hash);
+	}
+
+	FRWLock Lock;
+	FEntry* Blocks[MaxBlocks];
+	int32 NumEntries;
+	int32 NumChars;
+	bool bWarnedFull;
+	TArray<int32> Slots;
+};
+
+FJsonBPKey::FJsonBPKey(const TCHAR* key, int32 length)
+	: Id(FJsonBPKeyTable::Get().FindOrAdd(key, length))
+{
+	if (Id == INDEX_NONE)
+		Owned = MakeShared<const FString, ESPMode::ThreadSafe>(length, key);
+}
+
+FJsonBPKey FJsonBPKey::Find(const TCHAR* key, int32 length)
+{
+	FJsonBPKeyTable& table = FJsonBPKeyTable::Get();
+	FJsonBPKey result;
+	result.Id = table.Find(key, length);
+	//a string the table would still take was never seen, one it refuses may be owned by some object
+	if (result.Id == INDEX_NONE && table.IsRefused(length))
+		result.Owned = MakeShared<const FString, ESPMode::ThreadSafe>(length, key);
+	return result;
+}
+
+int32 FJsonBPKey::GetNumKeys()
+{
+	return FJsonBPKeyTable::Get().Num();
+}
+
+const FString& FJsonBPKey::ToString() const
+{
+	static const FString EmptyKey;
+	if (Owned.IsValid())
+		return *Owned;
+	return Id != INDEX_NONE ? FJsonBPKeyTable::Get().GetString(Id) : EmptyKey;
+}
+
+uint32 FJsonBPKey::HashOwned() const
+{
+	return FCrc::MemCrc32(**Owned, Owned->Len() * sizeof(TCHAR));
+}
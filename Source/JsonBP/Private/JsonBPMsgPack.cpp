@@ -0,0 +1,252 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPMsgPack.h"
+#include "JsonBP.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPValueBuilder.h"
+
+
+void FJsonBPMsgPackWriter::WriteNull()
+{
+	Out.Add(0xC0);
+}
+
+void FJsonBPMsgPackWriter::WriteBoolean(bool value)
+{
+	Out.Add(value ? 0xC3 : 0xC2);
+}
+
+void FJsonBPMsgPackWriter::WriteNumber(double value)
+{
+	//always a float type, so a double that happens to be integral reads back as a double like it does from text.
+	//nan is kept as float32 nan, json can't have it anyway. out of float range (infinity included) goes to float64
+	const float single = (FMath::Abs(value) <= MAX_FLT || value != value) ? (float)value : 0.0f;
+	if ((double)single == value || value != value)
+	{
+		uint32 bits;
+		FMemory::Memcpy(&bits, &single, 4);
+		Out.Add(0xCA);
+		AppendBigEndian(bits, 4);
+	}
+	else
+	{
+		uint64 bits;
+		FMemory::Memcpy(&bits, &value, 8);
+		Out.Add(0xCB);
+		AppendBigEndian(bits, 8);
+	}
+}
+
+void FJsonBPMsgPackWriter::WriteInteger(int64 value)
+{
+	if (value >= 0)
+	{
+		if (value <= 0x7F)
+		{
+			Out.Add((uint8)value);
+		}
+		else if (value <= MAX_uint8)
+		{
+			Out.Add(0xCC);
+			AppendBigEndian(value, 1);
+		}
+		else if (value <= MAX_uint16)
+		{
+			Out.Add(0xCD);
+			AppendBigEndian(value, 2);
+		}
+		else if (value <= MAX_uint32)
+		{
+			Out.Add(0xCE);
+			AppendBigEndian(value, 4);
+		}
+		else
+		{
+			Out.Add(0xCF);
+			AppendBigEndian(value, 8);
+		}
+	}
+	else if (value >= -32)
+	{
+		Out.Add((uint8)(int8)value);
+	}
+	else if (value >= MIN_int8)
+	{
+		Out.Add(0xD0);
+		AppendBigEndian((uint64)value, 1);
+	}
+	else if (value >= MIN_int16)
+	{
+		Out.Add(0xD1);
+		AppendBigEndian((uint64)value, 2);
+	}
+	else if (value >= MIN_int32)
+	{
+		Out.Add(0xD2);
+		AppendBigEndian((uint64)value, 4);
+	}
+	else
+	{
+		Out.Add(0xD3);
+		AppendBigEndian((uint64)value, 8);
+	}
+}
+
+void FJsonBPMsgPackWriter::WriteString(const TCHAR* value, int32 length)
+{
+	//the length goes first, so the text is encoded after the largest header and moved back if a smaller one fits
+	const int32 headerStart = Out.Num();
+	const int32 textStart = Out.AddUninitialized(5 + length * JsonBPMaxUTF8BytesPerChar) + 5;
+
+	int32 numBytes = 0;
+	while (length > 0)
+	{
+		int32 numEncoded;
+		numBytes += JsonBPEncodeUTF8(value, length, Out.GetData() + textStart + numBytes, numEncoded);
+		value += numEncoded;
+		length -= numEncoded;
+
+		if (length > 0)
+		{
+			//U+FFFD, 3 bytes, never more than the space of the character it replaces
+			uint8* pDest = Out.GetData() + textStart + numBytes;
+			pDest[0] = 0xEF;
+			pDest[1] = 0xBF;
+			pDest[2] = 0xBD;
+			numBytes += 3;
+			++value;
+			--length;
+		}
+	}
+
+	Out.SetNum(headerStart, false);
+	WriteHeader(numBytes, 0xA0, 31, 0xD9, 0xDA, 0xDB);
+	const int32 headerLength = Out.Num() - headerStart;
+	FMemory::Memmove(Out.GetData() + headerStart + headerLength, Out.GetData() + textStart, numBytes);
+	Out.SetNum(headerStart + headerLength + numBytes, false);
+}
+
+void FJsonBPMsgPackWriter::BeginArray(int32 count)
+{
+	//no array8 in MessagePack
+	WriteHeader(count, 0x90, 15, 0, 0xDC, 0xDD);
+}
+
+void FJsonBPMsgPackWriter::BeginObject(int32 count)
+{
+	WriteHeader(count, 0x80, 15, 0, 0xDE, 0xDF);
+}
+
+void FJsonBPMsgPackWriter::WriteHeader(uint32 count, uint8 fixCode, uint32 fixLimit, uint8 code8, uint8 code16, uint8 code32)
+{
+	if (count <= fixLimit)
+	{
+		Out.Add((uint8)(fixCode | count));
+	}
+	else if (code8 && count <= MAX_uint8)
+	{
+		Out.Add(code8);
+		AppendBigEndian(count, 1);
+	}
+	else if (count <= MAX_uint16)
+	{
+		Out.Add(code16);
+		AppendBigEndian(count, 2);
+	}
+	else
+	{
+		Out.Add(code32);
+		AppendBigEndian(count, 4);
+	}
+}
+
+void FJsonBPMsgPackWriter::AppendBigEndian(uint64 value, int32 numBytes)
+{
+	const int32 start = Out.AddUninitialized(numBytes);
+	uint8* pDest = Out.GetData() + start;
+	for (int32 i = numBytes - 1; i >= 0; i--)
+	{
+		pDest[i] = (uint8)value;
+		value >>= 8;
+	}
+}
+
+
+
+void UJsonValue::ToMsgPack(TArray<uint8>& bytes) const
+{
+	bytes.Reset();
+	//same as ToString, a JSON_None value writes nothing
+	if (JsonType == EJsonType::JSON_None)
+		return;
+
+	//binary is usually a good deal smaller than the text
+	bytes.Reserve(EstimateTextLength(false) / 2);
+	FJsonBPMsgPackWriter writer(bytes);
+	WriteTo(writer);
+}
+
+void UJsonValue::WriteTo(FJsonBPMsgPackWriter& writer) const
+{
+	if (Packed)
+	{
+		writer.BeginArray(Packed->Num());
+		Packed->WriteElements(writer);
+		return;
+	}
+
+	Expand();
+	switch (JsonType)
+	{
+	case EJsonType::JSON_None:
+	case EJsonType::JSON_Null:
+		writer.WriteNull();
+		break;
+	case EJsonType::JSON_String:
+		writer.WriteString(ValueString);
+		break;
+	case EJsonType::JSON_Number:
+		if (bIntegerNumber)
+			writer.WriteInteger(ValueInteger);
+		else
+			writer.WriteNumber(ValueNumber);
+		break;
+	case EJsonType::JSON_Boolean:
+		writer.WriteBoolean(ValueBool);
+		break;
+	case EJsonType::JSON_Array:
+		writer.BeginArray(ValueArray.Num());
+		for (const UJsonValue* pElement : ValueArray)
+		{
+			if (pElement)
+				pElement->WriteTo(writer);
+			else
+				writer.WriteNull();
+		}
+		break;
+	case EJsonType::JSON_Object:
+		writer.BeginObject(ValueObject.Num());
+		for (const auto& pair : ValueObject)
+		{
+			writer.WriteKey(pair.Key.ToString());
+			if (pair.Value)
+				pair.Value->WriteTo(writer);
+			else
+				writer.WriteNull();
+		}
+		break;
+	}
+}
+
+UJsonValue* UJsonValue::MakeFromMsgPack(const TArray<uint8>& bytes)
+{
+	FJsonBPMsgPackReader reader(bytes.GetData(), bytes.Num());
+	FJsonBPValueBuilder builder;
+	if (!reader.ReadDocument(builder))
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("MakeFromMsgPack failed: %s"), *reader.GetErrorText());
+		return nullptr;
+	}
+
+	return builder.GetResult();
+}
@@ -0,0 +1,111 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPObjectMap.h"
+
+
+void FJsonBPObjectMap::Reserve(int32 number)
+{
+	Entries.Reserve(number);
+}
+
+void FJsonBPObjectMap::Reset()
+{
+	Entries.Reset();
+	Buckets.Reset();
+}
+
+void FJsonBPObjectMap::Empty()
+{
+	Entries.Empty();
+	Buckets.Empty();
+}
+
+int32 FJsonBPObjectMap::IndexOf(FJsonBPKey key) const
+{
+	if (!key.IsValid())
+		return INDEX_NONE;
+
+	if (Buckets.Num() == 0)
+	{
+		//keys are interned, comparing them is comparing two integers (unless the key table was full)
+		for (int32 i = 0; i < Entries.Num(); i++)
+		{
+			if (Entries[i].Key == key)
+				return i;
+		}
+		return INDEX_NONE;
+	}
+
+	const uint32 mask = Buckets.Num() - 1;
+	for (uint32 bucket = HashKey(key) & mask; ; bucket = (bucket + 1) & mask)
+	{
+		const int32 entry = Buckets[bucket];
+		if (entry == INDEX_NONE || Entries[entry].Key == key)
+			return entry;
+	}
+}
+
+UJsonValue*& FJsonBPObjectMap::Add(FJsonBPKey key, UJsonValue* value)
+{
+	UJsonValue*& slot = FindOrAdd(key);
+	slot = value;
+	return slot;
+}
+
+UJsonValue*& FJsonBPObjectMap::FindOrAdd(FJsonBPKey key)
+{
+	const int32 index = IndexOf(key);
+	if (index != INDEX_NONE)
+		return Entries[index].Value;
+
+	const int32 entry = Entries.Emplace(key, nullptr);
+	if (Buckets.Num() > 0 && Entries.Num() * 2 <= Buckets.Num())
+		AddToIndex(entry);
+	else if (Entries.Num() > IndexThreshold)
+		RebuildIndex();
+
+	return Entries[entry].Value;
+}
+
+int32 FJsonBPObjectMap::Remove(FJsonBPKey key)
+{
+	UJsonValue* pRemoved;
+	return RemoveAndCopyValue(key, pRemoved) ? 1 : 0;
+}
+
+bool FJsonBPObjectMap::RemoveAndCopyValue(FJsonBPKey key, UJsonValue*& outValue)
+{
+	const int32 index = IndexOf(key);
+	if (index == INDEX_NONE)
+		return false;
+
+	outValue = Entries[index].Value;
+	//the fields after it move down, removing is rare enough that the index is just built again
+	Entries.RemoveAt(index, 1, false);
+	if (Buckets.Num() > 0)
+		RebuildIndex();
+	return true;
+}
+
+void FJsonBPObjectMap::RebuildIndex()
+{
+	if (Entries.Num() <= IndexThreshold)
+	{
+		Buckets.Empty();
+		return;
+	}
+
+	const int32 numBuckets = FMath::RoundUpToPowerOfTwo(Entries.Num() * 2);
+	Buckets.Init(INDEX_NONE, numBuckets);
+	for (int32 i = 0; i < Entries.Num(); i++)
+		AddToIndex(i);
+}
+
+void FJsonBPObjectMap::AddToIndex(int32 entry)
+{
+	const uint32 mask = Buckets.Num() - 1;
+	uint32 bucket = HashKey(Entries[entry].Key) & mask;
+	while (Buckets[bucket] != INDEX_NONE)
+		bucket = (bucket + 1) & mask;
+	Buckets[bucket] = entry;
+}
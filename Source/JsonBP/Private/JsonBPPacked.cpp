@@ -0,0 +1,301 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBP.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPPacked.h"
+#include "Misc/ScopeRWLock.h"
+
+/*
+the packed values alive, so Find can tell them from other arrays without rtti or GetType (which makes an FString).
+the count lets the usual case, no packed value alive, skip the lock
+*/
+struct FJsonBPPackedRegistry
+{
+	static FJsonBPPackedRegistry& Get()
+	{
+		//never destroyed, packed values may be released during static destruction
+		static FJsonBPPackedRegistry* pRegistry = new FJsonBPPackedRegistry();
+		return *pRegistry;
+	}
+
+	FRWLock Lock;
+	TSet<const FJsonValue*> Values;
+	FThreadSafeCounter Num;
+};
+
+FJsonBPValuePacked::FJsonBPValuePacked(FJsonBPPackedElements&& elements) : Elements(MoveTemp(elements))
+{
+	Type = EJson::Array;
+	FJsonBPPackedRegistry& registry = FJsonBPPackedRegistry::Get();
+	FRWScopeLock lock(registry.Lock, SLT_Write);
+	registry.Values.Add(this);
+	registry.Num.Increment();
+}
+
+FJsonBPValuePacked::~FJsonBPValuePacked()
+{
+	FJsonBPPackedRegistry& registry = FJsonBPPackedRegistry::Get();
+	FRWScopeLock lock(registry.Lock, SLT_Write);
+	registry.Values.Remove(this);
+	registry.Num.Decrement();
+}
+
+const FJsonBPValuePacked* FJsonBPValuePacked::Find(const TSharedPtr<FJsonValue>& value)
+{
+	FJsonBPPackedRegistry& registry = FJsonBPPackedRegistry::Get();
+	if (!value.IsValid() || value->Type != EJson::Array || registry.Num.GetValue() == 0)
+		return nullptr;
+
+	FRWScopeLock lock(registry.Lock, SLT_ReadOnly);
+	return registry.Values.Contains(value.Get()) ? static_cast<const FJsonBPValuePacked*>(value.Get()) : nullptr;
+}
+
+const TArray<TSharedPtr<FJsonValue>>& FJsonBPValuePacked::AsArray() const
+{
+	if (!bHasElementValues)
+	{
+		ElementValues.Reserve(Elements.Num());
+		if (Elements.bStrings)
+		{
+			for (const FString& element : Elements.Strings)
+				ElementValues.Add(MakeShared<FJsonValueString>(element));
+		}
+		else
+		{
+			for (double element : Elements.Numbers)
+				ElementValues.Add(MakeShared<FJsonValueNumber>(element));
+		}
+		bHasElementValues = true;
+	}
+	return ElementValues;
+}
+
+bool FJsonBPValuePacked::TryGetArray(const TArray<TSharedPtr<FJsonValue>>*& OutArray) const
+{
+	OutArray = &AsArray();
+	return true;
+}
+
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<float>& array)
+{
+	FJsonBPPackedElements elements;
+	elements.Numbers.SetNumUninitialized(array.Num());
+	for (int32 i = 0; i < array.Num(); i++)
+		elements.Numbers[i] = JsonBPFloatToDouble(array[i]);
+	return MakeShared<FJsonBPValuePacked>(MoveTemp(elements));
+}
+
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<double>& array)
+{
+	FJsonBPPackedElements elements;
+	elements.Numbers = array;
+	return MakeShared<FJsonBPValuePacked>(MoveTemp(elements));
+}
+
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<int>& array)
+{
+	FJsonBPPackedElements elements;
+	elements.bIntegers = true;
+	elements.Numbers.SetNumUninitialized(array.Num());
+	for (int32 i = 0; i < array.Num(); i++)
+		elements.Numbers[i] = array[i];
+	return MakeShared<FJsonBPValuePacked>(MoveTemp(elements));
+}
+
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<uint32>& array)
+{
+	FJsonBPPackedElements elements;
+	elements.bIntegers = true;
+	elements.Numbers.SetNumUninitialized(array.Num());
+	for (int32 i = 0; i < array.Num(); i++)
+		elements.Numbers[i] = array[i];
+	return MakeShared<FJsonBPValuePacked>(MoveTemp(elements));
+}
+
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<FString>& array)
+{
+	FJsonBPPackedElements elements;
+	elements.bStrings = true;
+	elements.Strings = array;
+	return MakeShared<FJsonBPValuePacked>(MoveTemp(elements));
+}
+
+
+
+void UJsonValue::ExpandPacked() const
+{
+	//logically const like a lazy container, the elements were there all along
+	UJsonValue* pThis = const_cast<UJsonValue*>(this);
+	const TUniquePtr<FJsonBPPackedElements> elements = MoveTemp(pThis->Packed);
+
+	pThis->ValueArray.Reserve(elements->Num());
+	if (elements->bStrings)
+	{
+		for (const FString& element : elements->Strings)
+			pThis->ValueArray.Add(MakeString(element));
+	}
+	else
+	{
+		for (double element : elements->Numbers)
+			pThis->ValueArray.Add(elements->bIntegers ? MakeInteger((int64)element) : MakeDouble(element));
+	}
+
+	for (UJsonValue* pElement : ValueArray)
+		pElement->bShared = bShared;
+	pThis->AttachChildrenToTextCache();
+}
+
+void UJsonValue::SetValuePacked(FJsonBPPackedElements&& elements)
+{
+	if (!CanModify())
+		return;
+
+	Clear();
+	JsonType = EJsonType::JSON_Array;
+	Packed = MakeUnique<FJsonBPPackedElements>(MoveTemp(elements));
+}
+
+const TArray<double>* UJsonValue::GetNumberElements(TArray<double>& scratch) const
+{
+	if (JsonType != EJsonType::JSON_Array)
+		return nullptr;
+	if (Packed)
+		return Packed->bStrings ? nullptr : &Packed->Numbers;
+
+	Expand();
+	scratch.Reset(ValueArray.Num());
+	for (const UJsonValue* pElement : ValueArray)
+	{
+		if (!pElement || pElement->JsonType != EJsonType::JSON_Number)
+			return nullptr;
+		scratch.Add(pElement->ValueNumber);
+	}
+	return &scratch;
+}
+
+bool UJsonValue::GetValueAsNumberArray(TArray<float>& values) const
+{
+	TArray<double> scratch;
+	const TArray<double>* pNumbers = GetNumberElements(scratch);
+	if (!pNumbers)
+		return false;
+
+	values.SetNumUninitialized(pNumbers->Num());
+	for (int32 i = 0; i < pNumbers->Num(); i++)
+		values[i] = (float)(*pNumbers)[i];
+	return true;
+}
+
+bool UJsonValue::GetValueAsIntegerArray(TArray<int32>& values) const
+{
+	TArray<double> scratch;
+	const TArray<double>* pNumbers = GetNumberElements(scratch);
+	if (!pNumbers)
+		return false;
+
+	values.SetNumUninitialized(pNumbers->Num());
+	for (int32 i = 0; i < pNumbers->Num(); i++)
+		values[i] = (int32)FMath::Clamp<int64>(JsonBPDoubleToInt64((*pNumbers)[i]), MIN_int32, MAX_int32);
+	return true;
+}
+
+bool UJsonValue::GetValueAsDoubleArray(TArray<double>& values) const
+{
+	TArray<double> scratch;
+	const TArray<double>* pNumbers = GetNumberElements(scratch);
+	if (!pNumbers)
+		return false;
+
+	if (pNumbers == &scratch)
+		values = MoveTemp(scratch);
+	else
+		values = *pNumbers;
+	return true;
+}
+
+bool UJsonValue::GetValueAsStringArray(TArray<FString>& values) const
+{
+	if (JsonType != EJsonType::JSON_Array)
+		return false;
+	if (Packed)
+	{
+		if (!Packed->bStrings)
+			return false;
+		values = Packed->Strings;
+		return true;
+	}
+
+	Expand();
+	TArray<FString> strings;
+	strings.Reserve(ValueArray.Num());
+	for (const UJsonValue* pElement : ValueArray)
+	{
+		if (!pElement || pElement->JsonType != EJsonType::JSON_String)
+			return false;
+		strings.Add(pElement->ValueString);
+	}
+	values = MoveTemp(strings);
+	return true;
+}
+
+UJsonValue* UJsonValue::MakeNumberArray(const TArray<float>& values)
+{
+	UJsonValue* pArray = MakeJsonValue();
+	pArray->SetValueNumberArray(values);
+	return pArray;
+}
+
+UJsonValue* UJsonValue::MakeIntegerArray(const TArray<int32>& values)
+{
+	UJsonValue* pArray = MakeJsonValue();
+	pArray->SetValueIntegerArray(values);
+	return pArray;
+}
+
+UJsonValue* UJsonValue::MakeDoubleArray(TArray<double> values)
+{
+	UJsonValue* pArray = MakeJsonValue();
+	pArray->SetValueDoubleArray(MoveTemp(values));
+	return pArray;
+}
+
+UJsonValue* UJsonValue::MakeStringArray(const TArray<FString>& values)
+{
+	UJsonValue* pArray = MakeJsonValue();
+	pArray->SetValueStringArray(values);
+	return pArray;
+}
+
+void UJsonValue::SetValueNumberArray(const TArray<float>& values)
+{
+	FJsonBPPackedElements elements;
+	elements.Numbers.SetNumUninitialized(values.Num());
+	for (int32 i = 0; i < values.Num(); i++)
+		elements.Numbers[i] = JsonBPFloatToDouble(values[i]);
+	SetValuePacked(MoveTemp(elements));
+}
+
+void UJsonValue::SetValueIntegerArray(const TArray<int32>& values)
+{
+	FJsonBPPackedElements elements;
+	elements.bIntegers = true;
+	elements.Numbers.SetNumUninitialized(values.Num());
+	for (int32 i = 0; i < values.Num(); i++)
+		elements.Numbers[i] = values[i];
+	SetValuePacked(MoveTemp(elements));
+}
+
+void UJsonValue::SetValueDoubleArray(TArray<double> values)
+{
+	FJsonBPPackedElements elements;
+	elements.Numbers = MoveTemp(values);
+	SetValuePacked(MoveTemp(elements));
+}
+
+void UJsonValue::SetValueStringArray(const TArray<FString>& values)
+{
+	FJsonBPPackedElements elements;
+	elements.bStrings = true;
+	elements.Strings = values;
+	SetValuePacked(MoveTemp(elements));
+}
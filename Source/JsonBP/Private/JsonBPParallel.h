@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//one element of an array or one field of an object, offsets into the text
+struct FJsonBPItemBounds
+{
+	int32 Start;
+	//the ':' of an object field, INDEX_NONE for array elements
+	int32 Colon;
+	//one past the last character, the ',' or the closing bracket
+	int32 End;
+};
+
+/*
+finds the items of the top level array or object without parsing them, only strings and brackets are tracked.
+the items are not validated, each one is read on its own afterwards. returns false if the text is not a single array/object
+(or is empty), the serial reader then handles it and reports the error.
+*/
+template<typename CharType> bool JsonBPSplitTopLevel(const CharType* text, int32 length, bool& bOutObject, TArray<FJsonBPItemBounds>& outItems)
+{
+	outItems.Reset();
+
+	auto isWhitespace = [](CharType c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; };
+
+	int32 i = 0;
+	//the byte order mark the reader skips
+	if (sizeof(CharType) == 1 && length >= 3 && (uint8)text[0] == 0xEF && (uint8)text[1] == 0xBB && (uint8)text[2] == 0xBF)
+		i = 3;
+	else if (sizeof(CharType) != 1 && length >= 1 && (uint32)text[0] == 0xFEFF)
+		i = 1;
+
+	while (i < length && isWhitespace(text[i]))
+		i++;
+	if (i == length || (text[i] != '[' && text[i] != '{'))
+		return false;
+
+	bOutObject = text[i] == '{';
+	const CharType closing = bOutObject ? '}' : ']';
+
+	int32 depth = 1;
+	bool bInString = false;
+	FJsonBPItemBounds item = { i + 1, INDEX_NONE, INDEX_NONE };
+	for (i++; i < length; i++)
+	{
+		const CharType c = text[i];
+		if (bInString)
+		{
+			if (c == '\\')
+				i++;
+			else if (c == '"')
+				bInString = false;
+			continue;
+		}
+
+		switch (c)
+		{
+		case '"':
+			bInString = true;
+			break;
+		case '[':
+		case '{':
+			depth++;
+			break;
+		case ']':
+		case '}':
+			if (--depth > 0)
+				break;
+			if (c != closing)
+				return false;
+
+			item.End = i;
+			outItems.Add(item);
+			for (i++; i < length; i++)
+			{
+				if (!isWhitespace(text[i]))
+					return false;
+			}
+			//a trailing ',' leaves an empty item, reading it fails like it does in the serial reader
+			return true;
+		case ',':
+			if (depth == 1)
+			{
+				item.End = i;
+				outItems.Add(item);
+				item = { i + 1, INDEX_NONE, INDEX_NONE };
+			}
+			break;
+		case ':':
+			if (depth == 1 && item.Colon == INDEX_NONE)
+				item.Colon = i;
+			break;
+		}
+	}
+
+	//never closed
+	return false;
+}
+
+//number of pieces to split numItems items into for ParallelFor, 1 if its not worth it
+int32 JsonBPGetParallelChunks(int32 numItems);
+//true if text of this length may be parsed in parallel
+bool JsonBPShouldParseParallel(int32 length);
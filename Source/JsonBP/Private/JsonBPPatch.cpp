@@ -0,0 +1,450 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPPatch.h"
+#include "JsonBPPrivate.h"
+
+
+//nullptr and JSON_None are treated as json null, the same way ToString writes them
+static bool JsonBPIsNull(const UJsonValue* value)
+{
+	return !value || value->GetType() == EJsonType::JSON_Null || value->GetType() == EJsonType::JSON_None;
+}
+
+static bool JsonBPParsePatchPointer(const FString& pointer, TArray<FJsonBPPathSegment>& outSegments)
+{
+	if (!UJsonPath::ParsePointer(pointer, outSegments))
+		return false;
+
+	for (FJsonBPPathSegment& segment : outSegments)
+		segment.InternedKey = FJsonBPKey(segment.Key);
+	return true;
+}
+
+//the value at the first numSegments segments of path, null if it doesn't exist.
+//shared values on the way are replaced with copies like GetFieldValue does, so the result can be changed
+static UJsonValue* JsonBPResolve(UJsonValue* root, const TArray<FJsonBPPathSegment>& path, int32 numSegments)
+{
+	UJsonValue* pValue = root;
+	for (int32 i = 0; i < numSegments && pValue; i++)
+	{
+		const FJsonBPPathSegment& segment = path[i];
+		if (pValue->GetType() == EJsonType::JSON_Object)
+			pValue = pValue->GetFieldValue(segment.InternedKey);
+		else if (pValue->GetType() == EJsonType::JSON_Array && segment.Index != INDEX_NONE)
+			pValue = pValue->GetArrayElement(segment.Index);
+		else
+			pValue = nullptr;
+	}
+	return pValue;
+}
+
+
+
+bool UJsonPatchLibrary::JsonEquals(const UJsonValue* a, const UJsonValue* b)
+{
+	if (a == b)
+		return true;
+
+	const bool bNullA = JsonBPIsNull(a);
+	const bool bNullB = JsonBPIsNull(b);
+	if (bNullA || bNullB)
+		return bNullA && bNullB;
+
+	if (a->JsonType != b->JsonType)
+		return false;
+
+	a->Expand();
+	b->Expand();
+	switch (a->JsonType)
+	{
+	case EJsonType::JSON_String:
+		return a->ValueString.Equals(b->ValueString, ESearchCase::CaseSensitive);
+	case EJsonType::JSON_Boolean:
+		return a->ValueBool == b->ValueBool;
+	case EJsonType::JSON_Number:
+		if (a->bIntegerNumber && b->bIntegerNumber)
+			return a->ValueInteger == b->ValueInteger;
+		return (a->bIntegerNumber ? (double)a->ValueInteger : a->ValueNumber) == (b->bIntegerNumber ? (double)b->ValueInteger : b->ValueNumber);
+	case EJsonType::JSON_Array:
+		if (a->ValueArray.Num() != b->ValueArray.Num())
+			return false;
+		for (int32 i = 0; i < a->ValueArray.Num(); i++)
+		{
+			if (!JsonEquals(a->ValueArray[i], b->ValueArray[i]))
+				return false;
+		}
+		return true;
+	case EJsonType::JSON_Object:
+		if (a->ValueObject.Num() != b->ValueObject.Num())
+			return false;
+		for (const auto& pair : a->ValueObject)
+		{
+			UJsonValue* const* ppOther = b->ValueObject.Find(pair.Key);
+			if (!ppOther || !JsonEquals(pair.Value, *ppOther))
+				return false;
+		}
+		return true;
+	default:
+		return true;
+	}
+}
+
+UJsonValue* UJsonPatchLibrary::CloneValue(const UJsonValue* value)
+{
+	return value ? value->DeepCopy() : nullptr;
+}
+
+void UJsonPatchLibrary::AssignValue(UJsonValue* target, UJsonValue* source)
+{
+	//source is a fresh copy, its children are taken instead of copied again
+	if (!source)
+		target->SetValueNull();
+	else
+		//a moved value can still be shared with other copies, those keep theirs
+		target->MoveFrom(source->bShared ? source->ShallowCopy() : source);
+}
+
+
+
+UJsonValue* UJsonPatchLibrary::MakeOperation(const TCHAR* op, const FString& path, const UJsonValue* value)
+{
+	FJsonBPObjectMap fields;
+	fields.Reserve(3);
+	static const FJsonBPKey KeyOp(TEXT("op"), 2);
+	static const FJsonBPKey KeyPath(TEXT("path"), 4);
+	static const FJsonBPKey KeyValue(TEXT("value"), 5);
+	fields.Add(KeyOp, UJsonValue::MakeString(op));
+	fields.Add(KeyPath, UJsonValue::MakeString(path));
+	if (value)
+		fields.Add(KeyValue, const_cast<UJsonValue*>(value));
+	return UJsonValue::MakeObject(MoveTemp(fields));
+}
+
+void UJsonPatchLibrary::DiffValues(const UJsonValue* a, const UJsonValue* b, const FString& path, TArray<UJsonValue*>& operations)
+{
+	if (JsonBPIsNull(a) || JsonBPIsNull(b) || a->JsonType != b->JsonType
+		|| (a->JsonType != EJsonType::JSON_Array && a->JsonType != EJsonType::JSON_Object))
+	{
+		if (!JsonEquals(a, b))
+			operations.Add(MakeOperation(TEXT("replace"), path, b ? b : UJsonValue::MakeNull()));
+		return;
+	}
+
+	a->Expand();
+	b->Expand();
+	if (a->JsonType == EJsonType::JSON_Object)
+	{
+		for (const auto& pair : a->ValueObject)
+		{
+			if (!b->ValueObject.Contains(pair.Key))
+				operations.Add(MakeOperation(TEXT("remove"), path + TEXT("/") + JsonBPEscapePointerToken(pair.Key.ToString()), nullptr));
+		}
+
+		for (const auto& pair : b->ValueObject)
+		{
+			const FString childPath = path + TEXT("/") + JsonBPEscapePointerToken(pair.Key.ToString());
+			UJsonValue* const* ppOld = a->ValueObject.Find(pair.Key);
+			if (ppOld)
+				DiffValues(*ppOld, pair.Value, childPath, operations);
+			else
+				operations.Add(MakeOperation(TEXT("add"), childPath, pair.Value ? pair.Value : UJsonValue::MakeNull()));
+		}
+		return;
+	}
+
+	//arrays are compared by position, no attempt is made to detect moved elements
+	const int32 numA = a->ValueArray.Num();
+	const int32 numB = b->ValueArray.Num();
+	const int32 numCommon = FMath::Min(numA, numB);
+	for (int32 i = 0; i < numCommon; i++)
+		DiffValues(a->ValueArray[i], b->ValueArray[i], path + TEXT("/") + FString::FromInt(i), operations);
+
+	for (int32 i = numCommon; i < numB; i++)
+	{
+		UJsonValue* pElement = b->ValueArray[i];
+		operations.Add(MakeOperation(TEXT("add"), path + TEXT("/") + FString::FromInt(i), pElement ? pElement : UJsonValue::MakeNull()));
+	}
+
+	//from the end, so the indices of the remaining ones don't shift
+	for (int32 i = numA - 1; i >= numCommon; i--)
+		operations.Add(MakeOperation(TEXT("remove"), path + TEXT("/") + FString::FromInt(i), nullptr));
+}
+
+UJsonValue* UJsonPatchLibrary::Diff(const UJsonValue* a, const UJsonValue* b)
+{
+	TArray<UJsonValue*> operations;
+	DiffValues(a, b, FString(), operations);
+	return UJsonValue::MakeArray(MoveTemp(operations));
+}
+
+
+
+bool UJsonPatchLibrary::AddValue(UJsonValue* target, const TArray<FJsonBPPathSegment>& path, UJsonValue* value, FString& outError)
+{
+	if (path.Num() == 0)
+	{
+		AssignValue(target, value);
+		return true;
+	}
+
+	UJsonValue* pParent = JsonBPResolve(target, path, path.Num() - 1);
+	const FJsonBPPathSegment& last = path.Last();
+	if (pParent)
+		pParent->Expand();
+	if (pParent && pParent->JsonType == EJsonType::JSON_Object)
+	{
+		//add on an existing key replaces its value
+		pParent->DetachFromTextCache(pParent->ValueObject.FindRef(last.InternedKey));
+		pParent->ValueObject.Add(last.InternedKey, value);
+		pParent->AttachToTextCache(value);
+		return true;
+	}
+
+	if (pParent && pParent->JsonType == EJsonType::JSON_Array)
+	{
+		//"-" is the end of the array
+		if (last.Key == TEXT("-"))
+		{
+			pParent->ValueArray.Add(value);
+			pParent->AttachToTextCache(value);
+			return true;
+		}
+		if (pParent->InsertArrayElement(last.Index, value))
+			return true;
+
+		outError = FString::Printf(TEXT("index %s out of range"), *last.Key);
+		return false;
+	}
+
+	outError = TEXT("parent is not an object or array");
+	return false;
+}
+
+UJsonValue* UJsonPatchLibrary::RemoveValue(UJsonValue* target, const TArray<FJsonBPPathSegment>& path, FString& outError)
+{
+	if (path.Num() == 0)
+	{
+		outError = TEXT("can't remove the root");
+		return nullptr;
+	}
+
+	UJsonValue* pParent = JsonBPResolve(target, path, path.Num() - 1);
+	const FJsonBPPathSegment& last = path.Last();
+	if (pParent)
+		pParent->Expand();
+	UJsonValue* pRemoved = nullptr;
+	if (pParent && pParent->JsonType == EJsonType::JSON_Object && pParent->ValueObject.RemoveAndCopyValue(last.InternedKey, pRemoved))
+	{
+		pParent->DetachFromTextCache(pRemoved);
+		return pRemoved ? pRemoved : UJsonValue::MakeNull();
+	}
+
+	if (pParent && pParent->JsonType == EJsonType::JSON_Array && pParent->ValueArray.IsValidIndex(last.Index))
+	{
+		pRemoved = pParent->ValueArray[last.Index];
+		pParent->ValueArray.RemoveAt(last.Index);
+		pParent->DetachFromTextCache(pRemoved);
+		return pRemoved ? pRemoved : UJsonValue::MakeNull();
+	}
+
+	outError = TEXT("path doesn't exist");
+	return nullptr;
+}
+
+bool UJsonPatchLibrary::ApplyOperation(UJsonValue* target, const UJsonValue* operation, FString& outError)
+{
+	FString op, pointer;
+	TArray<FJsonBPPathSegment> path;
+	if (!operation || !operation->GetFieldValueString(TEXT("op"), op) || !operation->GetFieldValueString(TEXT("path"), pointer))
+	{
+		outError = TEXT("operation needs op and path");
+		return false;
+	}
+	if (!JsonBPParsePatchPointer(pointer, path))
+	{
+		outError = FString::Printf(TEXT("invalid path %s"), *pointer);
+		return false;
+	}
+
+	const bool bNeedsValue = op == TEXT("add") || op == TEXT("replace") || op == TEXT("test");
+	const bool bNeedsFrom = op == TEXT("move") || op == TEXT("copy");
+	static const FJsonBPKey KeyValue(TEXT("value"), 5);
+	operation->Expand();
+	UJsonValue* const* ppValue = operation->ValueObject.Find(KeyValue);
+	if (bNeedsValue && !ppValue)
+	{
+		outError = FString::Printf(TEXT("%s needs a value"), *op);
+		return false;
+	}
+
+	TArray<FJsonBPPathSegment> from;
+	FString fromPointer;
+	if (bNeedsFrom && (!operation->GetFieldValueString(TEXT("from"), fromPointer) || !JsonBPParsePatchPointer(fromPointer, from)))
+	{
+		outError = FString::Printf(TEXT("%s needs a valid from"), *op);
+		return false;
+	}
+
+	if (op == TEXT("add"))
+	{
+		UJsonValue* pValue = CloneValue(*ppValue);
+		return AddValue(target, path, pValue ? pValue : UJsonValue::MakeNull(), outError);
+	}
+
+	if (op == TEXT("remove"))
+		return RemoveValue(target, path, outError) != nullptr;
+
+	if (op == TEXT("replace"))
+	{
+		if (!JsonBPResolve(target, path, path.Num()))
+		{
+			outError = TEXT("path doesn't exist");
+			return false;
+		}
+		if (path.Num() == 0)
+		{
+			AssignValue(target, CloneValue(*ppValue));
+			return true;
+		}
+
+		UJsonValue* pValue = CloneValue(*ppValue);
+		if (!pValue)
+			pValue = UJsonValue::MakeNull();
+		//a field is replaced where it is, so the field order (and the text) stays the same
+		const UJsonValue* pParent = JsonBPResolve(target, path, path.Num() - 1);
+		if (pParent && pParent->JsonType == EJsonType::JSON_Object)
+			return AddValue(target, path, pValue, outError);
+		return RemoveValue(target, path, outError) && AddValue(target, path, pValue, outError);
+	}
+
+	if (op == TEXT("move"))
+	{
+		if (!JsonBPResolve(target, from, from.Num()))
+		{
+			outError = TEXT("from doesn't exist");
+			return false;
+		}
+		if (pointer == fromPointer)
+			return true;
+
+		//a value can't be moved into one of its own children
+		if (pointer.StartsWith(fromPointer + TEXT("/"), ESearchCase::CaseSensitive))
+		{
+			outError = TEXT("can't move a value into its own child");
+			return false;
+		}
+
+		UJsonValue* pValue = RemoveValue(target, from, outError);
+		return pValue && AddValue(target, path, pValue, outError);
+	}
+
+	if (op == TEXT("copy"))
+	{
+		UJsonValue* pSource = JsonBPResolve(target, from, from.Num());
+		if (!pSource)
+		{
+			outError = TEXT("from doesn't exist");
+			return false;
+		}
+		return AddValue(target, path, CloneValue(pSource), outError);
+	}
+
+	if (op == TEXT("test"))
+	{
+		UJsonValue* pCurrent = JsonBPResolve(target, path, path.Num());
+		if (pCurrent && JsonEquals(pCurrent, *ppValue))
+			return true;
+
+		outError = FString::Printf(TEXT("test failed at %s"), *pointer);
+		return false;
+	}
+
+	outError = FString::Printf(TEXT("unknown op %s"), *op);
+	return false;
+}
+
+bool UJsonPatchLibrary::ApplyPatch(UJsonValue* target, const UJsonValue* patch, FString& outError)
+{
+	outError.Reset();
+	if (!target || !patch || patch->JsonType != EJsonType::JSON_Array)
+	{
+		outError = TEXT("patch must be an array");
+		return false;
+	}
+	if (!target->CanModify())
+	{
+		outError = TEXT("target is shared");
+		return false;
+	}
+
+	patch->Expand();
+	for (int32 i = 0; i < patch->ValueArray.Num(); i++)
+	{
+		FString error;
+		if (!ApplyOperation(target, patch->ValueArray[i], error))
+		{
+			outError = FString::Printf(TEXT("operation %d: %s"), i, *error);
+			UE_LOG(LogJsonBP, Verbose, TEXT("ApplyPatch failed: %s"), *outError);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+void UJsonPatchLibrary::MergeValue(UJsonValue* target, const UJsonValue* patch)
+{
+	if (!patch || patch->JsonType != EJsonType::JSON_Object)
+	{
+		AssignValue(target, CloneValue(patch));
+		return;
+	}
+
+	if (target->JsonType != EJsonType::JSON_Object)
+		target->SetValueObject(FJsonBPObjectMap());
+
+	target->Expand();
+	patch->Expand();
+	//the nested merges report their own changes, this covers the fields removed and replaced here
+	target->InvalidateText();
+	for (const auto& pair : patch->ValueObject)
+	{
+		if (JsonBPIsNull(pair.Value))
+		{
+			UJsonValue* pRemoved = nullptr;
+			if (target->ValueObject.RemoveAndCopyValue(pair.Key, pRemoved))
+				target->DetachFromTextCache(pRemoved);
+			continue;
+		}
+
+		//objects merge into what is there, so nulls inside them remove fields instead of being copied
+		UJsonValue*& pField = target->ValueObject.FindOrAdd(pair.Key);
+		if (pair.Value->JsonType == EJsonType::JSON_Object)
+		{
+			if (!pField)
+			{
+				pField = MakeJsonValue();
+				target->AttachToTextCache(pField);
+			}
+			target->UnshareChild(pField);
+			MergeValue(pField, pair.Value);
+		}
+		else
+		{
+			target->DetachFromTextCache(pField);
+			pField = CloneValue(pair.Value);
+			target->AttachToTextCache(pField);
+		}
+	}
+}
+
+bool UJsonPatchLibrary::ApplyMergePatch(UJsonValue* target, const UJsonValue* patch)
+{
+	if (!target || !patch || !target->CanModify())
+		return false;
+
+	MergeValue(target, patch);
+	return true;
+}
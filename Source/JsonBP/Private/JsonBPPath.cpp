@@ -0,0 +1,331 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPPath.h"
+#include "JsonBPPrivate.h"
+
+//GetCachedPath stops caching after this many different paths, they are still compiled but not kept
+static const int32 JsonBPMaxCachedPaths = 1024;
+
+static TMap<FString, UJsonPath*>& GetJsonBPPathCache()
+{
+	static TMap<FString, UJsonPath*> cache;
+	return cache;
+}
+
+//parses a non negative decimal index without leading zeros, as required by json pointer
+static bool JsonBPParseIndex(const FString& token, int32& outIndex)
+{
+	if (token.Len() == 0 || token.Len() > 9 || (token.Len() > 1 && token[0] == TEXT('0')))
+		return false;
+
+	int32 index = 0;
+	for (TCHAR c : token)
+	{
+		if (c < TEXT('0') || c > TEXT('9'))
+			return false;
+		index = index * 10 + (c - TEXT('0'));
+	}
+
+	outIndex = index;
+	return true;
+}
+
+bool UJsonPath::ParsePointer(const FString& pointer, TArray<FJsonBPPathSegment>& outSegments)
+{
+	outSegments.Reset();
+
+	//"" is the whole document
+	if (pointer.Len() == 0)
+		return true;
+
+	if (pointer[0] != TEXT('/'))
+		return false;
+
+	int32 tokenStart = 1;
+	for (int32 i = 1; i <= pointer.Len(); i++)
+	{
+		if (i < pointer.Len() && pointer[i] != TEXT('/'))
+			continue;
+
+		FJsonBPPathSegment& segment = outSegments.AddDefaulted_GetRef();
+		segment.Kind = FJsonBPPathSegment::EKind::KeyOrIndex;
+		segment.Key.Reserve(i - tokenStart);
+
+		for (int32 j = tokenStart; j < i; j++)
+		{
+			const TCHAR c = pointer[j];
+			if (c != TEXT('~'))
+			{
+				segment.Key.AppendChar(c);
+				continue;
+			}
+
+			//~0 is '~' and ~1 is '/'
+			if (j + 1 >= i || (pointer[j + 1] != TEXT('0') && pointer[j + 1] != TEXT('1')))
+				return false;
+
+			segment.Key.AppendChar(pointer[j + 1] == TEXT('0') ? TEXT('~') : TEXT('/'));
+			j++;
+		}
+
+		if (!JsonBPParseIndex(segment.Key, segment.Index))
+			segment.Index = INDEX_NONE;
+
+		tokenStart = i + 1;
+	}
+
+	return true;
+}
+
+bool UJsonPath::ParseJsonPath(const FString& path, TArray<FJsonBPPathSegment>& outSegments)
+{
+	outSegments.Reset();
+
+	if (path.Len() == 0 || path[0] != TEXT('$'))
+		return false;
+
+	const TCHAR* pCur = *path + 1;
+	while (*pCur)
+	{
+		FJsonBPPathSegment& segment = outSegments.AddDefaulted_GetRef();
+
+		if (*pCur == TEXT('.'))
+		{
+			pCur++;
+			if (*pCur == TEXT('*'))
+			{
+				segment.Kind = FJsonBPPathSegment::EKind::Wildcard;
+				pCur++;
+				continue;
+			}
+
+			const TCHAR* pNameStart = pCur;
+			while (*pCur && *pCur != TEXT('.') && *pCur != TEXT('['))
+				pCur++;
+
+			if (pCur == pNameStart)
+				return false;
+
+			segment.Kind = FJsonBPPathSegment::EKind::Key;
+			segment.Key = FString((int32)(pCur - pNameStart), pNameStart);
+			continue;
+		}
+
+		if (*pCur != TEXT('['))
+			return false;
+		pCur++;
+
+		if (*pCur == TEXT('*'))
+		{
+			segment.Kind = FJsonBPPathSegment::EKind::Wildcard;
+			pCur++;
+		}
+		else if (*pCur == TEXT('\'') || *pCur == TEXT('"'))
+		{
+			const TCHAR quote = *pCur++;
+			segment.Kind = FJsonBPPathSegment::EKind::Key;
+			while (*pCur && *pCur != quote)
+			{
+				//backslash escapes the next character
+				if (*pCur == TEXT('\\') && pCur[1])
+					pCur++;
+				segment.Key.AppendChar(*pCur++);
+			}
+
+			if (*pCur != quote)
+				return false;
+			pCur++;
+		}
+		else
+		{
+			const bool bNegative = *pCur == TEXT('-');
+			if (bNegative)
+				pCur++;
+
+			if (*pCur < TEXT('0') || *pCur > TEXT('9'))
+				return false;
+
+			int32 index = 0;
+			while (*pCur >= TEXT('0') && *pCur <= TEXT('9') && index < 100000000)
+				index = index * 10 + (*pCur++ - TEXT('0'));
+
+			segment.Kind = FJsonBPPathSegment::EKind::Index;
+			segment.Index = bNegative ? -index : index;
+		}
+
+		if (*pCur != TEXT(']'))
+			return false;
+		pCur++;
+	}
+
+	return true;
+}
+
+UJsonPath* UJsonPath::MakePath(const FString& source, TArray<FJsonBPPathSegment>&& segments)
+{
+	UJsonPath* pPath = NewObject<UJsonPath>();
+	pPath->Source = source;
+	pPath->Segments = MoveTemp(segments);
+	for (FJsonBPPathSegment& segment : pPath->Segments)
+	{
+		if (segment.Kind == FJsonBPPathSegment::EKind::Key || segment.Kind == FJsonBPPathSegment::EKind::KeyOrIndex)
+			segment.InternedKey = FJsonBPKey(segment.Key);
+	}
+	pPath->bHasWildcards = pPath->Segments.ContainsByPredicate([](const FJsonBPPathSegment& segment) { return segment.Kind == FJsonBPPathSegment::EKind::Wildcard; });
+	return pPath;
+}
+
+UJsonPath* UJsonPath::CompilePointer(const FString& pointer)
+{
+	TArray<FJsonBPPathSegment> segments;
+	if (!ParsePointer(pointer, segments))
+	{
+		UE_LOG(LogJsonBP, Warning, TEXT("invalid json pointer: %s"), *pointer);
+		return nullptr;
+	}
+
+	return MakePath(pointer, MoveTemp(segments));
+}
+
+UJsonPath* UJsonPath::CompileJsonPath(const FString& path)
+{
+	TArray<FJsonBPPathSegment> segments;
+	if (!ParseJsonPath(path, segments))
+	{
+		UE_LOG(LogJsonBP, Warning, TEXT("invalid json path: %s"), *path);
+		return nullptr;
+	}
+
+	return MakePath(path, MoveTemp(segments));
+}
+
+UJsonPath* UJsonPath::GetCachedPath(const FString& path)
+{
+	check(IsInGameThread());
+
+	TMap<FString, UJsonPath*>& cache = GetJsonBPPathCache();
+	if (UJsonPath** ppCached = cache.Find(path))
+		return *ppCached;
+
+	UJsonPath* pPath = path.StartsWith(TEXT("$"), ESearchCase::CaseSensitive) ? CompileJsonPath(path) : CompilePointer(path);
+	if (pPath && cache.Num() < JsonBPMaxCachedPaths)
+	{
+		//cached paths live until ClearCache
+		pPath->AddToRoot();
+		cache.Add(path, pPath);
+	}
+
+	return pPath;
+}
+
+void UJsonPath::ClearCache()
+{
+	for (const auto& pair : GetJsonBPPathCache())
+		pair.Value->RemoveFromRoot();
+
+	GetJsonBPPathCache().Empty();
+}
+
+UJsonValue* UJsonPath::Step(const UJsonValue* value, const FJsonBPPathSegment& segment)
+{
+	if (!value)
+		return nullptr;
+
+	value->Expand();
+	//shared children are replaced with copies like GetFieldValue does, so what is found can be changed
+	UJsonValue** ppChild = nullptr;
+	switch (segment.Kind)
+	{
+	case FJsonBPPathSegment::EKind::Key:
+		if (value->JsonType == EJsonType::JSON_Object)
+			ppChild = const_cast<FJsonBPObjectMap&>(value->ValueObject).Find(segment.InternedKey);
+		break;
+
+	case FJsonBPPathSegment::EKind::Index:
+	{
+		if (value->JsonType != EJsonType::JSON_Array)
+			return nullptr;
+
+		const int32 index = segment.Index < 0 ? value->ValueArray.Num() + segment.Index : segment.Index;
+		if (value->ValueArray.IsValidIndex(index))
+			ppChild = const_cast<UJsonValue**>(&value->ValueArray[index]);
+		break;
+	}
+
+	case FJsonBPPathSegment::EKind::KeyOrIndex:
+		if (value->JsonType == EJsonType::JSON_Object)
+			ppChild = const_cast<FJsonBPObjectMap&>(value->ValueObject).Find(segment.InternedKey);
+		else if (value->JsonType == EJsonType::JSON_Array && value->ValueArray.IsValidIndex(segment.Index))
+			ppChild = const_cast<UJsonValue**>(&value->ValueArray[segment.Index]);
+		break;
+
+	case FJsonBPPathSegment::EKind::Wildcard:
+		break;
+	}
+
+	return ppChild ? value->UnshareChild(*ppChild) : nullptr;
+}
+
+void UJsonPath::Collect(UJsonValue* value, int32 segmentIndex, TArray<UJsonValue*>& outMatches, bool bFirstOnly) const
+{
+	//plain steps in a loop, recursion only for wildcards
+	for (; value && segmentIndex < Segments.Num(); segmentIndex++)
+	{
+		const FJsonBPPathSegment& segment = Segments[segmentIndex];
+		if (segment.Kind != FJsonBPPathSegment::EKind::Wildcard)
+		{
+			value = Step(value, segment);
+			continue;
+		}
+
+		value->Expand();
+		if (value->JsonType == EJsonType::JSON_Array)
+		{
+			for (UJsonValue*& pElement : value->ValueArray)
+			{
+				Collect(value->UnshareChild(pElement), segmentIndex + 1, outMatches, bFirstOnly);
+				if (bFirstOnly && outMatches.Num() > 0)
+					return;
+			}
+		}
+		else if (value->JsonType == EJsonType::JSON_Object)
+		{
+			for (auto& pair : value->ValueObject)
+			{
+				Collect(value->UnshareChild(pair.Value), segmentIndex + 1, outMatches, bFirstOnly);
+				if (bFirstOnly && outMatches.Num() > 0)
+					return;
+			}
+		}
+		return;
+	}
+
+	if (value)
+		outMatches.Add(value);
+}
+
+UJsonValue* UJsonPath::Find(UJsonValue* root) const
+{
+	if (!bHasWildcards)
+	{
+		UJsonValue* pValue = root;
+		for (const FJsonBPPathSegment& segment : Segments)
+		{
+			pValue = Step(pValue, segment);
+			if (!pValue)
+				return nullptr;
+		}
+		return pValue;
+	}
+
+	TArray<UJsonValue*> collected;
+	Collect(root, 0, collected, true);
+	return collected.Num() > 0 ? collected[0] : nullptr;
+}
+
+bool UJsonPath::FindAll(UJsonValue* root, TArray<UJsonValue*>& matches) const
+{
+	matches.Reset();
+	Collect(root, 0, matches, false);
+	return matches.Num() > 0;
+}
@@ -0,0 +1,131 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPPool.h"
+#include "JsonBPPrivate.h"
+
+TArray<UJsonValuePool*> UJsonValuePool::ActivePools;
+
+
+UJsonValuePool* UJsonValuePool::MakeJsonValuePool(int32 maxFree)
+{
+	UJsonValuePool* pPool = NewObject<UJsonValuePool>();
+	pPool->MaxFree = FMath::Max(maxFree, 0);
+	return pPool;
+}
+
+UJsonValue* UJsonValuePool::Acquire()
+{
+	UJsonValue* pValue;
+	if (FreeValues.Num() > 0)
+	{
+		pValue = FreeValues.Pop(false);
+		pValue->bPooled = false;
+		Stats.Hits++;
+	}
+	else
+	{
+		pValue = NewObject<UJsonValue>();
+		Stats.Misses++;
+	}
+
+	Stats.NumInUse++;
+	Stats.HighWaterMark = FMath::Max(Stats.HighWaterMark, Stats.NumInUse);
+	return pValue;
+}
+
+void UJsonValuePool::Reclaim(UJsonValue* value)
+{
+	check(IsInGameThread());
+
+	TArray<UJsonValue*, TInlineAllocator<64>> pending;
+	if (value)
+		pending.Add(value);
+
+	while (pending.Num() > 0)
+	{
+		UJsonValue* pValue = pending.Pop(false);
+		//the same value twice in a tree (or reclaimed twice) must not be handed out twice.
+		//shared subtrees are still used by the other copies
+		if (!pValue || pValue->bPooled || pValue->bShared)
+			continue;
+
+		//children of a lazy container don't exist yet, Clear just drops the document
+		pending.Append(pValue->ValueArray);
+		for (const auto& pair : pValue->ValueObject)
+			pending.Add(pair.Value);
+
+		pValue->Clear();
+		//a reused value starts outside of any cached tree
+		pValue->TextCache.Reset();
+		Stats.Reclaimed++;
+		//values made before the pool was active are taken too, they just weren't counted as in use
+		Stats.NumInUse = FMath::Max(Stats.NumInUse - 1, 0);
+
+		if (FreeValues.Num() < MaxFree)
+		{
+			pValue->bPooled = true;
+			FreeValues.Add(pValue);
+		}
+		else
+		{
+			Stats.Dropped++;
+		}
+	}
+}
+
+void UJsonValuePool::Reserve(int32 count)
+{
+	count = FMath::Min(count, MaxFree);
+	FreeValues.Reserve(count);
+	while (FreeValues.Num() < count)
+	{
+		UJsonValue* pValue = NewObject<UJsonValue>();
+		pValue->bPooled = true;
+		FreeValues.Add(pValue);
+	}
+}
+
+void UJsonValuePool::Trim()
+{
+	for (UJsonValue* pValue : FreeValues)
+		pValue->bPooled = false;
+	FreeValues.Empty();
+}
+
+void UJsonValuePool::Activate()
+{
+	check(IsInGameThread());
+	ActivePools.Add(this);
+}
+
+void UJsonValuePool::Deactivate()
+{
+	check(IsInGameThread());
+	//normally the last one, scopes end in reverse order
+	const int32 index = ActivePools.FindLast(this);
+	if (index != INDEX_NONE)
+		ActivePools.RemoveAt(index);
+}
+
+FJsonValuePoolStats UJsonValuePool::GetStats() const
+{
+	FJsonValuePoolStats stats = Stats;
+	stats.NumFree = FreeValues.Num();
+	return stats;
+}
+
+void UJsonValuePool::ResetStats()
+{
+	//in use values are still out there
+	const int32 numInUse = Stats.NumInUse;
+	Stats = FJsonValuePoolStats();
+	Stats.NumInUse = numInUse;
+	Stats.HighWaterMark = numInUse;
+}
+
+void UJsonValuePool::BeginDestroy()
+{
+	//a pool that was never deactivated must not stay in the list
+	ActivePools.Remove(this);
+	Super::BeginDestroy();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Runtime/Launch/Resources/Version.h"
+#include "JsonBPWriter.h"
+#if ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 25
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#endif
+
+class UJsonValue;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogJsonBP, Log, All);
+
+/*
+"stat JsonBP" shows the time spent in the top level calls and the values/bytes made per frame,
+csv captures record the same in the JsonBP category. all of it compiles away without stats and csv (shipping).
+*/
+DECLARE_STATS_GROUP(TEXT("JsonBP"), STATGROUP_JsonBP, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse to FJsonValue"), STAT_JsonBP_Parse, STATGROUP_JsonBP, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse to UJsonValue"), STAT_JsonBP_BuildTree, STATGROUP_JsonBP, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse to document"), STAT_JsonBP_ParseDocument, STATGROUP_JsonBP, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Stringify"), STAT_JsonBP_Stringify, STATGROUP_JsonBP, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ToCPPVersion"), STAT_JsonBP_ToCPPVersion, STATGROUP_JsonBP, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MakeFromCPPVersion"), STAT_JsonBP_MakeFromCPPVersion, STATGROUP_JsonBP, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Struct conversion"), STAT_JsonBP_StructConversion, STATGROUP_JsonBP, );
+
+CSV_DECLARE_CATEGORY_EXTERN(JsonBP);
+
+//stat scopes are traced to Insights already, the trace scope covers builds without stats
+#if !STATS && defined(TRACE_CPUPROFILER_EVENT_SCOPE)
+#define JSONBP_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE(JsonBP_##Name)
+#else
+#define JSONBP_TRACE_SCOPE(Name)
+#endif
+
+//times one top level call, recursive parts are not scoped so each call is counted once
+#define JSONBP_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_JsonBP_##Name); \
+	CSV_SCOPED_TIMING_STAT(JsonBP, Name); \
+	JSONBP_TRACE_SCOPE(Name)
+
+#define JSONBP_STATS (STATS || CSV_PROFILER)
+
+#if JSONBP_STATS
+//counted on any thread, published and reset by the module at the end of every frame
+struct FJsonBPCounters
+{
+	static FThreadSafeCounter LiveValues;
+	static FThreadSafeCounter ValuesCreated;
+	static FThreadSafeCounter BytesParsed;
+	static FThreadSafeCounter BytesEmitted;
+};
+#define JSONBP_COUNT(Counter, Amount) FJsonBPCounters::Counter.Add((int32)(Amount))
+#else
+#define JSONBP_COUNT(Counter, Amount)
+#endif
+
+//creates an empty (JSON_None) json value
+UJsonValue* MakeJsonValue();
+
+#if !UE_BUILD_SHIPPING
+//values MakeJsonValue made on this thread, the benchmarks read it before and after a run
+extern thread_local int64 JsonBPValuesMadeOnThread;
+#endif
+
+//integers up to 2^53 are exact in a double
+static const double JsonBPMaxExactDoubleInteger = 9007199254740992.0;
+
+//truncates toward zero, clamped to the int64 range. nan is 0
+inline int64 JsonBPDoubleToInt64(double value)
+{
+	if (value != value)
+		return 0;
+	if (value >= 9223372036854775807.0)
+		return MAX_int64;
+	if (value <= -9223372036854775808.0)
+		return MIN_int64;
+	return (int64)value;
+}
+
+//arrays of at least this many numbers (or strings) are read into packed elements, see UJsonValue::IsPacked
+static const int32 JsonBPMinPackedElements = 16;
+//integers up to this size are written the same as integers and as doubles, so they can be packed together with doubles
+static const int64 JsonBPMaxPackedInteger = 999999999999999;
+
+//escapes a key for a json pointer, '~' is ~0 and '/' is ~1
+inline FString JsonBPEscapePointerToken(const FString& key)
+{
+	if (!key.Contains(TEXT("~")) && !key.Contains(TEXT("/")))
+		return key;
+
+	return key.Replace(TEXT("~"), TEXT("~0")).Replace(TEXT("/"), TEXT("~1"));
+}
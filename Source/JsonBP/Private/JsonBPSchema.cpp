@@ -0,0 +1,848 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPSchema.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPPatch.h"
+#include "JsonBPReader.h"
+#include "JsonBPValueBuilder.h"
+
+namespace EJsonBPSchemaType
+{
+	enum Type : uint8
+	{
+		Null = 1 << 0,
+		Boolean = 1 << 1,
+		Integer = 1 << 2,
+		Number = 1 << 3,
+		String = 1 << 4,
+		Array = 1 << 5,
+		Object = 1 << 6,
+	};
+}
+
+//in the order of the EJsonBPSchemaType bits
+static const TCHAR* const JsonBPSchemaTypeNames[] = { TEXT("null"), TEXT("boolean"), TEXT("integer"), TEXT("number"), TEXT("string"), TEXT("array"), TEXT("object") };
+
+static uint8 JsonBPSchemaTypeFromName(const FString& name)
+{
+	for (int32 i = 0; i < ARRAY_COUNT(JsonBPSchemaTypeNames); i++)
+	{
+		if (name.Equals(JsonBPSchemaTypeNames[i], ESearchCase::CaseSensitive))
+			return (uint8)(1 << i);
+	}
+	return 0;
+}
+
+static const TCHAR* JsonBPSchemaTypeName(EJsonType type)
+{
+	switch (type)
+	{
+	case EJsonType::JSON_Boolean:
+		return TEXT("boolean");
+	case EJsonType::JSON_Number:
+		return TEXT("number");
+	case EJsonType::JSON_String:
+		return TEXT("string");
+	case EJsonType::JSON_Array:
+		return TEXT("array");
+	case EJsonType::JSON_Object:
+		return TEXT("object");
+	default:
+		return TEXT("null");
+	}
+}
+
+//non negative integer keywords (minLength, maxItems...)
+static bool JsonBPSchemaCount(const UJsonValue* value, int32& outCount)
+{
+	double number;
+	if (!value || !value->GetValueAsDouble(number) || number < 0 || number != FMath::FloorToDouble(number))
+		return false;
+
+	outCount = (int32)FMath::Min(number, (double)MAX_int32);
+	return true;
+}
+
+//a null, boolean, number or string, from a UJsonValue or straight from the reader
+struct FJsonBPSchemaScalar
+{
+	EJsonType Type = EJsonType::JSON_Null;
+	bool bValue = false;
+	bool bInteger = false;
+	int64 Integer = 0;
+	double Number = 0;
+	const FString* String = nullptr;
+};
+
+/*
+checks values against a compiled UJsonSchema. ValidateValue walks a tree, as a TJsonBPReader handler it checks text while it is read.
+errors go to the list given to the constructor, located by the json pointer of the value that failed.
+*/
+class FJsonBPSchemaValidator
+{
+public:
+	FJsonBPSchemaValidator(const UJsonSchema& schema, TArray<FJsonSchemaError>& outErrors)
+		: Schema(schema), Errors(outErrors), RootNode(schema.Nodes.Num() > 0 ? 0 : INDEX_NONE), bStopped(false)
+	{
+	}
+
+	//true once MaxErrors errors were found, the reader is stopped then
+	bool IsStopped() const { return bStopped; }
+
+	void ValidateValue(const UJsonValue* value) { ValidateValue(RootNode, value); }
+
+	bool OnNull()
+	{
+		ForwardToCaptures([](FJsonBPValueBuilder& builder) { return builder.OnNull(); });
+		return OnScalar(FJsonBPSchemaScalar());
+	}
+	bool OnBoolean(bool value)
+	{
+		ForwardToCaptures([value](FJsonBPValueBuilder& builder) { return builder.OnBoolean(value); });
+		FJsonBPSchemaScalar scalar;
+		scalar.Type = EJsonType::JSON_Boolean;
+		scalar.bValue = value;
+		return OnScalar(scalar);
+	}
+	bool OnNumber(double value)
+	{
+		ForwardToCaptures([value](FJsonBPValueBuilder& builder) { return builder.OnNumber(value); });
+		FJsonBPSchemaScalar scalar;
+		scalar.Type = EJsonType::JSON_Number;
+		scalar.Number = value;
+		return OnScalar(scalar);
+	}
+	bool OnInteger(int64 value)
+	{
+		ForwardToCaptures([value](FJsonBPValueBuilder& builder) { return builder.OnInteger(value); });
+		FJsonBPSchemaScalar scalar;
+		scalar.Type = EJsonType::JSON_Number;
+		scalar.bInteger = true;
+		scalar.Integer = value;
+		return OnScalar(scalar);
+	}
+	bool OnString(const FString& value)
+	{
+		ForwardToCaptures([&value](FJsonBPValueBuilder& builder) { return builder.OnString(value); });
+		FJsonBPSchemaScalar scalar;
+		scalar.Type = EJsonType::JSON_String;
+		scalar.String = &value;
+		return OnScalar(scalar);
+	}
+
+	bool OnArrayBegin()
+	{
+		ForwardToCaptures([](FJsonBPValueBuilder& builder) { return builder.OnArrayBegin(); });
+		const int32 nodeIndex = BeginContainer(EJsonType::JSON_Array);
+		PushFrame(nodeIndex, false).ChildNode = nodeIndex != INDEX_NONE ? Schema.Nodes[nodeIndex].Items : INDEX_NONE;
+		return !bStopped;
+	}
+	bool OnObjectBegin()
+	{
+		ForwardToCaptures([](FJsonBPValueBuilder& builder) { return builder.OnObjectBegin(); });
+		PushFrame(BeginContainer(EJsonType::JSON_Object), true);
+		return !bStopped;
+	}
+	bool OnArrayEnd()
+	{
+		ForwardToCaptures([](FJsonBPValueBuilder& builder) { return builder.OnArrayEnd(); });
+		return EndContainer(EJsonType::JSON_Array);
+	}
+	bool OnObjectEnd()
+	{
+		ForwardToCaptures([](FJsonBPValueBuilder& builder) { return builder.OnObjectEnd(); });
+		return EndContainer(EJsonType::JSON_Object);
+	}
+
+	bool OnObjectKey(const FString& key)
+	{
+		ForwardToCaptures([&key](FJsonBPValueBuilder& builder) { return builder.OnObjectKey(key); });
+		FFrame& frame = Stack.Last();
+		frame.Key = key;
+		frame.ChildNode = INDEX_NONE;
+		if (frame.Node == INDEX_NONE)
+			return true;
+
+		//a key that was never interned is in no schema
+		int32 requiredIndex;
+		if (!FindFieldNode(Schema.Nodes[frame.Node], FJsonBPKey::Find(key), frame.ChildNode, requiredIndex))
+			AddError(TEXT("additionalProperties"), TEXT("field is not allowed"));
+		if (requiredIndex != INDEX_NONE)
+			frame.RequiredSeen[requiredIndex] = true;
+		return !bStopped;
+	}
+
+private:
+	//an array or object the value being checked is in
+	struct FFrame
+	{
+		//schema of the container, INDEX_NONE if anything goes
+		int32 Node = INDEX_NONE;
+		//schema of the value being read
+		int32 ChildNode = INDEX_NONE;
+		bool bObject = false;
+		//elements/fields done so far, the index of the current element
+		int32 Count = 0;
+		//key of the current field, interned for trees and copied for text
+		FJsonBPKey InternedKey;
+		FString Key;
+		TArray<bool, TInlineAllocator<16>> RequiredSeen;
+	};
+
+	void ValidateValue(int32 nodeIndex, const UJsonValue* value)
+	{
+		if (nodeIndex == INDEX_NONE || bStopped)
+			return;
+
+		const FJsonBPSchemaNode& node = Schema.Nodes[nodeIndex];
+		const EJsonType type = value ? value->JsonType : EJsonType::JSON_Null;
+		if (type != EJsonType::JSON_Array && type != EJsonType::JSON_Object)
+		{
+			CheckScalar(node, MakeScalar(value));
+			return;
+		}
+		if (!CheckNever(node))
+			return;
+
+		value->Expand();
+		CheckType(node, type, false);
+		if (node.bHasEnum && !MatchesEnum(node, value))
+			AddError(TEXT("enum"), TEXT("not one of the allowed values"));
+
+		const int32 depth = Stack.Num();
+		if (type == EJsonType::JSON_Array)
+		{
+			CheckCount(node, type, value->ValueArray.Num());
+			if (node.Items == INDEX_NONE)
+				return;
+
+			PushFrame(nodeIndex, false);
+			for (int32 i = 0; i < value->ValueArray.Num() && !bStopped; i++)
+			{
+				Stack[depth].Count = i;
+				ValidateValue(node.Items, value->ValueArray[i]);
+			}
+			Stack.Pop(false);
+			return;
+		}
+
+		CheckCount(node, type, value->ValueObject.Num());
+		for (FJsonBPKey key : node.Required)
+		{
+			if (!value->ValueObject.Contains(key))
+				AddError(TEXT("required"), FString::Printf(TEXT("field %s is missing"), *key.ToString()));
+		}
+
+		PushFrame(nodeIndex, true);
+		for (const auto& pair : value->ValueObject)
+		{
+			if (bStopped)
+				break;
+
+			Stack[depth].InternedKey = pair.Key;
+			int32 childNode, requiredIndex;
+			if (FindFieldNode(node, pair.Key, childNode, requiredIndex))
+				ValidateValue(childNode, pair.Value);
+			else
+				AddError(TEXT("additionalProperties"), TEXT("field is not allowed"));
+		}
+		Stack.Pop(false);
+	}
+
+	static FJsonBPSchemaScalar MakeScalar(const UJsonValue* value)
+	{
+		FJsonBPSchemaScalar scalar;
+		if (!value)
+			return scalar;
+
+		switch (value->JsonType)
+		{
+		case EJsonType::JSON_Boolean:
+			scalar.Type = EJsonType::JSON_Boolean;
+			scalar.bValue = value->ValueBool;
+			break;
+		case EJsonType::JSON_Number:
+			scalar.Type = EJsonType::JSON_Number;
+			scalar.bInteger = value->bIntegerNumber;
+			scalar.Integer = value->ValueInteger;
+			scalar.Number = value->ValueNumber;
+			break;
+		case EJsonType::JSON_String:
+			scalar.Type = EJsonType::JSON_String;
+			scalar.String = &value->ValueString;
+			break;
+		default:
+			break;
+		}
+		return scalar;
+	}
+
+	bool OnScalar(const FJsonBPSchemaScalar& scalar)
+	{
+		const int32 nodeIndex = GetValueNode();
+		if (nodeIndex != INDEX_NONE)
+			CheckScalar(Schema.Nodes[nodeIndex], scalar);
+		EndValue();
+		return !bStopped;
+	}
+
+	//checks the start of an array/object read from text, returns the schema for its frame
+	int32 BeginContainer(EJsonType type)
+	{
+		const int32 nodeIndex = GetValueNode();
+		if (nodeIndex == INDEX_NONE)
+			return INDEX_NONE;
+
+		const FJsonBPSchemaNode& node = Schema.Nodes[nodeIndex];
+		if (!CheckNever(node))
+			return INDEX_NONE;
+
+		CheckType(node, type, false);
+		//enum arrays/objects are compared as a whole, so this one is built while it is read
+		if (node.bEnumHasContainers)
+		{
+			Captures.Add(MakeUnique<FJsonBPValueBuilder>());
+			if (type == EJsonType::JSON_Array)
+				Captures.Last()->OnArrayBegin();
+			else
+				Captures.Last()->OnObjectBegin();
+		}
+		return nodeIndex;
+	}
+
+	bool EndContainer(EJsonType type)
+	{
+		FFrame frame = Stack.Pop(false);
+		if (frame.Node != INDEX_NONE)
+		{
+			const FJsonBPSchemaNode& node = Schema.Nodes[frame.Node];
+			CheckCount(node, type, frame.Count);
+			for (int32 i = 0; i < frame.RequiredSeen.Num(); i++)
+			{
+				if (!frame.RequiredSeen[i])
+					AddError(TEXT("required"), FString::Printf(TEXT("field %s is missing"), *node.Required[i].ToString()));
+			}
+
+			//inner captures ended before this one
+			if (node.bEnumHasContainers)
+			{
+				if (node.bHasEnum && !MatchesEnum(node, Captures.Last()->GetResult()))
+					AddError(TEXT("enum"), TEXT("not one of the allowed values"));
+				Captures.Pop(false);
+			}
+		}
+
+		EndValue();
+		return !bStopped;
+	}
+
+	template<typename FuncType> void ForwardToCaptures(FuncType func)
+	{
+		for (TUniquePtr<FJsonBPValueBuilder>& pBuilder : Captures)
+			func(*pBuilder);
+	}
+
+	//schema of the value being read from text, INDEX_NONE if anything goes
+	int32 GetValueNode() const
+	{
+		return Stack.Num() > 0 ? Stack.Last().ChildNode : RootNode;
+	}
+
+	void EndValue()
+	{
+		if (Stack.Num() > 0)
+			Stack.Last().Count++;
+	}
+
+	FFrame& PushFrame(int32 nodeIndex, bool bObject)
+	{
+		FFrame& frame = Stack.AddDefaulted_GetRef();
+		frame.Node = nodeIndex;
+		frame.bObject = bObject;
+		if (bObject && nodeIndex != INDEX_NONE)
+			frame.RequiredSeen.SetNumZeroed(Schema.Nodes[nodeIndex].Required.Num());
+		return frame;
+	}
+
+	//schema of a field, INDEX_NONE if anything goes. returns false if the field is not allowed at all
+	static bool FindFieldNode(const FJsonBPSchemaNode& node, FJsonBPKey key, int32& outNode, int32& outRequiredIndex)
+	{
+		const FJsonBPSchemaProperty* pProperty = key.IsValid() ? node.Properties.Find(key) : nullptr;
+		outRequiredIndex = pProperty ? pProperty->RequiredIndex : INDEX_NONE;
+		if (pProperty && pProperty->Node != INDEX_NONE)
+		{
+			outNode = pProperty->Node;
+			return true;
+		}
+
+		outNode = node.AdditionalProperties;
+		return !node.bNoAdditionalProperties;
+	}
+
+	bool CheckNever(const FJsonBPSchemaNode& node)
+	{
+		if (!node.bNever)
+			return true;
+
+		AddError(TEXT("false"), TEXT("no value is allowed here"));
+		return false;
+	}
+
+	void CheckType(const FJsonBPSchemaNode& node, EJsonType type, bool bIntegral)
+	{
+		if (node.Types == 0)
+			return;
+
+		uint8 bits;
+		switch (type)
+		{
+		case EJsonType::JSON_Boolean:
+			bits = EJsonBPSchemaType::Boolean;
+			break;
+		case EJsonType::JSON_Number:
+			bits = EJsonBPSchemaType::Number | (bIntegral ? EJsonBPSchemaType::Integer : 0);
+			break;
+		case EJsonType::JSON_String:
+			bits = EJsonBPSchemaType::String;
+			break;
+		case EJsonType::JSON_Array:
+			bits = EJsonBPSchemaType::Array;
+			break;
+		case EJsonType::JSON_Object:
+			bits = EJsonBPSchemaType::Object;
+			break;
+		default:
+			bits = EJsonBPSchemaType::Null;
+			break;
+		}
+		if (node.Types & bits)
+			return;
+
+		FString expected;
+		for (int32 i = 0; i < ARRAY_COUNT(JsonBPSchemaTypeNames); i++)
+		{
+			if (node.Types & (1 << i))
+			{
+				if (!expected.IsEmpty())
+					expected += TEXT(", ");
+				expected += JsonBPSchemaTypeNames[i];
+			}
+		}
+		AddError(TEXT("type"), FString::Printf(TEXT("expected %s, got %s"), *expected, JsonBPSchemaTypeName(type)));
+	}
+
+	void CheckCount(const FJsonBPSchemaNode& node, EJsonType type, int32 count)
+	{
+		const bool bArray = type == EJsonType::JSON_Array;
+		const int32 minimum = bArray ? node.MinItems : node.MinProperties;
+		const int32 maximum = bArray ? node.MaxItems : node.MaxProperties;
+		const TCHAR* const what = bArray ? TEXT("elements") : TEXT("fields");
+		if (count < minimum)
+			AddError(bArray ? TEXT("minItems") : TEXT("minProperties"), FString::Printf(TEXT("%d %s, at least %d are needed"), count, what, minimum));
+		if (count > maximum)
+			AddError(bArray ? TEXT("maxItems") : TEXT("maxProperties"), FString::Printf(TEXT("%d %s, at most %d are allowed"), count, what, maximum));
+	}
+
+	void CheckScalar(const FJsonBPSchemaNode& node, const FJsonBPSchemaScalar& scalar)
+	{
+		if (!CheckNever(node))
+			return;
+
+		const double number = scalar.bInteger ? (double)scalar.Integer : scalar.Number;
+		CheckType(node, scalar.Type, scalar.Type == EJsonType::JSON_Number && (scalar.bInteger || FMath::FloorToDouble(number) == number));
+		if (node.bHasEnum && !MatchesEnum(node, scalar))
+			AddError(TEXT("enum"), TEXT("not one of the allowed values"));
+
+		if (scalar.Type == EJsonType::JSON_Number)
+		{
+			if (node.Minimum.IsSet() && number < node.Minimum.GetValue())
+				AddError(TEXT("minimum"), FString::Printf(TEXT("%s is less than %s"), *FString::SanitizeFloat(number), *FString::SanitizeFloat(node.Minimum.GetValue())));
+			if (node.ExclusiveMinimum.IsSet() && number <= node.ExclusiveMinimum.GetValue())
+				AddError(TEXT("exclusiveMinimum"), FString::Printf(TEXT("%s is not greater than %s"), *FString::SanitizeFloat(number), *FString::SanitizeFloat(node.ExclusiveMinimum.GetValue())));
+			if (node.Maximum.IsSet() && number > node.Maximum.GetValue())
+				AddError(TEXT("maximum"), FString::Printf(TEXT("%s is greater than %s"), *FString::SanitizeFloat(number), *FString::SanitizeFloat(node.Maximum.GetValue())));
+			if (node.ExclusiveMaximum.IsSet() && number >= node.ExclusiveMaximum.GetValue())
+				AddError(TEXT("exclusiveMaximum"), FString::Printf(TEXT("%s is not less than %s"), *FString::SanitizeFloat(number), *FString::SanitizeFloat(node.ExclusiveMaximum.GetValue())));
+		}
+		else if (scalar.Type == EJsonType::JSON_String)
+		{
+			const int32 length = scalar.String->Len();
+			if (length < node.MinLength)
+				AddError(TEXT("minLength"), FString::Printf(TEXT("%d characters, at least %d are needed"), length, node.MinLength));
+			if (length > node.MaxLength)
+				AddError(TEXT("maxLength"), FString::Printf(TEXT("%d characters, at most %d are allowed"), length, node.MaxLength));
+			if (node.Pattern != INDEX_NONE)
+			{
+				//pattern is not anchored, a match anywhere in the string is enough
+				FRegexMatcher matcher(Schema.Patterns[node.Pattern], *scalar.String);
+				if (!matcher.FindNext())
+					AddError(TEXT("pattern"), TEXT("doesn't match the pattern"));
+			}
+		}
+	}
+
+	bool MatchesEnum(const FJsonBPSchemaNode& node, const UJsonValue* value) const
+	{
+		for (int32 i = node.EnumFirst; i < node.EnumFirst + node.EnumCount; i++)
+		{
+			if (UJsonPatchLibrary::JsonEquals(Schema.EnumValues[i], value))
+				return true;
+		}
+		return false;
+	}
+
+	bool MatchesEnum(const FJsonBPSchemaNode& node, const FJsonBPSchemaScalar& scalar) const
+	{
+		for (int32 i = node.EnumFirst; i < node.EnumFirst + node.EnumCount; i++)
+		{
+			const UJsonValue* pValue = Schema.EnumValues[i];
+			const EJsonType type = pValue->JsonType == EJsonType::JSON_None ? EJsonType::JSON_Null : pValue->JsonType;
+			if (type != scalar.Type)
+				continue;
+
+			switch (type)
+			{
+			case EJsonType::JSON_Boolean:
+				if (pValue->ValueBool == scalar.bValue)
+					return true;
+				break;
+			case EJsonType::JSON_Number:
+				//the same rule as JsonEquals, 1 and 1.0 are equal
+				if (pValue->bIntegerNumber && scalar.bInteger)
+				{
+					if (pValue->ValueInteger == scalar.Integer)
+						return true;
+				}
+				else if ((pValue->bIntegerNumber ? (double)pValue->ValueInteger : pValue->ValueNumber) == (scalar.bInteger ? (double)scalar.Integer : scalar.Number))
+				{
+					return true;
+				}
+				break;
+			case EJsonType::JSON_String:
+				if (pValue->ValueString.Equals(*scalar.String, ESearchCase::CaseSensitive))
+					return true;
+				break;
+			default:
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void AddError(const TCHAR* keyword, const FString& message)
+	{
+		if (bStopped)
+			return;
+
+		FJsonSchemaError& error = Errors.AddDefaulted_GetRef();
+		for (const FFrame& frame : Stack)
+		{
+			error.Location += TEXT('/');
+			if (!frame.bObject)
+				error.Location.AppendInt(frame.Count);
+			else
+				error.Location += JsonBPEscapePointerToken(frame.InternedKey.IsValid() ? frame.InternedKey.ToString() : frame.Key);
+		}
+		error.Keyword = keyword;
+		error.Message = message;
+
+		if (Schema.MaxErrors > 0 && Errors.Num() >= Schema.MaxErrors)
+			bStopped = true;
+	}
+
+	const UJsonSchema& Schema;
+	TArray<FJsonSchemaError>& Errors;
+	const int32 RootNode;
+	bool bStopped;
+	TArray<FFrame, TInlineAllocator<16>> Stack;
+	//arrays/objects being built to compare them with an enum, innermost last
+	TArray<TUniquePtr<FJsonBPValueBuilder>> Captures;
+};
+
+//reports everything read to both handlers, so text is built and validated in one pass
+template<typename FirstType, typename SecondType>
+struct TJsonBPTeeHandler
+{
+	TJsonBPTeeHandler(FirstType& first, SecondType& second) : First(first), Second(second) {}
+
+	bool OnNull() { return Both(First.OnNull(), Second.OnNull()); }
+	bool OnBoolean(bool value) { return Both(First.OnBoolean(value), Second.OnBoolean(value)); }
+	bool OnNumber(double value) { return Both(First.OnNumber(value), Second.OnNumber(value)); }
+	bool OnInteger(int64 value) { return Both(First.OnInteger(value), Second.OnInteger(value)); }
+	bool OnString(const FString& value) { return Both(First.OnString(value), Second.OnString(value)); }
+	bool OnArrayBegin() { return Both(First.OnArrayBegin(), Second.OnArrayBegin()); }
+	bool OnArrayEnd() { return Both(First.OnArrayEnd(), Second.OnArrayEnd()); }
+	bool OnObjectBegin() { return Both(First.OnObjectBegin(), Second.OnObjectBegin()); }
+	bool OnObjectKey(const FString& key) { return Both(First.OnObjectKey(key), Second.OnObjectKey(key)); }
+	bool OnObjectEnd() { return Both(First.OnObjectEnd(), Second.OnObjectEnd()); }
+
+private:
+	//both calls are made before this, neither handler misses a value
+	static bool Both(bool bFirst, bool bSecond) { return bFirst && bSecond; }
+
+	FirstType& First;
+	SecondType& Second;
+};
+
+
+
+UJsonSchema* UJsonSchema::CompileSchema(const UJsonValue* schema, FString& outError)
+{
+	outError.Reset();
+	if (!schema)
+	{
+		outError = TEXT("schema is null");
+		return nullptr;
+	}
+
+	UJsonSchema* pSchema = NewObject<UJsonSchema>();
+	if (pSchema->CompileNode(schema, FString(), outError) == INDEX_NONE)
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("CompileSchema failed: %s"), *outError);
+		return nullptr;
+	}
+
+	return pSchema;
+}
+
+UJsonSchema* UJsonSchema::CompileSchemaFromString(const FString& schema, FString& outError)
+{
+	const UJsonValue* pSchema = UJsonValue::MakeFromString(schema);
+	if (!pSchema)
+	{
+		outError = TEXT("schema is not valid json");
+		return nullptr;
+	}
+
+	return CompileSchema(pSchema, outError);
+}
+
+int32 UJsonSchema::CompileNode(const UJsonValue* schema, const FString& location, FString& outError)
+{
+	//the index is taken first so the root is 0, the node is filled in at the end
+	const int32 index = Nodes.AddDefaulted();
+	FJsonBPSchemaNode node;
+
+	auto fail = [&outError](const FString& at, const TCHAR* message)
+	{
+		outError = FString::Printf(TEXT("%s: %s"), at.IsEmpty() ? TEXT("/") : *at, message);
+		return INDEX_NONE;
+	};
+
+	if (schema && schema->JsonType == EJsonType::JSON_Boolean)
+	{
+		//true allows anything, false nothing
+		Nodes[index].bNever = !schema->ValueBool;
+		return index;
+	}
+	if (!schema || schema->JsonType != EJsonType::JSON_Object)
+		return fail(location, TEXT("a schema must be an object or a boolean"));
+
+	schema->Expand();
+	for (const auto& pair : schema->ValueObject)
+	{
+		const FString& keyword = pair.Key.ToString();
+		const FString at = location + TEXT("/") + JsonBPEscapePointerToken(keyword);
+		const UJsonValue* pValue = pair.Value;
+		const EJsonType type = pValue ? pValue->JsonType : EJsonType::JSON_Null;
+		auto is = [&keyword](const TCHAR* name) { return keyword.Equals(name, ESearchCase::CaseSensitive); };
+
+		if (is(TEXT("type")))
+		{
+			if (type == EJsonType::JSON_String)
+			{
+				node.Types = JsonBPSchemaTypeFromName(pValue->ValueString);
+			}
+			else if (type == EJsonType::JSON_Array)
+			{
+				pValue->Expand();
+				for (const UJsonValue* pName : pValue->ValueArray)
+				{
+					const uint8 bits = pName && pName->JsonType == EJsonType::JSON_String ? JsonBPSchemaTypeFromName(pName->ValueString) : 0;
+					if (bits == 0)
+						return fail(at, TEXT("unknown type"));
+					node.Types |= bits;
+				}
+			}
+			if (node.Types == 0)
+				return fail(at, TEXT("unknown type"));
+		}
+		else if (is(TEXT("enum")) || is(TEXT("const")))
+		{
+			const bool bConst = is(TEXT("const"));
+			if (!bConst && type != EJsonType::JSON_Array)
+				return fail(at, TEXT("enum must be an array"));
+
+			TArray<const UJsonValue*, TInlineAllocator<1>> values;
+			if (bConst)
+			{
+				values.Add(pValue);
+			}
+			else
+			{
+				pValue->Expand();
+				for (const UJsonValue* pAllowed : pValue->ValueArray)
+					values.Add(pAllowed);
+			}
+
+			node.bHasEnum = true;
+			node.EnumFirst = EnumValues.Num();
+			node.EnumCount = values.Num();
+			for (const UJsonValue* pAllowed : values)
+			{
+				//copied so changing the schema value later doesn't change the compiled schema
+				UJsonValue* pCopy = pAllowed ? pAllowed->DeepCopy() : UJsonValue::MakeNull();
+				node.bEnumHasContainers |= pCopy->JsonType == EJsonType::JSON_Array || pCopy->JsonType == EJsonType::JSON_Object;
+				EnumValues.Add(pCopy);
+			}
+		}
+		else if (is(TEXT("minimum")) || is(TEXT("maximum")) || is(TEXT("exclusiveMinimum")) || is(TEXT("exclusiveMaximum")))
+		{
+			double number;
+			if (!pValue || !pValue->GetValueAsDouble(number))
+				return fail(at, TEXT("must be a number"));
+
+			TOptional<double>& limit = is(TEXT("minimum")) ? node.Minimum : is(TEXT("maximum")) ? node.Maximum
+				: is(TEXT("exclusiveMinimum")) ? node.ExclusiveMinimum : node.ExclusiveMaximum;
+			limit = number;
+		}
+		else if (is(TEXT("minLength")) || is(TEXT("maxLength")) || is(TEXT("minItems")) || is(TEXT("maxItems")) || is(TEXT("minProperties")) || is(TEXT("maxProperties")))
+		{
+			int32& count = is(TEXT("minLength")) ? node.MinLength : is(TEXT("maxLength")) ? node.MaxLength
+				: is(TEXT("minItems")) ? node.MinItems : is(TEXT("maxItems")) ? node.MaxItems
+				: is(TEXT("minProperties")) ? node.MinProperties : node.MaxProperties;
+			if (!JsonBPSchemaCount(pValue, count))
+				return fail(at, TEXT("must be a non negative integer"));
+		}
+		else if (is(TEXT("pattern")))
+		{
+			if (type != EJsonType::JSON_String)
+				return fail(at, TEXT("must be a string"));
+
+			node.Pattern = Patterns.Emplace(pValue->ValueString);
+		}
+		else if (is(TEXT("items")))
+		{
+			if (type == EJsonType::JSON_Array)
+				return fail(at, TEXT("an array of schemas (tuple) is not supported, use one schema for all elements"));
+
+			node.Items = CompileNode(pValue, at, outError);
+			if (node.Items == INDEX_NONE)
+				return INDEX_NONE;
+		}
+		else if (is(TEXT("properties")))
+		{
+			if (type != EJsonType::JSON_Object)
+				return fail(at, TEXT("must be an object"));
+
+			pValue->Expand();
+			for (const auto& property : pValue->ValueObject)
+			{
+				const int32 child = CompileNode(property.Value, at + TEXT("/") + JsonBPEscapePointerToken(property.Key.ToString()), outError);
+				if (child == INDEX_NONE)
+					return INDEX_NONE;
+				node.Properties.FindOrAdd(property.Key).Node = child;
+			}
+		}
+		else if (is(TEXT("additionalProperties")))
+		{
+			if (type == EJsonType::JSON_Boolean)
+			{
+				node.bNoAdditionalProperties = !pValue->ValueBool;
+			}
+			else
+			{
+				node.AdditionalProperties = CompileNode(pValue, at, outError);
+				if (node.AdditionalProperties == INDEX_NONE)
+					return INDEX_NONE;
+			}
+		}
+		else if (is(TEXT("required")))
+		{
+			if (type != EJsonType::JSON_Array)
+				return fail(at, TEXT("must be an array of strings"));
+
+			pValue->Expand();
+			for (const UJsonValue* pName : pValue->ValueArray)
+			{
+				if (!pName || pName->JsonType != EJsonType::JSON_String)
+					return fail(at, TEXT("must be an array of strings"));
+
+				const FJsonBPKey key(pName->ValueString);
+				FJsonBPSchemaProperty& property = node.Properties.FindOrAdd(key);
+				if (property.RequiredIndex == INDEX_NONE)
+					property.RequiredIndex = node.Required.Add(key);
+			}
+		}
+		//anything else ($schema, title, description, keywords that aren't supported) is ignored
+	}
+
+	Nodes[index] = MoveTemp(node);
+	return index;
+}
+
+bool UJsonSchema::Validate(const UJsonValue* value, TArray<FJsonSchemaError>& outErrors) const
+{
+	outErrors.Reset();
+	FJsonBPSchemaValidator validator(*this, outErrors);
+	validator.ValidateValue(value);
+	return outErrors.Num() == 0;
+}
+
+template<typename CharType> bool UJsonSchema::ValidateText(const CharType* text, int32 length, TArray<FJsonSchemaError>& outErrors) const
+{
+	outErrors.Reset();
+	TJsonBPReader<CharType> reader(text, length);
+	FJsonBPSchemaValidator validator(*this, outErrors);
+	if (!reader.ReadDocument(validator) && !validator.IsStopped())
+	{
+		FJsonSchemaError& error = outErrors.AddDefaulted_GetRef();
+		error.Keyword = TEXT("json");
+		error.Message = reader.GetErrorText();
+	}
+
+	return outErrors.Num() == 0;
+}
+
+bool UJsonSchema::ValidateString(const FString& text, TArray<FJsonSchemaError>& outErrors) const
+{
+	return ValidateText(*text, text.Len(), outErrors);
+}
+
+bool UJsonSchema::ValidateUTF8(const ANSICHAR* text, int32 length, TArray<FJsonSchemaError>& outErrors) const
+{
+	return ValidateText(text, length, outErrors);
+}
+
+template<typename CharType> UJsonValue* UJsonSchema::ParseValidatedText(const CharType* text, int32 length, TArray<FJsonSchemaError>& outErrors) const
+{
+	outErrors.Reset();
+	TJsonBPReader<CharType> reader(text, length);
+	FJsonBPValueBuilder builder;
+	FJsonBPSchemaValidator validator(*this, outErrors);
+	TJsonBPTeeHandler<FJsonBPValueBuilder, FJsonBPSchemaValidator> handler(builder, validator);
+	if (!reader.ReadDocument(handler) && !validator.IsStopped())
+	{
+		FJsonSchemaError& error = outErrors.AddDefaulted_GetRef();
+		error.Keyword = TEXT("json");
+		error.Message = reader.GetErrorText();
+	}
+
+	if (outErrors.Num() > 0)
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("ParseValidated failed: %s %s"), *outErrors[0].Location, *outErrors[0].Message);
+		return nullptr;
+	}
+
+	return builder.GetResult();
+}
+
+UJsonValue* UJsonSchema::ParseValidated(const FString& text, TArray<FJsonSchemaError>& outErrors) const
+{
+	return ParseValidatedText(*text, text.Len(), outErrors);
+}
+
+UJsonValue* UJsonSchema::ParseValidatedUTF8(const ANSICHAR* text, int32 length, TArray<FJsonSchemaError>& outErrors) const
+{
+	return ParseValidatedText(text, length, outErrors);
+}
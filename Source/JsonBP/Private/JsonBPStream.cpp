@@ -0,0 +1,210 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPStream.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPValueBuilder.h"
+#include "HAL/FileManager.h"
+
+
+FJsonBPArchiveSource::FJsonBPArchiveSource(FArchive& archive, int32 chunkSize)
+	: Archive(archive), ChunkSize(FMath::Max(chunkSize, 16)), NumCarry(0)
+{
+}
+
+bool FJsonBPArchiveSource::Read(const ANSICHAR*& outChunk, int32& outLength)
+{
+	const int64 remaining = Archive.IsError() ? 0 : Archive.TotalSize() - Archive.Tell();
+	if (remaining <= 0)
+	{
+		if (NumCarry == 0)
+			return false;
+
+		//the file ends with a truncated sequence, hand it out as it is
+		Buffer.SetNumUninitialized(NumCarry, false);
+		FMemory::Memcpy(Buffer.GetData(), Carry, NumCarry);
+		outChunk = Buffer.GetData();
+		outLength = NumCarry;
+		NumCarry = 0;
+		return true;
+	}
+
+	const int32 numToRead = (int32)FMath::Min<int64>(ChunkSize, remaining);
+	Buffer.SetNumUninitialized(NumCarry + numToRead, false);
+	FMemory::Memcpy(Buffer.GetData(), Carry, NumCarry);
+	Archive.Serialize(Buffer.GetData() + NumCarry, numToRead);
+
+	int32 length = NumCarry + numToRead;
+	NumCarry = 0;
+
+	//keep an incomplete sequence at the end for the next chunk
+	if (numToRead < remaining)
+	{
+		int32 lead = length - 1;
+		while (lead > 0 && length - lead < 4 && ((uint8)Buffer[lead] & 0xC0) == 0x80)
+			--lead;
+
+		const uint8 c = (uint8)Buffer[lead];
+		const int32 sequenceLength = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+		if (lead + sequenceLength > length)
+		{
+			NumCarry = length - lead;
+			FMemory::Memcpy(Carry, Buffer.GetData() + lead, NumCarry);
+			length = lead;
+		}
+	}
+
+	outChunk = Buffer.GetData();
+	outLength = length;
+	return true;
+}
+
+//moves the reader to the next record. bHasRecord is false at the end of the input
+static bool JsonBPNextRecord(TJsonBPReader<ANSICHAR>& reader, EJsonStreamFormat format, bool& bStarted, bool& bHasRecord, FString& outError)
+{
+	bHasRecord = false;
+
+	if (format == EJsonStreamFormat::JSON_NDJSON)
+	{
+		if (!reader.NextValue(bHasRecord))
+		{
+			outError = reader.GetErrorText();
+			return false;
+		}
+		return true;
+	}
+
+	if (!bStarted)
+	{
+		bStarted = true;
+		if (!reader.BeginArrayStream())
+		{
+			outError = reader.GetErrorText();
+			return false;
+		}
+	}
+
+	if (!reader.NextArrayElement(bHasRecord))
+	{
+		outError = reader.GetErrorText();
+		return false;
+	}
+
+	if (!bHasRecord)
+	{
+		bool bTrailing = false;
+		reader.NextValue(bTrailing);
+		if (bTrailing)
+		{
+			outError = TEXT("unexpected characters after the array");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool HelperReadJSONEvents(IJsonBPInputSource<ANSICHAR>& source, IJsonBPEventHandler& handler, EJsonStreamFormat format, FString* outError)
+{
+	TJsonBPReader<ANSICHAR> reader(source);
+	bool bStarted = false;
+	FString error;
+
+	for (;;)
+	{
+		bool bHasRecord;
+		if (!JsonBPNextRecord(reader, format, bStarted, bHasRecord, error))
+			break;
+
+		if (!bHasRecord)
+			return true;
+
+		if (!reader.ReadValue(handler))
+		{
+			error = reader.GetErrorText();
+			break;
+		}
+
+		if (!handler.OnRecordEnd())
+		{
+			error = TEXT("stopped by handler");
+			break;
+		}
+	}
+
+	if (outError)
+		*outError = error;
+	return false;
+}
+
+bool HelperReadJSONFileEvents(const FString& filePath, IJsonBPEventHandler& handler, EJsonStreamFormat format, FString* outError)
+{
+	TUniquePtr<FArchive> archive(IFileManager::Get().CreateFileReader(*filePath));
+	if (!archive)
+	{
+		if (outError)
+			*outError = FString::Printf(TEXT("failed to open %s"), *filePath);
+		return false;
+	}
+
+	FJsonBPArchiveSource source(*archive);
+	return HelperReadJSONEvents(source, handler, format, outError);
+}
+
+
+
+UJsonStreamReader* UJsonStreamReader::OpenJsonStream(const FString& filePath, EJsonStreamFormat format)
+{
+	TUniquePtr<FArchive> archive(IFileManager::Get().CreateFileReader(*filePath));
+	if (!archive)
+	{
+		UE_LOG(LogJsonBP, Warning, TEXT("OpenJsonStream failed to open %s"), *filePath);
+		return nullptr;
+	}
+
+	UJsonStreamReader* pStream = NewObject<UJsonStreamReader>();
+	pStream->Format = format;
+	pStream->Archive = MoveTemp(archive);
+	pStream->Source = MakeUnique<FJsonBPArchiveSource>(*pStream->Archive);
+	pStream->Reader = MakeUnique<TJsonBPReader<ANSICHAR>>(*pStream->Source);
+	return pStream;
+}
+
+bool UJsonStreamReader::ReadNext(UJsonValue*& value)
+{
+	value = nullptr;
+	if (!Reader || bFinished)
+		return false;
+
+	bool bHasRecord;
+	if (!JsonBPNextRecord(*Reader, Format, bStarted, bHasRecord, Error) || !bHasRecord)
+	{
+		bFinished = true;
+		return false;
+	}
+
+	FJsonBPValueBuilder builder;
+	if (!Reader->ReadValue(builder))
+	{
+		Error = Reader->GetErrorText();
+		bFinished = true;
+		return false;
+	}
+
+	value = builder.GetResult();
+	return true;
+}
+
+void UJsonStreamReader::Close()
+{
+	//the reader uses the source which uses the archive
+	Reader.Reset();
+	Source.Reset();
+	Archive.Reset();
+	bFinished = true;
+}
+
+void UJsonStreamReader::BeginDestroy()
+{
+	Close();
+	Super::BeginDestroy();
+}
@@ -0,0 +1,857 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBPStruct.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPValueBuilder.h"
+#include "JsonBPWriter.h"
+#include "JsonBPDocument.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/SoftObjectPtr.h"
+
+static const EPropertyFlags JsonBPSkippedPropertyFlags = CPF_Transient | CPF_Deprecated;
+
+struct FJsonBPPlanCache
+{
+	FRWLock Lock;
+	TMap<const UStruct*, TUniquePtr<FJsonBPStructPlan>> Plans;
+	//plans dropped from the map, another thread may still be using them
+	TArray<TUniquePtr<FJsonBPStructPlan>> Retired;
+};
+
+static FJsonBPPlanCache& GetJsonBPPlanCache()
+{
+	static FJsonBPPlanCache cache;
+	return cache;
+}
+
+//a plan is stale once its struct is gone or its properties were regenerated (hot reload, user defined struct recompile)
+static bool IsStructPlanValid(const FJsonBPStructPlan& plan, const UStruct* structType)
+{
+	return plan.Struct.Get() == structType && plan.PropertiesSize == structType->GetPropertiesSize();
+}
+
+static const FJsonBPStructPlan* FindOrBuildStructPlan(FJsonBPPlanCache& cache, const UStruct* structType);
+
+static void BuildPropertyPlan(FJsonBPPlanCache& cache, const FProperty* pProperty, FJsonBPPropertyPlan& plan)
+{
+	plan.Property = pProperty;
+
+	if (pProperty->IsA<FBoolProperty>())
+	{
+		plan.Kind = EJsonBPPropertyKind::Bool;
+	}
+	else if (pProperty->IsA<FIntProperty>())
+	{
+		plan.Kind = EJsonBPPropertyKind::Int32;
+	}
+	else if (pProperty->IsA<FFloatProperty>())
+	{
+		plan.Kind = EJsonBPPropertyKind::Float;
+	}
+	else if (const FEnumProperty* pEnumProperty = CastField<FEnumProperty>(pProperty))
+	{
+		plan.Kind = EJsonBPPropertyKind::Enum;
+		plan.Enum = pEnumProperty->GetEnum();
+	}
+	else if (pProperty->IsA<FNumericProperty>())
+	{
+		const FByteProperty* pByteProperty = CastField<FByteProperty>(pProperty);
+		plan.Enum = pByteProperty ? pByteProperty->Enum : nullptr;
+		plan.Kind = plan.Enum ? EJsonBPPropertyKind::Enum : EJsonBPPropertyKind::Numeric;
+	}
+	else if (pProperty->IsA<FStrProperty>())
+	{
+		plan.Kind = EJsonBPPropertyKind::String;
+	}
+	else if (pProperty->IsA<FNameProperty>())
+	{
+		plan.Kind = EJsonBPPropertyKind::Name;
+	}
+	else if (pProperty->IsA<FTextProperty>())
+	{
+		plan.Kind = EJsonBPPropertyKind::Text;
+	}
+	else if (const FStructProperty* pStructProperty = CastField<FStructProperty>(pProperty))
+	{
+		plan.Kind = EJsonBPPropertyKind::Struct;
+		plan.Struct = FindOrBuildStructPlan(cache, pStructProperty->Struct);
+	}
+	else if (pProperty->IsA<FSoftObjectProperty>())
+	{
+		//checked before FObjectPropertyBase, soft references derive from it
+		plan.Kind = EJsonBPPropertyKind::SoftObject;
+	}
+	else if (pProperty->IsA<FObjectPropertyBase>())
+	{
+		plan.Kind = EJsonBPPropertyKind::Object;
+	}
+	else if (const FArrayProperty* pArrayProperty = CastField<FArrayProperty>(pProperty))
+	{
+		plan.Kind = EJsonBPPropertyKind::Array;
+		plan.Inner = MakeUnique<FJsonBPPropertyPlan>();
+		BuildPropertyPlan(cache, pArrayProperty->Inner, *plan.Inner);
+	}
+	else if (const FSetProperty* pSetProperty = CastField<FSetProperty>(pProperty))
+	{
+		plan.Kind = EJsonBPPropertyKind::Set;
+		plan.Inner = MakeUnique<FJsonBPPropertyPlan>();
+		BuildPropertyPlan(cache, pSetProperty->ElementProp, *plan.Inner);
+	}
+	else if (const FMapProperty* pMapProperty = CastField<FMapProperty>(pProperty))
+	{
+		plan.Kind = EJsonBPPropertyKind::Map;
+		plan.Inner = MakeUnique<FJsonBPPropertyPlan>();
+		plan.Value = MakeUnique<FJsonBPPropertyPlan>();
+		BuildPropertyPlan(cache, pMapProperty->KeyProp, *plan.Inner);
+		BuildPropertyPlan(cache, pMapProperty->ValueProp, *plan.Value);
+	}
+	else
+	{
+		plan.Kind = EJsonBPPropertyKind::Other;
+	}
+}
+
+//cache.Lock must be write locked
+static const FJsonBPStructPlan* FindOrBuildStructPlan(FJsonBPPlanCache& cache, const UStruct* structType)
+{
+	if (TUniquePtr<FJsonBPStructPlan>* ppExisting = cache.Plans.Find(structType))
+	{
+		if (IsStructPlanValid(**ppExisting, structType))
+			return ppExisting->Get();
+
+		//plans point to each other, drop all of them so nothing refers to the stale one
+		for (auto& pair : cache.Plans)
+			cache.Retired.Add(MoveTemp(pair.Value));
+		cache.Plans.Reset();
+	}
+
+	//added before the properties so structs containing arrays of themselves find it
+	FJsonBPStructPlan* pPlan = new FJsonBPStructPlan();
+	cache.Plans.Add(structType, TUniquePtr<FJsonBPStructPlan>(pPlan));
+	pPlan->Struct = structType;
+	pPlan->PropertiesSize = structType->GetPropertiesSize();
+
+	for (TFieldIterator<FProperty> it(structType); it; ++it)
+	{
+		const FProperty* pProperty = *it;
+		if (pProperty->HasAnyPropertyFlags(JsonBPSkippedPropertyFlags) || pProperty->IsA<FDelegateProperty>() || pProperty->IsA<FMulticastDelegateProperty>())
+			continue;
+
+		FJsonBPPropertyPlan& propertyPlan = pPlan->Properties.AddDefaulted_GetRef();
+		//authored name, user defined structs add a suffix to the property names
+		propertyPlan.Key = pProperty->GetAuthoredName();
+		propertyPlan.InternedKey = FJsonBPKey(propertyPlan.Key);
+		BuildPropertyPlan(cache, pProperty, propertyPlan);
+	}
+
+	return pPlan;
+}
+
+const FJsonBPStructPlan* FJsonBPStructPlan::Get(const UStruct* structType)
+{
+	if (!structType)
+		return nullptr;
+
+	FJsonBPPlanCache& cache = GetJsonBPPlanCache();
+	{
+		FRWScopeLock lock(cache.Lock, SLT_ReadOnly);
+		const TUniquePtr<FJsonBPStructPlan>* ppPlan = cache.Plans.Find(structType);
+		if (ppPlan && IsStructPlanValid(**ppPlan, structType))
+			return ppPlan->Get();
+	}
+
+	FRWScopeLock lock(cache.Lock, SLT_Write);
+	return FindOrBuildStructPlan(cache, structType);
+}
+
+void FJsonBPStructPlan::ClearCache()
+{
+	FJsonBPPlanCache& cache = GetJsonBPPlanCache();
+	FRWScopeLock lock(cache.Lock, SLT_Write);
+	for (auto& pair : cache.Plans)
+		cache.Retired.Add(MoveTemp(pair.Value));
+	cache.Plans.Reset();
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//writing, HandlerType receives the same events as a TJsonBPReader handler
+
+static FString JsonBPKeyToString(const FJsonBPPropertyPlan& plan, const void* pKey)
+{
+	if (plan.Kind == EJsonBPPropertyKind::String)
+		return *(const FString*)pKey;
+	if (plan.Kind == EJsonBPPropertyKind::Name)
+		return ((const FName*)pKey)->ToString();
+
+	FString text;
+	plan.Property->ExportTextItem(text, pKey, nullptr, nullptr, PPF_None);
+	return text;
+}
+
+static const FNumericProperty* JsonBPGetEnumUnderlyingProperty(const FJsonBPPropertyPlan& plan)
+{
+	const FEnumProperty* pEnumProperty = CastField<FEnumProperty>(plan.Property);
+	return pEnumProperty ? pEnumProperty->GetUnderlyingProperty() : static_cast<const FNumericProperty*>(plan.Property);
+}
+
+template<typename HandlerType> static void WriteStructPlan(HandlerType& handler, const FJsonBPStructPlan& plan, const void* pData);
+
+template<typename HandlerType> static void WritePropertyValue(HandlerType& handler, const FJsonBPPropertyPlan& plan, const void* pValue)
+{
+	switch (plan.Kind)
+	{
+	case EJsonBPPropertyKind::Bool:
+		handler.OnBoolean(static_cast<const FBoolProperty*>(plan.Property)->GetPropertyValue(pValue));
+		break;
+
+	case EJsonBPPropertyKind::Int32:
+		handler.OnInteger(*(const int32*)pValue);
+		break;
+
+	case EJsonBPPropertyKind::Float:
+		handler.OnNumber(JsonBPFloatToDouble(*(const float*)pValue));
+		break;
+
+	case EJsonBPPropertyKind::Numeric:
+	{
+		const FNumericProperty* pNumeric = static_cast<const FNumericProperty*>(plan.Property);
+		if (pNumeric->IsFloatingPoint())
+			handler.OnNumber(pNumeric->GetFloatingPointPropertyValue(pValue));
+		else
+			handler.OnInteger(pNumeric->GetSignedIntPropertyValue(pValue));
+		break;
+	}
+
+	case EJsonBPPropertyKind::Enum:
+	{
+		const int64 value = JsonBPGetEnumUnderlyingProperty(plan)->GetSignedIntPropertyValue(pValue);
+		const FString name = plan.Enum->GetNameStringByValue(value);
+		//values without a name are written as numbers
+		if (name.IsEmpty())
+			handler.OnInteger(value);
+		else
+			handler.OnString(name);
+		break;
+	}
+
+	case EJsonBPPropertyKind::String:
+		handler.OnString(*(const FString*)pValue);
+		break;
+
+	case EJsonBPPropertyKind::Name:
+		handler.OnString(((const FName*)pValue)->ToString());
+		break;
+
+	case EJsonBPPropertyKind::Text:
+		handler.OnString(((const FText*)pValue)->ToString());
+		break;
+
+	case EJsonBPPropertyKind::Struct:
+		WriteStructPlan(handler, *plan.Struct, pValue);
+		break;
+
+	case EJsonBPPropertyKind::Object:
+	{
+		const UObject* pObject = static_cast<const FObjectPropertyBase*>(plan.Property)->GetObjectPropertyValue(pValue);
+		if (pObject)
+			handler.OnString(pObject->GetPathName());
+		else
+			handler.OnNull();
+		break;
+	}
+
+	case EJsonBPPropertyKind::SoftObject:
+	{
+		const FSoftObjectPath& path = ((const FSoftObjectPtr*)pValue)->ToSoftObjectPath();
+		if (path.IsNull())
+			handler.OnNull();
+		else
+			handler.OnString(path.ToString());
+		break;
+	}
+
+	case EJsonBPPropertyKind::Array:
+	{
+		FScriptArrayHelper helper(static_cast<const FArrayProperty*>(plan.Property), pValue);
+		handler.OnArrayBegin();
+		for (int32 i = 0; i < helper.Num(); i++)
+			WritePropertyValue(handler, *plan.Inner, helper.GetRawPtr(i));
+		handler.OnArrayEnd();
+		break;
+	}
+
+	case EJsonBPPropertyKind::Set:
+	{
+		FScriptSetHelper helper(static_cast<const FSetProperty*>(plan.Property), pValue);
+		handler.OnArrayBegin();
+		for (int32 i = 0; i < helper.GetMaxIndex(); i++)
+		{
+			if (helper.IsValidIndex(i))
+				WritePropertyValue(handler, *plan.Inner, helper.GetElementPtr(i));
+		}
+		handler.OnArrayEnd();
+		break;
+	}
+
+	case EJsonBPPropertyKind::Map:
+	{
+		FScriptMapHelper helper(static_cast<const FMapProperty*>(plan.Property), pValue);
+		handler.OnObjectBegin();
+		for (int32 i = 0; i < helper.GetMaxIndex(); i++)
+		{
+			if (!helper.IsValidIndex(i))
+				continue;
+
+			handler.OnObjectKey(JsonBPKeyToString(*plan.Inner, helper.GetKeyPtr(i)));
+			WritePropertyValue(handler, *plan.Value, helper.GetValuePtr(i));
+		}
+		handler.OnObjectEnd();
+		break;
+	}
+
+	case EJsonBPPropertyKind::Other:
+	{
+		FString text;
+		plan.Property->ExportTextItem(text, pValue, nullptr, nullptr, PPF_None);
+		handler.OnString(text);
+		break;
+	}
+	}
+}
+
+template<typename HandlerType> static void WriteStructPlan(HandlerType& handler, const FJsonBPStructPlan& plan, const void* pData)
+{
+	handler.OnObjectBegin();
+	for (const FJsonBPPropertyPlan& property : plan.Properties)
+	{
+		handler.OnObjectKey(property.Key);
+
+		//static arrays are written as json arrays
+		const int32 arrayDim = property.Property->ArrayDim;
+		if (arrayDim == 1)
+		{
+			WritePropertyValue(handler, property, property.Property->ContainerPtrToValuePtr<void>(pData));
+			continue;
+		}
+
+		handler.OnArrayBegin();
+		for (int32 i = 0; i < arrayDim; i++)
+			WritePropertyValue(handler, property, property.Property->ContainerPtrToValuePtr<void>(pData, i));
+		handler.OnArrayEnd();
+	}
+	handler.OnObjectEnd();
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//reading, AccessorType gives the same view of a UJsonValue tree and of a FJsonBPDocumentData
+
+struct FJsonBPValueAccessor
+{
+	typedef const UJsonValue* FHandle;
+
+	EJsonType GetType(FHandle value) const { return value ? value->JsonType : EJsonType::JSON_None; }
+	bool GetBoolean(FHandle value) const { return value->ValueBool; }
+	double GetNumber(FHandle value) const { return value->ValueNumber; }
+	int64 GetInteger(FHandle value) const { return value->bIntegerNumber ? value->ValueInteger : JsonBPDoubleToInt64(value->ValueNumber); }
+	const TCHAR* GetString(FHandle value, int32& outLength) const
+	{
+		outLength = value->ValueString.Len();
+		return *value->ValueString;
+	}
+	int32 Num(FHandle value) const { value->Expand(); return value->JsonType == EJsonType::JSON_Array ? value->ValueArray.Num() : value->ValueObject.Num(); }
+	FHandle GetElement(FHandle value, int32 index) const { value->Expand(); return value->ValueArray[index]; }
+	FHandle FindField(FHandle value, const FJsonBPPropertyPlan& property, int32& ioHint) const { value->Expand(); return value->ValueObject.FindRef(property.InternedKey); }
+	template<typename FuncType> void ForEachField(FHandle value, FuncType func) const
+	{
+		value->Expand();
+		for (const auto& pair : value->ValueObject)
+			func(pair.Key.ToString(), (FHandle)pair.Value);
+	}
+};
+
+struct FJsonBPDocumentAccessor
+{
+	typedef int32 FHandle;
+
+	explicit FJsonBPDocumentAccessor(const FJsonBPDocumentData& data) : Data(data) {}
+
+	EJsonType GetType(FHandle index) const { return Data.GetType(index); }
+	bool GetBoolean(FHandle index) const { return Data.Nodes[index].Bool; }
+	double GetNumber(FHandle index) const { return Data.GetNumber(index); }
+	int64 GetInteger(FHandle index) const { return Data.GetInteger(index); }
+	const TCHAR* GetString(FHandle index, int32& outLength) const
+	{
+		const FJsonBPDocumentData::FRange& range = Data.Nodes[index].Range;
+		outLength = range.Count;
+		return Data.Strings.GetData() + range.First;
+	}
+	int32 Num(FHandle index) const { return Data.Nodes[index].Range.Count; }
+	FHandle GetElement(FHandle index, int32 element) const { return Data.Nodes[index].Range.First + element; }
+	FHandle FindField(FHandle index, const FJsonBPPropertyPlan& property, int32& ioHint) const
+	{
+		const FString& key = property.Key;
+		//fields usually come in the order they were written, try the one after the last match first
+		const FJsonBPDocumentData::FRange& children = Data.Nodes[index].Range;
+		//with repeated keys the one after the last match may not be the last of its key
+		if (ioHint < children.Count && !Data.Nodes[index].bDuplicateKeys)
+		{
+			const FJsonBPDocumentData::FRange& childKey = Data.Nodes[children.First + ioHint].Key;
+			if (childKey.Count == key.Len() && FMemory::Memcmp(Data.Strings.GetData() + childKey.First, *key, childKey.Count * sizeof(TCHAR)) == 0)
+				return children.First + ioHint++;
+		}
+
+		const int32 child = Data.FindField(index, key);
+		if (child != INDEX_NONE)
+			ioHint = child - children.First + 1;
+		return child;
+	}
+	template<typename FuncType> void ForEachField(FHandle index, FuncType func) const
+	{
+		const FJsonBPDocumentData::FRange& children = Data.Nodes[index].Range;
+		for (int32 i = children.First; i < children.First + children.Count; i++)
+			func(Data.GetKey(i), i);
+	}
+
+	const FJsonBPDocumentData& Data;
+};
+
+//a default constructed value of a property, for building set elements and map pairs
+struct FJsonBPTempValue
+{
+	explicit FJsonBPTempValue(const FProperty* pProperty)
+		: Property(pProperty)
+	{
+		Data = FMemory::Malloc(Property->GetSize(), Property->GetMinAlignment());
+		Property->InitializeValue(Data);
+	}
+	~FJsonBPTempValue()
+	{
+		Property->DestroyValue(Data);
+		FMemory::Free(Data);
+	}
+	void Reset()
+	{
+		Property->DestroyValue(Data);
+		Property->InitializeValue(Data);
+	}
+
+	const FProperty* Property;
+	void* Data;
+};
+
+static bool JsonBPStringToKey(const FJsonBPPropertyPlan& plan, const FString& key, void* pKey)
+{
+	if (plan.Kind == EJsonBPPropertyKind::String)
+	{
+		*(FString*)pKey = key;
+		return true;
+	}
+	if (plan.Kind == EJsonBPPropertyKind::Name)
+	{
+		*(FName*)pKey = FName(*key);
+		return true;
+	}
+
+	return plan.Property->ImportText(*key, pKey, PPF_None, nullptr) != nullptr;
+}
+
+template<typename AccessorType> static bool ReadStructPlan(const AccessorType& accessor, typename AccessorType::FHandle value, const FJsonBPStructPlan& plan, void* pData);
+
+template<typename AccessorType> static bool ReadPropertyValue(const AccessorType& accessor, typename AccessorType::FHandle value, const FJsonBPPropertyPlan& plan, void* pValue)
+{
+	const EJsonType type = accessor.GetType(value);
+
+	switch (plan.Kind)
+	{
+	case EJsonBPPropertyKind::Bool:
+		if (type != EJsonType::JSON_Boolean)
+			return false;
+		static_cast<const FBoolProperty*>(plan.Property)->SetPropertyValue(pValue, accessor.GetBoolean(value));
+		return true;
+
+	case EJsonBPPropertyKind::Int32:
+		if (type != EJsonType::JSON_Number)
+			return false;
+		*(int32*)pValue = (int32)FMath::Clamp<int64>(accessor.GetInteger(value), MIN_int32, MAX_int32);
+		return true;
+
+	case EJsonBPPropertyKind::Float:
+		if (type != EJsonType::JSON_Number)
+			return false;
+		*(float*)pValue = (float)accessor.GetNumber(value);
+		return true;
+
+	case EJsonBPPropertyKind::Numeric:
+	{
+		if (type != EJsonType::JSON_Number)
+			return false;
+
+		const FNumericProperty* pNumeric = static_cast<const FNumericProperty*>(plan.Property);
+		if (pNumeric->IsFloatingPoint())
+			pNumeric->SetFloatingPointPropertyValue(pValue, accessor.GetNumber(value));
+		else
+			pNumeric->SetIntPropertyValue(pValue, accessor.GetInteger(value));
+		return true;
+	}
+
+	case EJsonBPPropertyKind::Enum:
+	{
+		int64 enumValue;
+		if (type == EJsonType::JSON_String)
+		{
+			int32 length;
+			const TCHAR* pText = accessor.GetString(value, length);
+			enumValue = plan.Enum->GetValueByNameString(FString(length, pText));
+			if (enumValue == INDEX_NONE)
+				return false;
+		}
+		else if (type == EJsonType::JSON_Number)
+		{
+			enumValue = accessor.GetInteger(value);
+		}
+		else
+		{
+			return false;
+		}
+
+		JsonBPGetEnumUnderlyingProperty(plan)->SetIntPropertyValue(pValue, enumValue);
+		return true;
+	}
+
+	case EJsonBPPropertyKind::String:
+	{
+		if (type != EJsonType::JSON_String)
+			return false;
+
+		int32 length;
+		const TCHAR* pText = accessor.GetString(value, length);
+		//reuses the buffer of the existing string
+		FString& string = *(FString*)pValue;
+		string.Reset(length);
+		string.AppendChars(pText, length);
+		return true;
+	}
+
+	case EJsonBPPropertyKind::Name:
+	{
+		if (type != EJsonType::JSON_String)
+			return false;
+
+		int32 length;
+		const TCHAR* pText = accessor.GetString(value, length);
+		*(FName*)pValue = FName(length, pText);
+		return true;
+	}
+
+	case EJsonBPPropertyKind::Text:
+	{
+		if (type != EJsonType::JSON_String)
+			return false;
+
+		int32 length;
+		const TCHAR* pText = accessor.GetString(value, length);
+		*(FText*)pValue = FText::FromString(FString(length, pText));
+		return true;
+	}
+
+	case EJsonBPPropertyKind::Struct:
+		return ReadStructPlan(accessor, value, *plan.Struct, pValue);
+
+	case EJsonBPPropertyKind::Object:
+	{
+		const FObjectPropertyBase* pObjectProperty = static_cast<const FObjectPropertyBase*>(plan.Property);
+		if (type == EJsonType::JSON_Null)
+		{
+			pObjectProperty->SetObjectPropertyValue(pValue, nullptr);
+			return true;
+		}
+		if (type != EJsonType::JSON_String)
+			return false;
+
+		int32 length;
+		const TCHAR* pText = accessor.GetString(value, length);
+		UObject* pObject = StaticLoadObject(pObjectProperty->PropertyClass, nullptr, *FString(length, pText));
+		if (!pObject)
+			return false;
+
+		pObjectProperty->SetObjectPropertyValue(pValue, pObject);
+		return true;
+	}
+
+	case EJsonBPPropertyKind::SoftObject:
+	{
+		FSoftObjectPtr& softObject = *(FSoftObjectPtr*)pValue;
+		if (type == EJsonType::JSON_Null)
+		{
+			softObject.Reset();
+			return true;
+		}
+		if (type != EJsonType::JSON_String)
+			return false;
+
+		int32 length;
+		const TCHAR* pText = accessor.GetString(value, length);
+		softObject = FSoftObjectPath(FString(length, pText));
+		return true;
+	}
+
+	case EJsonBPPropertyKind::Array:
+	{
+		if (type != EJsonType::JSON_Array)
+			return false;
+
+		const int32 num = accessor.Num(value);
+		FScriptArrayHelper helper(static_cast<const FArrayProperty*>(plan.Property), pValue);
+		helper.EmptyValues(num);
+		helper.AddValues(num);
+
+		bool bSucceeded = true;
+		for (int32 i = 0; i < num; i++)
+		{
+			if (!ReadPropertyValue(accessor, accessor.GetElement(value, i), *plan.Inner, helper.GetRawPtr(i)))
+				bSucceeded = false;
+		}
+		return bSucceeded;
+	}
+
+	case EJsonBPPropertyKind::Set:
+	{
+		if (type != EJsonType::JSON_Array)
+			return false;
+
+		const int32 num = accessor.Num(value);
+		FScriptSetHelper helper(static_cast<const FSetProperty*>(plan.Property), pValue);
+		helper.EmptyElements(num);
+
+		//elements are read into a temporary so duplicates are merged by AddElement
+		FJsonBPTempValue element(plan.Inner->Property);
+		bool bSucceeded = true;
+		for (int32 i = 0; i < num; i++)
+		{
+			element.Reset();
+			if (ReadPropertyValue(accessor, accessor.GetElement(value, i), *plan.Inner, element.Data))
+				helper.AddElement(element.Data);
+			else
+				bSucceeded = false;
+		}
+		return bSucceeded;
+	}
+
+	case EJsonBPPropertyKind::Map:
+	{
+		if (type != EJsonType::JSON_Object)
+			return false;
+
+		FScriptMapHelper helper(static_cast<const FMapProperty*>(plan.Property), pValue);
+		helper.EmptyValues(accessor.Num(value));
+
+		FJsonBPTempValue pairKey(plan.Inner->Property);
+		FJsonBPTempValue pairValue(plan.Value->Property);
+		bool bSucceeded = true;
+		accessor.ForEachField(value, [&](const FString& key, typename AccessorType::FHandle field)
+		{
+			pairKey.Reset();
+			pairValue.Reset();
+			if (JsonBPStringToKey(*plan.Inner, key, pairKey.Data) && ReadPropertyValue(accessor, field, *plan.Value, pairValue.Data))
+				helper.AddPair(pairKey.Data, pairValue.Data);
+			else
+				bSucceeded = false;
+		});
+		return bSucceeded;
+	}
+
+	case EJsonBPPropertyKind::Other:
+	{
+		if (type != EJsonType::JSON_String)
+			return false;
+
+		int32 length;
+		const TCHAR* pText = accessor.GetString(value, length);
+		return plan.Property->ImportText(*FString(length, pText), pValue, PPF_None, nullptr) != nullptr;
+	}
+	}
+
+	return false;
+}
+
+template<typename AccessorType> static bool ReadStructPlan(const AccessorType& accessor, typename AccessorType::FHandle value, const FJsonBPStructPlan& plan, void* pData)
+{
+	if (accessor.GetType(value) != EJsonType::JSON_Object)
+		return false;
+
+	bool bSucceeded = true;
+	int32 hint = 0;
+	for (const FJsonBPPropertyPlan& property : plan.Properties)
+	{
+		const typename AccessorType::FHandle field = accessor.FindField(value, property, hint);
+		const EJsonType fieldType = accessor.GetType(field);
+		//missing fields keep their value, so do nulls unless the property is a reference
+		if (fieldType == EJsonType::JSON_None || (fieldType == EJsonType::JSON_Null && property.Kind != EJsonBPPropertyKind::Object && property.Kind != EJsonBPPropertyKind::SoftObject))
+			continue;
+
+		const int32 arrayDim = property.Property->ArrayDim;
+		if (arrayDim == 1)
+		{
+			if (!ReadPropertyValue(accessor, field, property, property.Property->ContainerPtrToValuePtr<void>(pData)))
+				bSucceeded = false;
+			continue;
+		}
+
+		if (fieldType != EJsonType::JSON_Array)
+		{
+			bSucceeded = false;
+			continue;
+		}
+
+		const int32 num = FMath::Min(accessor.Num(field), arrayDim);
+		for (int32 i = 0; i < num; i++)
+		{
+			if (!ReadPropertyValue(accessor, accessor.GetElement(field, i), property, property.Property->ContainerPtrToValuePtr<void>(pData, i)))
+				bSucceeded = false;
+		}
+	}
+
+	return bSucceeded;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+
+UJsonValue* HelperStructToJSONValue(const UStruct* structType, const void* data)
+{
+	JSONBP_SCOPE(StructConversion);
+	const FJsonBPStructPlan* pPlan = FJsonBPStructPlan::Get(structType);
+	if (!pPlan || !data)
+		return nullptr;
+
+	FJsonBPValueBuilder builder;
+	WriteStructPlan(builder, *pPlan, data);
+	return builder.GetResult();
+}
+
+bool HelperJSONValueToStruct(const UJsonValue* value, const UStruct* structType, void* outData)
+{
+	JSONBP_SCOPE(StructConversion);
+	const FJsonBPStructPlan* pPlan = FJsonBPStructPlan::Get(structType);
+	if (!pPlan || !outData)
+		return false;
+
+	return ReadStructPlan(FJsonBPValueAccessor(), value, *pPlan, outData);
+}
+
+FString HelperStructToJSONString(const UStruct* structType, const void* data, bool bPretty)
+{
+	const FJsonBPStructPlan* pPlan = FJsonBPStructPlan::Get(structType);
+	if (!pPlan || !data)
+		return FString();
+
+	JSONBP_SCOPE(StructConversion);
+	FString result;
+	TArray<TCHAR>& chars = result.GetCharArray();
+	TJsonBPWriter<TCHAR> writer(chars, bPretty);
+	TJsonBPWriterHandler<TCHAR> handler(writer);
+	WriteStructPlan(handler, *pPlan, data);
+	JSONBP_COUNT(BytesEmitted, chars.Num() * sizeof(TCHAR));
+	chars.Add(TEXT('\0'));
+
+	return result;
+}
+
+void HelperStructToJSONUTF8(const UStruct* structType, const void* data, TArray<ANSICHAR>& out, bool bPretty)
+{
+	out.Reset();
+
+	const FJsonBPStructPlan* pPlan = FJsonBPStructPlan::Get(structType);
+	if (!pPlan || !data)
+		return;
+
+	JSONBP_SCOPE(StructConversion);
+	TJsonBPWriter<ANSICHAR> writer(out, bPretty);
+	TJsonBPWriterHandler<ANSICHAR> handler(writer);
+	WriteStructPlan(handler, *pPlan, data);
+	JSONBP_COUNT(BytesEmitted, out.Num());
+}
+
+template<typename CharType> static bool JsonBPTextToStruct(const CharType* text, int32 length, const UStruct* structType, void* outData)
+{
+	const FJsonBPStructPlan* pPlan = FJsonBPStructPlan::Get(structType);
+	if (!pPlan || !outData)
+		return false;
+
+	//the text is parsed into a document, no UObject is created. the document counts the bytes
+	JSONBP_SCOPE(StructConversion);
+	FJsonBPDocumentData data;
+	FString error;
+	const bool bParsed = sizeof(CharType) == 1 ? data.ParseUTF8((const ANSICHAR*)text, length, &error) : data.Parse((const TCHAR*)text, length, &error);
+	if (!bParsed)
+	{
+		UE_LOG(LogJsonBP, Verbose, TEXT("failed to parse json for %s: %s"), *structType->GetName(), *error);
+		return false;
+	}
+
+	return ReadStructPlan(FJsonBPDocumentAccessor(data), data.Root, *pPlan, outData);
+}
+
+bool HelperJSONStringToStruct(const FString& json, const UStruct* structType, void* outData)
+{
+	return JsonBPTextToStruct(*json, json.Len(), structType, outData);
+}
+
+bool HelperJSONUTF8ToStruct(const ANSICHAR* text, int32 length, const UStruct* structType, void* outData)
+{
+	return JsonBPTextToStruct(text, length, structType, outData);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//the struct nodes are CustomThunk, see the exec functions in JsonBPStruct.h
+
+UJsonValue* UJsonStructLibrary::StructToJsonValue(const int32& value)
+{
+	check(0);
+	return nullptr;
+}
+
+bool UJsonStructLibrary::JsonValueToStruct(UJsonValue* json, int32& value)
+{
+	check(0);
+	return false;
+}
+
+FString UJsonStructLibrary::StructToJsonString(const int32& value, bool bPretty)
+{
+	check(0);
+	return FString();
+}
+
+bool UJsonStructLibrary::JsonStringToStruct(const FString& json, int32& value)
+{
+	check(0);
+	return false;
+}
+
+UJsonValue* UJsonStructLibrary::ObjectToJsonValue(UObject* object)
+{
+	return object ? HelperStructToJSONValue(object->GetClass(), object) : nullptr;
+}
+
+bool UJsonStructLibrary::JsonValueToObject(UJsonValue* json, UObject* object)
+{
+	return object && HelperJSONValueToStruct(json, object->GetClass(), object);
+}
+
+FString UJsonStructLibrary::ObjectToJsonString(UObject* object, bool bPretty)
+{
+	return object ? HelperStructToJSONString(object->GetClass(), object, bPretty) : FString();
+}
+
+bool UJsonStructLibrary::JsonStringToObject(const FString& json, UObject* object)
+{
+	return object && HelperJSONStringToStruct(json, object->GetClass(), object);
+}
@@ -0,0 +1,170 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBP.h"
+#include "JsonBPPrivate.h"
+#include "JsonBPWriter.h"
+
+/*
+a value's text is valid only while the text of all its children is, so a change stops walking up at the first value
+that is already stale: everything above it is stale too. a container is only cached if each child reports its changes
+to it (Parent is that container), children added some other way just keep it from being cached.
+*/
+
+void UJsonValue::SetTextCacheEnabled(bool bEnable)
+{
+	if (bEnable == TextCache.IsValid())
+		return;
+
+	if (bEnable)
+	{
+		EnableTextCache(nullptr);
+		return;
+	}
+
+	//the text above this value (when it's part of a bigger cached tree) has it in it
+	InvalidateText();
+	TArray<UJsonValue*, TInlineAllocator<64>> pending;
+	pending.Add(this);
+	while (pending.Num() > 0)
+	{
+		UJsonValue* pValue = pending.Pop(false);
+		if (!pValue || !pValue->TextCache)
+			continue;
+
+		pValue->TextCache.Reset();
+		pending.Append(pValue->ValueArray);
+		for (const auto& pair : pValue->ValueObject)
+			pending.Add(pair.Value);
+	}
+}
+
+void UJsonValue::EnableTextCache(UJsonValue* parent)
+{
+	TextCache = MakeUnique<FJsonBPTextCache>();
+	TextCache->Parent = parent;
+	//children of a lazy container join when they are created
+	AttachChildrenToTextCache();
+}
+
+void UJsonValue::InvalidateTextCache()
+{
+	for (UJsonValue* pValue = this; pValue && pValue->TextCache && pValue->TextCache->bValid; pValue = pValue->TextCache->Parent.Get())
+	{
+		pValue->TextCache->bValid = false;
+		pValue->TextCache->Text.Reset();
+	}
+}
+
+void UJsonValue::AttachToTextCache(UJsonValue* child, const UJsonValue* previousParent)
+{
+	if (!TextCache)
+		return;
+
+	InvalidateText();
+	if (!child)
+		return;
+
+	if (!child->TextCache)
+	{
+		child->EnableTextCache(this);
+		return;
+	}
+
+	FJsonBPTextCache& childCache = *child->TextCache;
+	const UJsonValue* pParent = childCache.Parent.Get();
+	if (!pParent || pParent == previousParent)
+	{
+		childCache.Parent = this;
+	}
+	else if (pParent != this && !childCache.bMultiParent)
+	{
+		//the first container would keep text with this child in it that no change reaches anymore
+		childCache.bMultiParent = true;
+		child->InvalidateTextCache();
+	}
+}
+
+void UJsonValue::AttachChildrenToTextCache(const UJsonValue* previousParent)
+{
+	if (!TextCache)
+		return;
+
+	for (UJsonValue* pElement : ValueArray)
+		AttachToTextCache(pElement, previousParent);
+	for (const auto& pair : ValueObject)
+		AttachToTextCache(pair.Value, previousParent);
+}
+
+void UJsonValue::DetachFromTextCache(UJsonValue* child)
+{
+	if (!TextCache)
+		return;
+
+	InvalidateText();
+	if (child && child->TextCache && child->TextCache->Parent.Get() == this)
+		child->TextCache->Parent = nullptr;
+}
+
+void UJsonValue::WriteCached(TJsonBPWriter<TCHAR>& writer) const
+{
+	FJsonBPTextCache& cache = *TextCache;
+	//scalars and lazy containers (written straight from their document) are cheap, only their state is tracked
+	if (IsLazy() || Packed || (JsonType != EJsonType::JSON_Array && JsonType != EJsonType::JSON_Object))
+	{
+		WriteTo(writer);
+		cache.bValid = !cache.bMultiParent;
+		return;
+	}
+
+	if (cache.bValid)
+	{
+		writer.WriteRawValue(*cache.Text, cache.Text.Len());
+		return;
+	}
+
+	const int32 start = writer.MarkValueStart();
+	bool bCacheable = !cache.bMultiParent;
+	auto writeChild = [this, &writer, &bCacheable](const UJsonValue* pChild)
+	{
+		if (!pChild)
+		{
+			writer.WriteNull();
+		}
+		else if (pChild->TextCache)
+		{
+			pChild->WriteCached(writer);
+			bCacheable &= pChild->TextCache->bValid && pChild->TextCache->Parent.Get() == this;
+		}
+		else
+		{
+			pChild->WriteTo(writer);
+			bCacheable = false;
+		}
+	};
+
+	if (JsonType == EJsonType::JSON_Array)
+	{
+		writer.BeginArray();
+		for (const UJsonValue* pElement : ValueArray)
+			writeChild(pElement);
+		writer.EndArray();
+	}
+	else
+	{
+		writer.BeginObject();
+		for (const auto& pair : ValueObject)
+		{
+			writer.WriteKey(pair.Key.ToString());
+			writeChild(pair.Value);
+		}
+		writer.EndObject();
+	}
+
+	if (bCacheable)
+	{
+		const TArray<TCHAR>& out = writer.GetOutput();
+		cache.Text.Reset();
+		cache.Text.AppendChars(out.GetData() + start, out.Num() - start);
+		cache.bValid = true;
+	}
+}
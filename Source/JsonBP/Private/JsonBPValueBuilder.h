@@ -0,0 +1,238 @@
+#pragma once
+
+#include "JsonBP.h"
+#include "JsonBPPrivate.h"
+
+/*
+TJsonBPReader handler that creates UJsonValue objects directly while reading.
+*/
+class FJsonBPValueBuilder
+{
+public:
+	FJsonBPValueBuilder() : Result(nullptr) {}
+
+	//the root value, valid after a successful read
+	UJsonValue* GetResult() const { return Result; }
+
+	bool OnNull() { return AddValue(UJsonValue::MakeNull()); }
+	bool OnBoolean(bool value) { return AddValue(UJsonValue::MakeBoolean(value)); }
+	bool OnNumber(double value)
+	{
+		if (!CanPack(false))
+			return AddValue(UJsonValue::MakeDouble(value));
+
+		Pack.Numbers.Add(value);
+		Pack.bIntegers = false;
+		PackIntegers.Add(false);
+		return true;
+	}
+	bool OnInteger(int64 value)
+	{
+		//larger integers could be written differently once they are doubles
+		if (value < -JsonBPMaxPackedInteger || value > JsonBPMaxPackedInteger || !CanPack(false))
+			return AddValue(UJsonValue::MakeInteger(value));
+
+		Pack.Numbers.Add((double)value);
+		PackIntegers.Add(true);
+		return true;
+	}
+	bool OnString(const FString& value)
+	{
+		if (!CanPack(true))
+			return AddValue(UJsonValue::MakeString(value));
+
+		Pack.Strings.Add(value);
+		return true;
+	}
+
+	bool OnArrayBegin()
+	{
+		BeginContainer(EJsonType::JSON_Array);
+		//every array starts packing, the first element of another kind turns it into values
+		PackFrame = Stack.Num() - 1;
+		Pack = FJsonBPPackedElements();
+		Pack.bIntegers = true;
+		PackIntegers.Reset();
+		return true;
+	}
+	bool OnObjectBegin() { return BeginContainer(EJsonType::JSON_Object); }
+	bool OnArrayEnd()
+	{
+		if (PackFrame == Stack.Num() - 1)
+		{
+			if (Pack.Num() >= JsonBPMinPackedElements)
+			{
+				Stack.Last().Container->Packed = MakeUnique<FJsonBPPackedElements>(MoveTemp(Pack));
+				PackFrame = INDEX_NONE;
+			}
+			else
+			{
+				Unpack();
+			}
+		}
+		Stack.Pop(false);
+		return true;
+	}
+	bool OnObjectEnd() { Stack.Pop(false); return true; }
+
+	bool OnObjectKey(const FString& key)
+	{
+		//repeated keys find their interned entry, only a new key allocates
+		Stack.Last().Key = FJsonBPKey(key);
+		return true;
+	}
+
+private:
+	struct FFrame
+	{
+		UJsonValue* Container;
+		FJsonBPKey Key;
+	};
+
+	//whether the next number (or string) goes into Pack
+	bool CanPack(bool bString)
+	{
+		if (PackFrame == INDEX_NONE || PackFrame != Stack.Num() - 1)
+			return false;
+
+		if (Pack.Num() == 0)
+			Pack.bStrings = bString;
+		if (Pack.bStrings == bString)
+			return true;
+
+		Unpack();
+		return false;
+	}
+
+	//the array turned out mixed (or short), the elements packed so far become values
+	void Unpack()
+	{
+		TArray<UJsonValue*>& elements = Stack[PackFrame].Container->ValueArray;
+		PackFrame = INDEX_NONE;
+
+		elements.Reserve(Pack.Num());
+		if (Pack.bStrings)
+		{
+			for (const FString& element : Pack.Strings)
+				elements.Add(UJsonValue::MakeString(element));
+		}
+		else
+		{
+			//each element keeps the kind it was read as, only a packed array makes them all doubles
+			for (int32 i = 0; i < Pack.Numbers.Num(); i++)
+				elements.Add(PackIntegers[i] ? UJsonValue::MakeInteger((int64)Pack.Numbers[i]) : UJsonValue::MakeDouble(Pack.Numbers[i]));
+		}
+	}
+
+	bool AddValue(UJsonValue* pValue)
+	{
+		if (Stack.Num() == 0)
+		{
+			Result = pValue;
+			return true;
+		}
+
+		if (PackFrame == Stack.Num() - 1)
+			Unpack();
+
+		FFrame& frame = Stack.Last();
+		if (frame.Container->JsonType == EJsonType::JSON_Array)
+			frame.Container->ValueArray.Add(pValue);
+		else
+			frame.Container->ValueObject.Add(frame.Key, pValue);
+
+		return true;
+	}
+
+	bool BeginContainer(EJsonType type)
+	{
+		UJsonValue* pContainer = MakeJsonValue();
+		check(pContainer);
+		pContainer->JsonType = type;
+		AddValue(pContainer);
+
+		FFrame& frame = Stack.AddDefaulted_GetRef();
+		frame.Container = pContainer;
+		return true;
+	}
+
+	UJsonValue* Result;
+	TArray<FFrame, TInlineAllocator<32>> Stack;
+	//the frame of the innermost array while all its elements so far are numbers or all strings
+	int32 PackFrame = INDEX_NONE;
+	FJsonBPPackedElements Pack;
+	//per number in Pack, whether it was read as an integer
+	TBitArray<> PackIntegers;
+};
+
+/*
+TJsonBPReader handler that creates the engine's FJsonValue tree, used by HelperParseJSON.
+*/
+class FJsonBPCPPValueBuilder
+{
+public:
+	TSharedPtr<FJsonValue> GetResult() const { return Result; }
+
+	bool OnNull() { return AddValue(MakeShared<FJsonValueNull>()); }
+	bool OnBoolean(bool value) { return AddValue(MakeShared<FJsonValueBoolean>(value)); }
+	bool OnNumber(double value) { return AddValue(MakeShared<FJsonValueNumber>(value)); }
+	//FJsonValueNumber only holds a double
+	bool OnInteger(int64 value) { return AddValue(MakeShared<FJsonValueNumber>((double)value)); }
+	bool OnString(const FString& value) { return AddValue(MakeShared<FJsonValueString>(value)); }
+
+	bool OnArrayBegin()
+	{
+		Stack.AddDefaulted();
+		return true;
+	}
+	bool OnObjectBegin()
+	{
+		Stack.AddDefaulted_GetRef().Object = MakeShared<FJsonObject>();
+		return true;
+	}
+	bool OnArrayEnd()
+	{
+		TSharedPtr<FJsonValue> jsArray = MakeShared<FJsonValueArray>(Stack.Last().Elements);
+		Stack.Pop(false);
+		return AddValue(jsArray);
+	}
+	bool OnObjectEnd()
+	{
+		TSharedPtr<FJsonValue> jsObject = MakeShared<FJsonValueObject>(Stack.Last().Object);
+		Stack.Pop(false);
+		return AddValue(jsObject);
+	}
+	bool OnObjectKey(const FString& key)
+	{
+		Stack.Last().Key = key;
+		return true;
+	}
+
+private:
+	struct FFrame
+	{
+		TArray<TSharedPtr<FJsonValue>> Elements;
+		TSharedPtr<FJsonObject> Object;
+		FString Key;
+	};
+
+	bool AddValue(TSharedPtr<FJsonValue> value)
+	{
+		if (Stack.Num() == 0)
+		{
+			Result = MoveTemp(value);
+			return true;
+		}
+
+		FFrame& frame = Stack.Last();
+		if (frame.Object.IsValid())
+			frame.Object->Values.Add(frame.Key, MoveTemp(value));
+		else
+			frame.Elements.Add(MoveTemp(value));
+
+		return true;
+	}
+
+	TSharedPtr<FJsonValue> Result;
+	TArray<FFrame, TInlineAllocator<32>> Stack;
+};
@@ -0,0 +1,324 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+/*
+performance regression tests, one per corpus: JsonBP.Benchmark.Small, .Wide, .Deep, .Numeric and .Large.
+each one measures MakeFromString (plain and pooled), MakeLazyFromString, ToString (plain and with the text cache), ToMsgPack, MakeFromMsgPack, ToCPPVersion, MakeFromCPPVersion,
+field lookup and field mutation, and reports MB/s (ops/s for lookup and mutation), values made per node and peak memory.
+the memory taken by the object storage, and what TMap would take, is reported too.
+
+values made per node don't depend on the machine, they are compared against Resources/JsonBPBenchmarkBaseline.json of the plugin
+and a measurement missing from it fails. throughput and peak memory do, they are compared against Saved/JsonBP/JsonBPBenchmarkBaseline.json
+of the project when that file has them.
+
+the suite doesn't count allocator calls. the global allocator isn't wrapped, so "values made per node" is the number of UJsonValues
+MakeJsonValue creates on the test thread, a proxy for the allocations that scale with the tree. the strings, arrays and maps the values
+own only show up in peak memory, which is the growth of process memory over one run and is gated per machine only.
+the checked-in file has to come from a run of the command below, not be edited by hand.
+
+headless:
+	UE4Editor-Cmd <Project>.uproject -ExecCmds="Automation RunTests JsonBP.Benchmark;Quit" -unattended -nullrhi -nosplash
+
+record both baselines again, after a change that is meant to move the numbers or once per machine:
+	-ExecCmds="JsonBP.Bench.UpdateBaseline 1;Automation RunTests JsonBP.Benchmark;Quit"
+*/
+
+#include "JsonBP.h"
+#include "JsonBPBenchmark.h"
+#include "JsonBPPool.h"
+#include "HAL/IConsoleManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static TAutoConsoleVariable<float> CVarJsonBPBenchRegressionTolerance(
+	TEXT("JsonBP.Bench.RegressionTolerance"),
+	0.25f,
+	TEXT("how much worse than the baseline a benchmark result may get before the test fails, 0.25 means 25%"));
+
+static TAutoConsoleVariable<int32> CVarJsonBPBenchUpdateBaseline(
+	TEXT("JsonBP.Bench.UpdateBaseline"),
+	0,
+	TEXT("if not 0 the benchmark tests store their results as the new baseline instead of comparing against it"));
+
+namespace JsonBPBenchmarkTest
+{
+	struct FMetrics
+	{
+		//MB/s or ops/s, higher is better
+		double Throughput = 0;
+		double ValuesPerNode = 0;
+		int64 PeakBytes = 0;
+	};
+
+	//checked in with the plugin, the numbers that are the same on every machine
+	static FString GetBaselinePath()
+	{
+		TSharedPtr<IPlugin> plugin = IPluginManager::Get().FindPlugin(TEXT("JsonBP"));
+		const FString baseDir = plugin.IsValid() ? plugin->GetBaseDir() : FPaths::ProjectPluginsDir() / TEXT("JsonBP");
+		return baseDir / TEXT("Resources") / TEXT("JsonBPBenchmarkBaseline.json");
+	}
+
+	//throughput and peak memory of this machine
+	static FString GetMachineBaselinePath()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("JsonBP") / TEXT("JsonBPBenchmarkBaseline.json");
+	}
+
+	static TSharedPtr<FJsonObject> LoadBaseline(const FString& path)
+	{
+		FString text;
+		TSharedPtr<FJsonObject> baseline;
+		if (FFileHelper::LoadFileToString(text, *path))
+			FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(text), baseline);
+
+		return baseline.IsValid() ? baseline : MakeShared<FJsonObject>();
+	}
+
+	static bool SaveBaseline(const TSharedPtr<FJsonObject>& baseline, const FString& path)
+	{
+		FString text;
+		FJsonSerializer::Serialize(baseline.ToSharedRef(), TJsonWriterFactory<>::Create(&text));
+		return FFileHelper::SaveStringToFile(text, *path);
+	}
+
+	static FString MakeCorpus(const FString& name)
+	{
+		if (name == TEXT("Small"))
+			return JsonBPMakeSampleDocument(1);
+		if (name == TEXT("Wide"))
+			return JsonBPMakeWideDocument(10000);
+		if (name == TEXT("Deep"))
+			return JsonBPMakeDeepDocument(256);
+		if (name == TEXT("Numeric"))
+			return JsonBPMakeNumericDocument(2000);
+
+		return JsonBPMakeSampleDocument(20000);
+	}
+
+	//roughly the same amount of text per corpus, small documents get more iterations
+	static int32 GetIterations(int32 textLength)
+	{
+		return FMath::Clamp(8 * 1024 * 1024 / FMath::Max(textLength, 1), 3, 20000);
+	}
+
+	static void CollectFields(UJsonValue* pValue, TArray<TPair<UJsonValue*, FString>>& fields)
+	{
+		//GetArrayRef would expand a packed array, it has no fields anyway
+		if (pValue->IsPacked())
+			return;
+		for (UJsonValue* pElement : pValue->GetArrayRef())
+			CollectFields(pElement, fields);
+		for (const auto& pair : pValue->GetObjectRef())
+		{
+			fields.Emplace(pValue, pair.Key.ToString());
+			CollectFields(pair.Value, fields);
+		}
+	}
+
+	//bytes the object storage of the tree takes, and what the same fields would take in a TMap
+	static void MeasureObjectStorage(const UJsonValue* pValue, SIZE_T& bytes, SIZE_T& mapBytes)
+	{
+		//every value carries the container, empty for arrays and scalars
+		bytes += sizeof(FJsonBPObjectMap);
+		mapBytes += sizeof(TMap<FJsonBPKey, UJsonValue*>);
+		if (pValue->IsPacked())
+			return;
+
+		const FJsonBPObjectMap& fields = pValue->GetObjectRef();
+		if (fields.Num() > 0)
+		{
+			TMap<FJsonBPKey, UJsonValue*> map;
+			for (const auto& pair : fields)
+				map.Add(pair.Key, pair.Value);
+			bytes += fields.GetAllocatedSize();
+			mapBytes += map.GetAllocatedSize();
+		}
+
+		for (const UJsonValue* pElement : pValue->GetArrayRef())
+		{
+			if (pElement)
+				MeasureObjectStorage(pElement, bytes, mapBytes);
+		}
+		for (const auto& pair : fields)
+		{
+			if (pair.Value)
+				MeasureObjectStorage(pair.Value, bytes, mapBytes);
+		}
+	}
+
+	static FMetrics MakeMetrics(const FJsonBPBenchResult& result, double units, int32 numNodes)
+	{
+		FMetrics metrics;
+		metrics.Throughput = result.Seconds > 0 ? units / result.Seconds : 0;
+		metrics.ValuesPerNode = (double)result.NumValues / FMath::Max(numNodes, 1);
+		metrics.PeakBytes = result.PeakBytes;
+		return metrics;
+	}
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FJsonBPBenchmarkTest, "JsonBP.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FJsonBPBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const TCHAR* name : { TEXT("Small"), TEXT("Wide"), TEXT("Deep"), TEXT("Numeric"), TEXT("Large") })
+	{
+		OutBeautifiedNames.Add(name);
+		OutTestCommands.Add(name);
+	}
+}
+
+bool FJsonBPBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace JsonBPBenchmarkTest;
+
+	const FString json = MakeCorpus(Parameters);
+	const int32 iterations = GetIterations(json.Len());
+	const double megaBytes = json.Len() * sizeof(TCHAR) / (1024.0 * 1024.0);
+
+	UJsonValue* pValue = UJsonValue::MakeFromString(json);
+	if (!TestNotNull(TEXT("corpus parses"), pValue))
+		return false;
+
+	//JsonBPMeasure collects garbage after every measurement
+	pValue->AddToRoot();
+	TSharedPtr<FJsonValue> jsValue = pValue->ToCPPVersion();
+	const int32 numNodes = JsonBPCountValues(pValue);
+
+	TArray<TPair<UJsonValue*, FString>> fields;
+	CollectFields(pValue, fields);
+	SIZE_T objectBytes = 0;
+	SIZE_T objectMapBytes = 0;
+	MeasureObjectStorage(pValue, objectBytes, objectMapBytes);
+	const double numFields = FMath::Max(fields.Num(), 1);
+	const int32 fieldIterations = FMath::Max(1, iterations * numNodes / FMath::Max(fields.Num(), 1) / 4);
+
+	TArray<TPair<FString, FMetrics>> results;
+	results.Emplace(TEXT("MakeFromString"), MakeMetrics(JsonBPMeasure(iterations, [&json]() { UJsonValue::MakeFromString(json); }), megaBytes, numNodes));
+	//every iteration reclaims its tree, so after the first one all values come from the free list
+	UJsonValuePool* pPool = UJsonValuePool::MakeJsonValuePool(numNodes);
+	pPool->AddToRoot();
+	results.Emplace(TEXT("MakeFromStringPooled"), MakeMetrics(JsonBPMeasure(iterations, [&json, pPool]()
+	{
+		FJsonValuePoolScope scope(pPool);
+		pPool->Reclaim(UJsonValue::MakeFromString(json));
+	}), megaBytes, numNodes));
+	pPool->RemoveFromRoot();
+	//parse and expand only the first level, the way a caller reading a few fields of a big response does
+	results.Emplace(TEXT("MakeLazyFromString"), MakeMetrics(JsonBPMeasure(iterations, [&json]()
+	{
+		UJsonValue* pLazy = UJsonValue::MakeLazyFromString(json);
+		if (pLazy)
+		{
+			pLazy->GetObjectRef();
+			pLazy->GetArrayRef();
+		}
+	}), megaBytes, numNodes));
+	results.Emplace(TEXT("ToString"), MakeMetrics(JsonBPMeasure(iterations, [pValue]() { pValue->ToString(false); }), megaBytes, numNodes));
+	//one field changes between the writes of a tree that keeps its text
+	UJsonValue* pCached = pValue->DeepCopy();
+	pCached->AddToRoot();
+	pCached->SetTextCacheEnabled(true);
+	pCached->ToString(false);
+	TArray<TPair<UJsonValue*, FString>> cachedFields;
+	CollectFields(pCached, cachedFields);
+	int64 change = 0;
+	results.Emplace(TEXT("ToStringIncremental"), MakeMetrics(JsonBPMeasure(iterations, [pCached, &cachedFields, &change]()
+	{
+		if (cachedFields.Num() > 0)
+		{
+			const auto& field = cachedFields[change % cachedFields.Num()];
+			field.Key->SetFieldInteger(field.Value, change++);
+		}
+		pCached->ToString(false);
+	}), megaBytes, numNodes));
+	pCached->RemoveFromRoot();
+	TArray<uint8> msgPack;
+	pValue->ToMsgPack(msgPack);
+	const double msgPackMegaBytes = msgPack.Num() / (1024.0 * 1024.0);
+	results.Emplace(TEXT("ToMsgPack"), MakeMetrics(JsonBPMeasure(iterations, [pValue]() { TArray<uint8> bytes; pValue->ToMsgPack(bytes); }), msgPackMegaBytes, numNodes));
+	results.Emplace(TEXT("MakeFromMsgPack"), MakeMetrics(JsonBPMeasure(iterations, [&msgPack]() { UJsonValue::MakeFromMsgPack(msgPack); }), msgPackMegaBytes, numNodes));
+	results.Emplace(TEXT("ToCPPVersion"), MakeMetrics(JsonBPMeasure(iterations, [pValue]() { pValue->ToCPPVersion(); }), megaBytes, numNodes));
+	results.Emplace(TEXT("MakeFromCPPVersion"), MakeMetrics(JsonBPMeasure(iterations, [&jsValue]() { UJsonValue::MakeFromCPPVersion(jsValue); }), megaBytes, numNodes));
+	results.Emplace(TEXT("FieldLookup"), MakeMetrics(JsonBPMeasure(fieldIterations, [&fields]()
+	{
+		for (const auto& field : fields)
+			field.Key->GetFieldValue(field.Value);
+	}), numFields, numNodes));
+	//last, it changes the tree the other operations work on
+	results.Emplace(TEXT("Mutation"), MakeMetrics(JsonBPMeasure(fieldIterations, [&fields]()
+	{
+		int64 i = 0;
+		for (const auto& field : fields)
+			field.Key->SetFieldInteger(field.Value, i++);
+	}), numFields, numNodes));
+
+	pValue->RemoveFromRoot();
+
+	const bool bUpdateBaseline = CVarJsonBPBenchUpdateBaseline.GetValueOnGameThread() != 0;
+	const double tolerance = FMath::Max(0.0f, CVarJsonBPBenchRegressionTolerance.GetValueOnGameThread());
+	TSharedPtr<FJsonObject> baseline = LoadBaseline(GetBaselinePath());
+	TSharedPtr<FJsonObject> machineBaseline = LoadBaseline(GetMachineBaselinePath());
+
+	AddInfo(FString::Printf(TEXT("%s: %.2f MB of text, %d nodes, %d iterations"), *Parameters, megaBytes, numNodes, iterations));
+	AddInfo(FString::Printf(TEXT("  MessagePack is %d bytes, %.1f%% of the UTF-16 text"), msgPack.Num(), 100.0 * msgPack.Num() / FMath::Max(json.Len() * (int32)sizeof(TCHAR), 1)));
+	AddInfo(FString::Printf(TEXT("  object storage is %.2f MB, %.2f MB as TMap (%.1f%% saved)"), objectBytes / (1024.0 * 1024.0), objectMapBytes / (1024.0 * 1024.0),
+		100.0 * (1.0 - (double)objectBytes / FMath::Max<SIZE_T>(objectMapBytes, 1))));
+	for (const auto& result : results)
+	{
+		const FString key = Parameters + TEXT(".") + result.Key;
+		const FMetrics& metrics = result.Value;
+		const bool bPerField = result.Key == TEXT("FieldLookup") || result.Key == TEXT("Mutation");
+		AddInfo(FString::Printf(TEXT("  %-20s %12.2f %s  %8.2f values per node  peak %8.2f MB"), *result.Key,
+			metrics.Throughput, bPerField ? TEXT("ops/s") : TEXT("MB/s "), metrics.ValuesPerNode, metrics.PeakBytes / (1024.0 * 1024.0)));
+
+		if (bUpdateBaseline)
+		{
+			TSharedPtr<FJsonObject> entry = MakeShared<FJsonObject>();
+			entry->SetNumberField(TEXT("ValuesPerNode"), metrics.ValuesPerNode);
+			baseline->SetObjectField(key, entry);
+			TSharedPtr<FJsonObject> machineEntry = MakeShared<FJsonObject>();
+			machineEntry->SetNumberField(TEXT("Throughput"), metrics.Throughput);
+			machineEntry->SetNumberField(TEXT("PeakBytes"), (double)metrics.PeakBytes);
+			machineBaseline->SetObjectField(key, machineEntry);
+			continue;
+		}
+
+		const TSharedPtr<FJsonObject>* pEntry = nullptr;
+		double baseValues = 0;
+		if (!baseline->TryGetObjectField(key, pEntry) || !(*pEntry)->TryGetNumberField(TEXT("ValuesPerNode"), baseValues))
+		{
+			AddError(FString::Printf(TEXT("%s has no baseline in %s, run with JsonBP.Bench.UpdateBaseline 1 to record one"), *key, *GetBaselinePath()));
+			continue;
+		}
+		if (metrics.ValuesPerNode > baseValues * (1.0 + tolerance))
+			AddError(FString::Printf(TEXT("%s values per node regressed: %f, baseline %f"), *key, metrics.ValuesPerNode, baseValues));
+
+		//time and memory are only compared on the machine that recorded them
+		const TSharedPtr<FJsonObject>* pMachineEntry = nullptr;
+		if (!machineBaseline->TryGetObjectField(key, pMachineEntry))
+			continue;
+
+		double baseThroughput = 0;
+		double basePeak = 0;
+		if ((*pMachineEntry)->TryGetNumberField(TEXT("Throughput"), baseThroughput) && metrics.Throughput < baseThroughput * (1.0 - tolerance))
+			AddError(FString::Printf(TEXT("%s throughput regressed: %.2f, baseline %.2f"), *key, metrics.Throughput, baseThroughput));
+		if ((*pMachineEntry)->TryGetNumberField(TEXT("PeakBytes"), basePeak) && metrics.PeakBytes > basePeak * (1.0 + tolerance))
+			AddError(FString::Printf(TEXT("%s peak memory regressed: %lld, baseline %.0f"), *key, metrics.PeakBytes, basePeak));
+	}
+
+	if (bUpdateBaseline)
+	{
+		if (!SaveBaseline(baseline, GetBaselinePath()))
+			AddError(FString::Printf(TEXT("failed to write %s"), *GetBaselinePath()));
+		if (!SaveBaseline(machineBaseline, GetMachineBaselinePath()))
+			AddError(FString::Printf(TEXT("failed to write %s"), *GetMachineBaselinePath()));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
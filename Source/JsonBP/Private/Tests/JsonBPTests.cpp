@@ -0,0 +1,841 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "JsonBP.h"
+#include "JsonBPDocument.h"
+#include "JsonBPPatch.h"
+#include "JsonBPPath.h"
+#include "JsonBPPool.h"
+#include "JsonBPSchema.h"
+#include "JsonBPStruct.h"
+#include "JsonBPPrivate.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const uint32 JsonBPTestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+//what used to be UJsonValue::Test0
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPHelperTest, "JsonBP.Helpers", JsonBPTestFlags)
+bool FJsonBPHelperTest::RunTest(const FString& Parameters)
+{
+	{
+		TSharedPtr<FJsonValue> jsValue = HelperParseJSON(TEXT("123"));
+		TestTrue(TEXT("parse number"), jsValue.IsValid() && jsValue->AsNumber() == 123);
+	}
+	{
+		TArray<TSharedPtr<FJsonValue>> elements;
+		elements.Add(MakeShared<FJsonValueNumber>(123));
+		elements.Add(MakeShared<FJsonValueNumber>(456));
+		elements.Add(MakeShared<FJsonValueNull>());
+		TestEqual(TEXT("stringify array"), HelperStringifyJSON(MakeShared<FJsonValueArray>(elements)), FString(TEXT("[123,456,null]")));
+	}
+	{
+		TSharedPtr<FJsonObject> elements = MakeShared<FJsonObject>();
+		elements->Values.Add(TEXT("number"), MakeShared<FJsonValueString>(TEXT("hehe")));
+		TestEqual(TEXT("stringify object"), HelperStringifyJSON(MakeShared<FJsonValueObject>(elements)), FString(TEXT(R"({"number":"hehe"})")));
+	}
+	TestEqual(TEXT("stringify number"), HelperStringifyJSON(MakeShared<FJsonValueNumber>(123)), FString(TEXT("123")));
+	TestEqual(TEXT("stringify string"), HelperStringifyJSON(MakeShared<FJsonValueString>(TEXT("hello"))), FString(TEXT(R"("hello")")));
+	TestEqual(TEXT("stringify boolean"), HelperStringifyJSON(MakeShared<FJsonValueBoolean>(true)), FString(TEXT("true")));
+	TestEqual(TEXT("stringify null"), HelperStringifyJSON(MakeShared<FJsonValueNull>()), FString(TEXT("null")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPParseTest, "JsonBP.Parse", JsonBPTestFlags)
+bool FJsonBPParseTest::RunTest(const FString& Parameters)
+{
+	TestNull(TEXT("invalid json"), UJsonValue::MakeFromString(TEXT("{asd")));
+	TestNull(TEXT("trailing comma"), UJsonValue::MakeFromString(TEXT("[1,]")));
+	TestNull(TEXT("trailing characters"), UJsonValue::MakeFromString(TEXT("[1] 2")));
+
+	//every basic value reads back to the same text
+	const TCHAR* roundTrips[] = { TEXT("123"), TEXT("false"), TEXT("true"), TEXT("null"), TEXT(R"("string")"), TEXT(R"("")"), TEXT("{}"), TEXT("[]"),
+		TEXT(R"("esc\"aped\\\n\u0001")"), TEXT("[1,[2,[3]],{}]") };
+	for (const TCHAR* json : roundTrips)
+	{
+		UJsonValue* pValue = UJsonValue::MakeFromString(json);
+		if (TestNotNull(json, pValue))
+			TestEqual(json, pValue->ToString(false), FString(json));
+	}
+
+	{
+		UJsonValue* pValue = UJsonValue::MakeFromString(TEXT(R"("string")"));
+		FString value;
+		TestTrue(TEXT("string value"), pValue && pValue->GetValueAsString(value) && value == TEXT("string"));
+	}
+	{
+		const FString json = TEXT(R"({"str":"ssss","num":22,"bool":true,"array":[1,2,3],"null":null,"obj":{"a":"a","b":"b"}})");
+		UJsonValue* pValue = UJsonValue::MakeFromString(json);
+		if (TestNotNull(TEXT("object"), pValue))
+		{
+			UJsonValue* pRemade = UJsonValue::MakeFromCPPVersion(pValue->ToCPPVersion());
+			const FString reStringed = pRemade->ToString(false);
+			TestEqual(TEXT("FJsonValue round trip"), UJsonValue::MakeFromString(reStringed)->ToString(false), reStringed);
+			TestEqual(TEXT("pretty round trip"), UJsonValue::MakeFromString(pRemade->ToString(true))->ToString(false), reStringed);
+		}
+	}
+	{
+		double negativeZero = 0;
+		UJsonValue* pValue = UJsonValue::MakeFromCPPVersion(MakeShared<FJsonValueNumber>(-0.0));
+		TestTrue(TEXT("-0 stays a double"), pValue && pValue->GetValueAsDouble(negativeZero) && FMath::IsNegativeDouble(negativeZero));
+	}
+	{
+		UJsonValue* pValue = UJsonValue::MakeFromUTF8("[\"\xC3\xA9\"]", 6);
+		FString value;
+		TestTrue(TEXT("utf8"), pValue && pValue->GetArrayLength() == 1 && pValue->GetArrayElement(0)->GetValueAsString(value) && value == TEXT("\u00e9"));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPUTF8Test, "JsonBP.UTF8", JsonBPTestFlags)
+bool FJsonBPUTF8Test::RunTest(const FString& Parameters)
+{
+	//long enough for the 8 byte scan, with 2, 3 and 4 byte sequences
+	const char* text = "{\"name\":\"plain ascii run \xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80 end\",\"esc\":\"a\\\"b\"}";
+	TArray<uint8> bytes((const uint8*)text, FCStringAnsi::Strlen(text));
+
+	UJsonValue* pValue = UJsonValue::MakeFromUTF8Bytes(bytes);
+	FString name;
+	TestTrue(TEXT("decoded"), pValue && pValue->GetFieldValueString(TEXT("name"), name) && name == FString(TEXT("plain ascii run \u00e9 \u20ac \U0001F600 end")));
+
+	TArray<uint8> written;
+	if (pValue)
+		pValue->ToUTF8Bytes(false, written);
+	TestTrue(TEXT("utf8 round trip"), written == bytes);
+	TestEqual(TEXT("same as the string path"), pValue ? UJsonValue::MakeFromUTF8(written)->ToString(false) : FString(), pValue ? pValue->ToString(false) : FString());
+
+	const char* invalid[] = { "\"\xC0\xAF\"", "\"\xED\xA0\x80\"", "\"\xE2\x82\"", "\"\xFF\"", "\"12345678\x80\"" };
+	for (const char* pInvalid : invalid)
+		TestNull(TEXT("invalid utf8"), UJsonValue::MakeFromUTF8(pInvalid, FCStringAnsi::Strlen(pInvalid)));
+
+	TArray<uint8> helperBytes;
+	HelperStringifyJSONUTF8(MakeShared<FJsonValueString>(TEXT("\u00e9")), helperBytes);
+	TSharedPtr<FJsonValue> jsValue = HelperParseJSONUTF8(helperBytes);
+	TestTrue(TEXT("helper round trip"), helperBytes.Num() == 4 && jsValue.IsValid() && jsValue->AsString() == TEXT("\u00e9"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPFileTest, "JsonBP.File", JsonBPTestFlags)
+bool FJsonBPFileTest::RunTest(const FString& Parameters)
+{
+	const FString filePath = FPaths::ProjectIntermediateDir() / TEXT("JsonBPFileTest.json");
+	const FString json = TEXT("{\"name\":\"\u00e9t\u00e9\",\"list\":[1,2.5,true,null],\"nested\":{\"id\":9007199254740993}}");
+
+	UJsonValue* pValue = UJsonValue::MakeFromString(json);
+	if (!TestNotNull(TEXT("value"), pValue))
+		return false;
+
+	TestTrue(TEXT("save"), pValue->SaveJsonToFile(filePath, true));
+	UJsonValue* pLoaded = UJsonValue::LoadJsonFromFile(filePath);
+	TestEqual(TEXT("load"), pLoaded ? pLoaded->ToString(false) : FString(), json);
+	UJsonDocument* pDocument = UJsonDocument::LoadDocumentFromFile(filePath);
+	TestEqual(TEXT("load document"), pDocument ? UJsonDocument::NodeToString(pDocument->GetRoot(), false) : FString(), json);
+
+	//FFileHelper writes UTF-16 for strings that are not ansi
+	FFileHelper::SaveStringToFile(json, *filePath, FFileHelper::EEncodingOptions::ForceUnicode);
+	pLoaded = UJsonValue::LoadJsonFromFile(filePath);
+	TestEqual(TEXT("load utf16"), pLoaded ? pLoaded->ToString(false) : FString(), json);
+
+	IFileManager::Get().Delete(*filePath);
+	TestNull(TEXT("missing file"), UJsonValue::LoadJsonFromFile(filePath));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPMsgPackTest, "JsonBP.MsgPack", JsonBPTestFlags)
+bool FJsonBPMsgPackTest::RunTest(const FString& Parameters)
+{
+	//every integer width, float32 and float64 doubles, integral doubles, long strings and containers past the fix sizes
+	FString json = TEXT(R"({"ints":[0,127,128,255,256,65535,65536,4294967295,4294967296,9223372036854775807,-1,-32,-33,-128,-129,-32768,-32769,-2147483648,-2147483649,-9223372036854775808],)");
+	json += TEXT(R"("doubles":[0.5,0.1,1.0,-0,1.5e+300,18446744073709551615],"flags":[true,false,null],"empty":{},"nested":[[[]]],)");
+	json += FString::Printf(TEXT("\"short\":\"\u00e9t\u00e9\",\"long\":\"%s\",\"longer\":\"%s\"}"), *FString::ChrN(40, TEXT('a')), *FString::ChrN(300, TEXT('b')));
+
+	UJsonValue* pValue = UJsonValue::MakeFromString(json);
+	if (!TestNotNull(TEXT("value"), pValue))
+		return false;
+
+	TArray<uint8> bytes;
+	pValue->ToMsgPack(bytes);
+	UJsonValue* pDecoded = UJsonValue::MakeFromMsgPack(bytes);
+	TestEqual(TEXT("same tree as the text"), pDecoded ? pDecoded->ToString(false) : FString(), pValue->ToString(false));
+	TestTrue(TEXT("smaller than the text"), bytes.Num() < json.Len());
+
+	TArray<uint8> fixed = { 0x82, 0xA1, 'a', 0x01, 0xA1, 'b', 0xCB, 0x3F, 0xF8, 0, 0, 0, 0, 0, 0 };
+	pDecoded = UJsonValue::MakeFromMsgPack(fixed);
+	TestEqual(TEXT("decode"), pDecoded ? pDecoded->ToString(false) : FString(), FString(TEXT(R"({"a":1,"b":1.5})")));
+
+	//text can't carry nan, values made in code can
+	TArray<uint8> nanBytes;
+	UJsonValue::MakeDouble(FMath::Sqrt(-1.0f))->ToMsgPack(nanBytes);
+	double nan = 0;
+	pDecoded = UJsonValue::MakeFromMsgPack(nanBytes);
+	TestTrue(TEXT("nan"), pDecoded && pDecoded->GetValueAsDouble(nan) && FMath::IsNaN(nan));
+
+	TArray<uint8> truncated(bytes.GetData(), bytes.Num() - 1);
+	TestNull(TEXT("truncated"), UJsonValue::MakeFromMsgPack(truncated));
+	TArray<uint8> binary = { 0xC4, 0x01, 0x00 };
+	TestNull(TEXT("binary is not json"), UJsonValue::MakeFromMsgPack(binary));
+	TArray<uint8> integerKey = { 0x81, 0x01, 0x02 };
+	TestNull(TEXT("keys are strings"), UJsonValue::MakeFromMsgPack(integerKey));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPPatchTest, "JsonBP.Patch", JsonBPTestFlags)
+bool FJsonBPPatchTest::RunTest(const FString& Parameters)
+{
+	{
+		UJsonValue* pA = UJsonValue::MakeFromString(TEXT(R"({"name":"x","tags":["a","b","c"],"pos":{"x":1,"y":2},"a/b~":1})"));
+		UJsonValue* pB = UJsonValue::MakeFromString(TEXT(R"({"name":"y","tags":["a","d"],"pos":{"x":1.0,"y":3},"new":[null,{}]})"));
+		UJsonValue* pPatch = UJsonPatchLibrary::Diff(pA, pB);
+		//name, tags/1, tags/2, pos/y, a~1b~0, new. pos/x is the same number
+		TestEqual(TEXT("diff operations"), pPatch->GetArrayLength(), 6);
+
+		UJsonValue* pTarget = UJsonPatchLibrary::CloneValue(pA);
+		FString error;
+		TestTrue(TEXT("apply diff"), UJsonPatchLibrary::ApplyPatch(pTarget, pPatch, error));
+		TestTrue(TEXT("diff turns a into b"), UJsonPatchLibrary::JsonEquals(pTarget, pB));
+		TestFalse(TEXT("a is untouched"), UJsonPatchLibrary::JsonEquals(pA, pB));
+		TestEqual(TEXT("no diff"), UJsonPatchLibrary::Diff(pB, pTarget)->GetArrayLength(), 0);
+	}
+	{
+		//replaced fields keep their place, so the patched text is b's text
+		UJsonValue* pA = UJsonValue::MakeFromString(TEXT(R"({"x":1,"y":{"z":2},"w":[1],"v":true})"));
+		UJsonValue* pB = UJsonValue::MakeFromString(TEXT(R"({"x":1,"y":"z","w":[2],"v":false})"));
+		UJsonValue* pTarget = UJsonPatchLibrary::CloneValue(pA);
+		FString error;
+		TestTrue(TEXT("apply replaces"), UJsonPatchLibrary::ApplyPatch(pTarget, UJsonPatchLibrary::Diff(pA, pB), error));
+		TestEqual(TEXT("same text as b"), pTarget->ToString(false), pB->ToString(false));
+	}
+	{
+		UJsonValue* pTarget = UJsonValue::MakeFromString(TEXT(R"({"a":[1,2],"b":{"c":"d"}})"));
+		UJsonValue* pPatch = UJsonValue::MakeFromString(TEXT(R"([
+			{"op":"add","path":"/a/-","value":3},
+			{"op":"add","path":"/a/0","value":0},
+			{"op":"move","from":"/b/c","path":"/e"},
+			{"op":"copy","from":"/a","path":"/b/a"},
+			{"op":"replace","path":"/a/1","value":"one"},
+			{"op":"remove","path":"/a/2"},
+			{"op":"test","path":"/b/a/3","value":3.0}
+		])"));
+		FString error;
+		TestTrue(TEXT("apply"), UJsonPatchLibrary::ApplyPatch(pTarget, pPatch, error));
+		TestTrue(TEXT("patched"), UJsonPatchLibrary::JsonEquals(pTarget, UJsonValue::MakeFromString(TEXT(R"({"a":[0,"one",3],"b":{"a":[0,1,2,3]},"e":"d"})"))));
+
+		UJsonValue* pFailing = UJsonValue::MakeFromString(TEXT(R"([{"op":"remove","path":"/e"},{"op":"test","path":"/a/0","value":1}])"));
+		TestFalse(TEXT("failed test"), UJsonPatchLibrary::ApplyPatch(pTarget, pFailing, error));
+		TestTrue(TEXT("error names the operation"), error.StartsWith(TEXT("operation 1")));
+		TestFalse(TEXT("earlier operations stay applied"), pTarget->HasField(TEXT("e")));
+
+		UJsonValue* pIntoChild = UJsonValue::MakeFromString(TEXT(R"([{"op":"move","from":"/b","path":"/b/x"}])"));
+		TestFalse(TEXT("move into own child"), UJsonPatchLibrary::ApplyPatch(pTarget, pIntoChild, error));
+		UJsonValue* pOutOfRange = UJsonValue::MakeFromString(TEXT(R"([{"op":"add","path":"/a/9","value":1}])"));
+		TestFalse(TEXT("index out of range"), UJsonPatchLibrary::ApplyPatch(pTarget, pOutOfRange, error));
+	}
+	{
+		//the example of RFC 7396
+		UJsonValue* pTarget = UJsonValue::MakeFromString(TEXT(R"({"title":"Goodbye!","author":{"givenName":"John","familyName":"Doe"},"tags":["example","sample"],"content":"This will be unchanged"})"));
+		UJsonValue* pPatch = UJsonValue::MakeFromString(TEXT(R"({"title":"Hello!","phoneNumber":"+01-555-1234","author":{"familyName":null},"tags":["example"]})"));
+		UJsonValue* pExpected = UJsonValue::MakeFromString(TEXT(R"({"title":"Hello!","author":{"givenName":"John"},"tags":["example"],"content":"This will be unchanged","phoneNumber":"+01-555-1234"})"));
+		TestTrue(TEXT("merge patch"), UJsonPatchLibrary::ApplyMergePatch(pTarget, pPatch));
+		TestTrue(TEXT("merged"), UJsonPatchLibrary::JsonEquals(pTarget, pExpected));
+
+		UJsonValue* pScalar = UJsonValue::MakeFromString(TEXT(R"({"a":{"b":null,"c":1}})"));
+		TestTrue(TEXT("merge over a scalar"), UJsonPatchLibrary::ApplyMergePatch(pScalar, UJsonValue::MakeFromString(TEXT(R"({"a":[{"x":null}]})"))));
+		TestEqual(TEXT("arrays replace"), pScalar->ToString(false), FString(TEXT(R"({"a":[{"x":null}]})")));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPParallelTest, "JsonBP.Parallel", JsonBPTestFlags)
+bool FJsonBPParallelTest::RunTest(const FString& Parameters)
+{
+	//small pieces so a short text is split too
+	IConsoleVariable* pMinLength = IConsoleManager::Get().FindConsoleVariable(TEXT("JsonBP.Parallel.MinLength"));
+	IConsoleVariable* pMinItems = IConsoleManager::Get().FindConsoleVariable(TEXT("JsonBP.Parallel.MinItemsPerChunk"));
+	if (!TestNotNull(TEXT("console variables"), pMinLength) || !TestNotNull(TEXT("console variables"), pMinItems))
+		return false;
+	const int32 oldMinLength = pMinLength->GetInt();
+	const int32 oldMinItems = pMinItems->GetInt();
+	pMinLength->Set(0, ECVF_SetByCode);
+	pMinItems->Set(4, ECVF_SetByCode);
+
+	FString array = TEXT(" [");
+	FString object = TEXT("{");
+	for (int32 i = 0; i < 500; i++)
+	{
+		const TCHAR* separator = i > 0 ? TEXT(",") : TEXT("");
+		array += FString::Printf(TEXT("%s{\"id\":%d,\"name\":\"n\\\"%d]\",\"tags\":[%d,[],{}]}"), separator, i, i, i);
+		object += FString::Printf(TEXT("%s\"k,%d:\" : [%d, \"}\"]"), separator, i, i);
+	}
+	array += TEXT("] ");
+	object += TEXT(",\"k,0:\":null}");
+
+	for (const FString& json : { array, object })
+	{
+		TSharedPtr<FJsonValue> serial = HelperParseJSON(json);
+		TSharedPtr<FJsonValue> parallel = HelperParseJSON(json, true);
+		if (!TestTrue(TEXT("parsed"), serial.IsValid() && parallel.IsValid()))
+			break;
+
+		TestEqual(TEXT("same tree"), HelperStringifyJSON(parallel), HelperStringifyJSON(serial));
+		TestEqual(TEXT("same text"), HelperStringifyJSON(serial, false, true), HelperStringifyJSON(serial));
+		TestEqual(TEXT("same pretty text"), HelperStringifyJSON(serial, true, true), HelperStringifyJSON(serial, true));
+
+		TArray<uint8> serialBytes, parallelBytes;
+		HelperStringifyJSONUTF8(serial, serialBytes, true);
+		HelperStringifyJSONUTF8(serial, parallelBytes, true, true);
+		TestTrue(TEXT("same UTF-8"), serialBytes == parallelBytes);
+
+		FTCHARToUTF8 utf8(*json);
+		TSharedPtr<FJsonValue> fromBytes = HelperParseJSONUTF8(TArrayView<const uint8>((const uint8*)utf8.Get(), utf8.Length()), true);
+		TestEqual(TEXT("UTF-8 parse"), fromBytes.IsValid() ? HelperStringifyJSON(fromBytes) : FString(), HelperStringifyJSON(serial));
+	}
+
+	TestFalse(TEXT("trailing comma"), HelperParseJSON(array.Replace(TEXT("] "), TEXT(",]")), true).IsValid());
+	TestFalse(TEXT("invalid item"), HelperParseJSON(array.Replace(TEXT("\"id\":7,"), TEXT("\"id\":7,,")), true).IsValid());
+	TestFalse(TEXT("mismatched bracket"), HelperParseJSON(array.Replace(TEXT("] "), TEXT("} ")), true).IsValid());
+
+	pMinLength->Set(oldMinLength, ECVF_SetByCode);
+	pMinItems->Set(oldMinItems, ECVF_SetByCode);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPNumberTest, "JsonBP.Numbers", JsonBPTestFlags)
+bool FJsonBPNumberTest::RunTest(const FString& Parameters)
+{
+	const TCHAR* roundTrips[] = { TEXT("9223372036854775807"), TEXT("-9223372036854775808"), TEXT("1700000000123"), TEXT("0.1"),
+		TEXT("0.30000000000000004"), TEXT("1.5e+300"), TEXT("-0") };
+	for (const TCHAR* json : roundTrips)
+	{
+		UJsonValue* pValue = UJsonValue::MakeFromString(json);
+		if (TestNotNull(json, pValue))
+			TestEqual(json, pValue->ToString(false), FString(json));
+	}
+
+	int64 integer = 0;
+	UJsonValue* pId = UJsonValue::MakeFromString(TEXT("1234567890123456789"));
+	TestTrue(TEXT("int64 is exact"), pId && pId->IsInteger() && pId->GetValueAsInteger(integer) && integer == 1234567890123456789ll);
+	TestEqual(TEXT("float from blueprint"), UJsonValue::MakeNumber(0.1f)->ToString(false), FString(TEXT("0.1")));
+	TestEqual(TEXT("integer"), UJsonValue::MakeInteger(-42)->ToString(false), FString(TEXT("-42")));
+
+	//a short array isn't packed, its integers stay integers next to a fraction
+	UJsonValue* pMixed = UJsonValue::MakeFromString(TEXT("[1,2.5]"));
+	TestTrue(TEXT("short mixed array"), pMixed && !pMixed->IsPacked() && pMixed->GetArrayElement(0)->IsInteger() && !pMixed->GetArrayElement(1)->IsInteger());
+	TestEqual(TEXT("short mixed array text"), pMixed ? pMixed->ToString(false) : FString(), FString(TEXT("[1,2.5]")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPAccessTest, "JsonBP.Access", JsonBPTestFlags)
+bool FJsonBPAccessTest::RunTest(const FString& Parameters)
+{
+	UJsonValue* pRoot = UJsonValue::MakeFromString(TEXT(R"({"a":[10,{"b":"x"}],"c~/":1})"));
+	if (!TestNotNull(TEXT("root"), pRoot))
+		return false;
+
+	TestEqual(TEXT("field count"), pRoot->GetFieldCount(), 2);
+	TestTrue(TEXT("has field"), pRoot->HasField(TEXT("a")));
+	TestEqual(TEXT("array length"), pRoot->GetFieldValue(TEXT("a"))->GetArrayLength(), 2);
+
+	FString value;
+	UJsonValue* pFound = pRoot->FindByPath(TEXT("/a/1/b"));
+	TestTrue(TEXT("json pointer"), pFound && pFound->GetValueAsString(value) && value == TEXT("x"));
+	TestNotNull(TEXT("escaped pointer"), pRoot->FindByPath(TEXT("/c~0~1")));
+	TestTrue(TEXT("json path"), pRoot->FindByPath(TEXT("$.a[-1].b")) == pFound);
+	TestNull(TEXT("missing"), pRoot->FindByPath(TEXT("/a/5")));
+
+	TestTrue(TEXT("set field"), pRoot->SetFieldInteger(TEXT("d"), 5));
+	TestTrue(TEXT("remove field"), pRoot->RemoveField(TEXT("c~/")));
+	TestTrue(TEXT("add element"), pRoot->GetFieldValue(TEXT("a"))->AddArrayElement(UJsonValue::MakeNull()));
+	TestEqual(TEXT("after mutation"), UJsonValue::MakeFromString(pRoot->ToString(false))->GetFieldCount(), 2);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPKeyTest, "JsonBP.Keys", JsonBPTestFlags)
+bool FJsonBPKeyTest::RunTest(const FString& Parameters)
+{
+	const FJsonBPKey key(TEXT("JsonBP.Keys.Interned"));
+	TestTrue(TEXT("same string same key"), key == FJsonBPKey(FString(TEXT("JsonBP.Keys.Interned"))));
+	TestTrue(TEXT("find"), FJsonBPKey::Find(TEXT("JsonBP.Keys.Interned")) == key);
+	TestFalse(TEXT("never interned"), FJsonBPKey::Find(TEXT("JsonBP.Keys.NeverUsed")).IsValid());
+	TestEqual(TEXT("string"), key.ToString(), FString(TEXT("JsonBP.Keys.Interned")));
+
+	//keys too long for the table keep their own string and still work as object keys
+	const FString longName = FString::ChrN(300, TEXT('k'));
+	const int32 numKeys = FJsonBPKey::GetNumKeys();
+	const FJsonBPKey longKey(longName);
+	TestTrue(TEXT("long key not interned"), longKey.IsValid() && !longKey.IsInterned() && FJsonBPKey::GetNumKeys() == numKeys);
+	TestTrue(TEXT("long key equal"), longKey == FJsonBPKey::Find(longName) && GetTypeHash(longKey) == GetTypeHash(FJsonBPKey(longName)));
+	TestEqual(TEXT("long key string"), longKey.ToString(), longName);
+	UJsonValue* pLong = UJsonValue::MakeFromString(FString::Printf(TEXT("{\"%s\":7}"), *longName));
+	int64 longValue = 0;
+	TestTrue(TEXT("long key lookup"), pLong && pLong->GetFieldValue(longName) && pLong->GetFieldValue(longName)->GetValueAsInteger(longValue) && longValue == 7);
+
+	//json keys are case sensitive
+	UJsonValue* pObject = UJsonValue::MakeFromString(TEXT(R"([{"id":1,"Id":2},{"id":3,"Id":4}])"));
+	if (!TestNotNull(TEXT("records"), pObject))
+		return false;
+
+	UJsonValue* pRecord = pObject->GetArrayElement(1);
+	TestEqual(TEXT("case sensitive fields"), pRecord->GetFieldCount(), 2);
+	int64 id = 0;
+	TestTrue(TEXT("lookup by key"), pRecord->GetFieldValue(FJsonBPKey(TEXT("Id")))->GetValueAsInteger(id) && id == 4);
+	TestTrue(TEXT("records share keys"), pObject->GetArrayElement(0)->GetObjectRef().Contains(FJsonBPKey::Find(TEXT("id"))));
+	TestEqual(TEXT("key order"), pObject->ToString(false), FString(TEXT(R"([{"id":1,"Id":2},{"id":3,"Id":4}])")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPDocumentTest, "JsonBP.Document", JsonBPTestFlags)
+bool FJsonBPDocumentTest::RunTest(const FString& Parameters)
+{
+	const FString json = TEXT(R"({"name":"doc","list":[1,2.5,true,null],"nested":{"id":9007199254740993}})");
+	UJsonDocument* pDocument = UJsonDocument::MakeDocumentFromString(json);
+	if (!TestNotNull(TEXT("document"), pDocument))
+		return false;
+
+	const FJsonNode root = pDocument->GetRoot();
+	TestTrue(TEXT("type"), UJsonDocument::GetNodeType(root) == EJsonType::JSON_Object);
+	TestEqual(TEXT("list length"), UJsonDocument::GetNodeLength(UJsonDocument::GetNodeField(root, TEXT("list"))), 4);
+
+	int64 id = 0;
+	TestTrue(TEXT("int64 field"), UJsonDocument::GetNodeAsInteger(UJsonDocument::GetNodeField(UJsonDocument::GetNodeField(root, TEXT("nested")), TEXT("id")), id) && id == 9007199254740993ll);
+	TestEqual(TEXT("document text"), UJsonDocument::NodeToString(root, false), json);
+	TestEqual(TEXT("as json value"), UJsonDocument::NodeToJsonValue(root)->GetFieldCount(), 3);
+
+	//a repeated key reads as its last value everywhere, small objects and ones checked through key hashes
+	FString repeated = TEXT(R"({"a":1,"b":2,"a":3})");
+	FString repeatedWide = TEXT("{");
+	for (int32 i = 0; i < 20; i++)
+		repeatedWide += FString::Printf(TEXT("\"k%d\":%d,"), i, i);
+	repeatedWide += TEXT("\"k3\":30}");
+	for (const FString& text : { repeated, repeatedWide })
+	{
+		const TCHAR* key = text == repeated ? TEXT("a") : TEXT("k3");
+		const int64 expected = text == repeated ? 3 : 30;
+		UJsonValue* pValue = UJsonValue::MakeFromString(text);
+		UJsonValue* pLazy = UJsonValue::MakeLazyFromString(text);
+		UJsonDocument* pRepeated = UJsonDocument::MakeDocumentFromString(text);
+		int64 fromValue = 0, fromDocument = 0;
+		TestTrue(TEXT("value keeps the last"), pValue && pValue->GetFieldValueInteger(key, fromValue) && fromValue == expected);
+		TestTrue(TEXT("document keeps the last"), pRepeated && UJsonDocument::GetNodeAsInteger(UJsonDocument::GetNodeField(pRepeated->GetRoot(), key), fromDocument) && fromDocument == expected);
+		TestEqual(TEXT("lazy count matches"), pLazy ? pLazy->GetFieldCount() : -1, pValue ? pValue->GetFieldCount() : -2);
+	}
+
+	//the async stringify snapshot writes what ToString writes, packed and lazy values stay as they are
+	auto snapshot = [](const UJsonValue* pValue)
+	{
+		FJsonBPDocumentData data;
+		data.Assign(pValue);
+		FString text;
+		if (data.Root != INDEX_NONE)
+		{
+			TJsonBPWriter<TCHAR> writer(text.GetCharArray(), false);
+			data.WriteTo(writer, data.Root);
+			text.GetCharArray().Add(TEXT('\0'));
+		}
+		return text;
+	};
+	FString listJson = TEXT(R"({"s":"x","list":[)");
+	for (int32 i = 0; i < 20; i++)
+		listJson += FString::Printf(i ? TEXT(",%d") : TEXT("%d"), i);
+	listJson += TEXT("]}");
+	UJsonValue* pWithPacked = UJsonValue::MakeFromString(listJson);
+	UJsonValue* pLazyList = UJsonValue::MakeLazyFromString(listJson);
+	if (TestTrue(TEXT("snapshot sources"), pWithPacked && pLazyList && pWithPacked->GetFieldValue(TEXT("list"))->IsPacked()))
+	{
+		TestEqual(TEXT("snapshot of packed"), snapshot(pWithPacked), pWithPacked->ToString(false));
+		TestTrue(TEXT("snapshot keeps packed"), pWithPacked->GetFieldValue(TEXT("list"))->IsPacked());
+		TestEqual(TEXT("snapshot of lazy"), snapshot(pLazyList), listJson);
+		TestTrue(TEXT("snapshot keeps lazy"), pLazyList->IsLazy());
+	}
+	TestEqual(TEXT("snapshot of none"), snapshot(MakeJsonValue()), MakeJsonValue()->ToString(false));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPLazyTest, "JsonBP.Lazy", JsonBPTestFlags)
+bool FJsonBPLazyTest::RunTest(const FString& Parameters)
+{
+	const FString json = TEXT(R"({"players":[{"id":1,"name":"a"},{"id":2,"name":"b"}],"region":"eu","empty":[],"meta":{"v":3}})");
+	UJsonValue* pValue = UJsonValue::MakeLazyFromString(json);
+	if (!TestNotNull(TEXT("lazy value"), pValue))
+		return false;
+
+	TestTrue(TEXT("root not expanded"), pValue->IsLazy());
+	TestEqual(TEXT("field count without expanding"), pValue->GetFieldCount(), 4);
+	TestEqual(TEXT("written from the document"), pValue->ToString(false), json);
+	TestTrue(TEXT("still not expanded"), pValue->IsLazy());
+
+	FString region;
+	TestTrue(TEXT("field"), pValue->GetFieldValueString(TEXT("region"), region) && region == TEXT("eu"));
+	TestFalse(TEXT("root expanded"), pValue->IsLazy());
+	UJsonValue* pPlayers = pValue->GetFieldValue(TEXT("players"));
+	TestTrue(TEXT("children stay lazy"), pPlayers && pPlayers->IsLazy() && pValue->GetFieldValue(TEXT("meta"))->IsLazy());
+	TestFalse(TEXT("empty containers are never lazy"), pValue->GetFieldValue(TEXT("empty"))->IsLazy());
+	TestEqual(TEXT("array length without expanding"), pPlayers->GetArrayLength(), 2);
+
+	int64 id = 0;
+	TestTrue(TEXT("nested"), pPlayers->GetArrayElement(1)->GetFieldValueInteger(TEXT("id"), id) && id == 2);
+	TestTrue(TEXT("path"), pValue->FindByPath(TEXT("/meta/v")) != nullptr);
+
+	pPlayers->AddArrayElement(UJsonValue::MakeNull());
+	TestEqual(TEXT("mutated"), pValue->ToString(false), FString(TEXT(R"({"players":[{"id":1,"name":"a"},{"id":2,"name":"b"},null],"region":"eu","empty":[],"meta":{"v":3}})")));
+	TestNull(TEXT("invalid"), UJsonValue::MakeLazyFromString(TEXT("{\"a\":")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPPoolTest, "JsonBP.Pool", JsonBPTestFlags)
+bool FJsonBPPoolTest::RunTest(const FString& Parameters)
+{
+	UJsonValuePool* pPool = UJsonValuePool::MakeJsonValuePool(16);
+	pPool->AddToRoot();
+
+	const FString json = TEXT(R"({"a":[1,2,{"b":null}],"c":"d"})");
+	UJsonValue* pFirst;
+	{
+		FJsonValuePoolScope scope(pPool);
+		TestTrue(TEXT("active"), UJsonValuePool::GetActivePool() == pPool);
+		pFirst = UJsonValue::MakeFromString(json);
+		pFirst->SetFieldString(TEXT("e"), TEXT("f"));
+	}
+	TestNull(TEXT("inactive after the scope"), UJsonValuePool::GetActivePool());
+
+	//{} [] 1 2 {} null "d" "f"
+	FJsonValuePoolStats stats = pPool->GetStats();
+	TestEqual(TEXT("all missed"), stats.Misses, 8ll);
+	TestEqual(TEXT("in use"), stats.NumInUse, 8);
+
+	pPool->Reclaim(pFirst);
+	pPool->Reclaim(pFirst);
+	stats = pPool->GetStats();
+	TestEqual(TEXT("reclaimed once"), stats.NumFree, 8);
+	TestEqual(TEXT("none in use"), stats.NumInUse, 0);
+	TestTrue(TEXT("cleared"), pFirst->GetType() == EJsonType::JSON_None);
+
+	{
+		FJsonValuePoolScope scope(pPool);
+		UJsonValue* pSecond = UJsonValue::MakeFromString(json);
+		TestEqual(TEXT("reused values parse the same"), pSecond->ToString(false), json);
+		stats = pPool->GetStats();
+		TestEqual(TEXT("hits"), stats.Hits, 7ll);
+		TestEqual(TEXT("high water mark"), stats.HighWaterMark, 8);
+		pPool->Reclaim(pSecond);
+	}
+
+	//the null keeps the array from being packed, so every element is a value of its own
+	UJsonValue* pLarge = UJsonValue::MakeFromString(TEXT("[null,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19]"));
+	pPool->Reclaim(pLarge);
+	TestEqual(TEXT("free list is capped"), pPool->GetStats().NumFree, 16);
+	TestTrue(TEXT("dropped past the cap"), pPool->GetStats().Dropped > 0);
+
+	pPool->Trim();
+	TestEqual(TEXT("trimmed"), pPool->GetStats().NumFree, 0);
+	pPool->RemoveFromRoot();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPCopyTest, "JsonBP.Copy", JsonBPTestFlags)
+bool FJsonBPCopyTest::RunTest(const FString& Parameters)
+{
+	const FString json = TEXT(R"({"a":{"b":1},"c":[1,2]})");
+	UJsonValue* pSource = UJsonValue::MakeFromString(json);
+
+	UJsonValue* pDeep = pSource->DeepCopy();
+	pDeep->GetFieldValue(TEXT("a"))->SetFieldString(TEXT("b"), TEXT("x"));
+	TestEqual(TEXT("deep copy is independent"), pSource->ToString(false), json);
+	TestTrue(TEXT("deep copy has new children"), pDeep->GetFieldValue(TEXT("c")) != pSource->GetFieldValue(TEXT("c")));
+
+	UJsonValue* pShallow = pSource->ShallowCopy();
+	TestTrue(TEXT("shallow copy shares children"), pShallow->GetFieldValue(TEXT("c")) == pSource->GetFieldValue(TEXT("c")));
+
+	UJsonValue* pMoved = UJsonValue::MakeNull();
+	TestTrue(TEXT("move"), pMoved->MoveFrom(pDeep));
+	TestTrue(TEXT("moved from is empty"), pDeep->GetType() == EJsonType::JSON_None);
+	TestEqual(TEXT("moved"), pMoved->ToString(false), FString(TEXT(R"({"a":{"b":"x"},"c":[1,2]})")));
+
+	UJsonValue* pTemplate = UJsonValue::MakeFromString(json);
+	UJsonValue* pFirst = pTemplate->CopyOnWrite();
+	UJsonValue* pSecond = pTemplate->CopyOnWrite();
+	TestTrue(TEXT("template is shared"), pTemplate->IsShared());
+	TestFalse(TEXT("copy is not shared"), pFirst->IsShared());
+
+	pFirst->GetFieldValue(TEXT("a"))->SetFieldNumber(TEXT("b"), 2);
+	TestEqual(TEXT("changed copy"), pFirst->ToString(false), FString(TEXT(R"({"a":{"b":2},"c":[1,2]})")));
+	TestEqual(TEXT("other copy unchanged"), pSecond->ToString(false), json);
+	TestEqual(TEXT("template unchanged"), pTemplate->ToString(false), json);
+	//reading c through the copy would give the copy its own c, so this looks at the template side
+	TestTrue(TEXT("template children stay shared"), pTemplate->GetFieldValue(TEXT("c"))->IsShared());
+
+	//paths reach the same writable copies as GetFieldValue
+	UJsonValue* pThird = pTemplate->CopyOnWrite();
+	UJsonValue* pFound = pThird->FindByPath(TEXT("/a"));
+	TestTrue(TEXT("edit through FindByPath"), pFound && pFound->SetFieldNumber(TEXT("b"), 3));
+	pFound = pThird->FindByPath(TEXT("$.*[0]"));
+	TestTrue(TEXT("wildcard finds a copy"), pFound && !pFound->IsShared());
+	if (pFound)
+		pFound->SetValueInteger(4);
+	TestEqual(TEXT("edited through paths"), pThird->ToString(false), FString(TEXT(R"({"a":{"b":3},"c":[4,2]})")));
+	TestEqual(TEXT("template unchanged by paths"), pTemplate->ToString(false), json);
+
+	AddExpectedError(TEXT("shared json value"), EAutomationExpectedErrorFlags::Contains, 2);
+	TestFalse(TEXT("shared value can't be changed"), pTemplate->SetFieldString(TEXT("d"), TEXT("e")));
+	TestFalse(TEXT("shared value can't be moved into"), pTemplate->MoveFrom(pMoved));
+	TestEqual(TEXT("template still unchanged"), pTemplate->ToString(false), json);
+
+	UJsonValue* pLazy = UJsonValue::MakeLazyFromString(json);
+	UJsonValue* pLazyCopy = pLazy->CopyOnWrite();
+	pLazyCopy->GetFieldValue(TEXT("c"))->AddArrayElement(UJsonValue::MakeNumber(3));
+	TestEqual(TEXT("lazy copy on write"), pLazyCopy->ToString(false), FString(TEXT(R"({"a":{"b":1},"c":[1,2,3]})")));
+	TestEqual(TEXT("lazy template unchanged"), pLazy->ToString(false), json);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPSchemaTest, "JsonBP.Schema", JsonBPTestFlags)
+bool FJsonBPSchemaTest::RunTest(const FString& Parameters)
+{
+	FString error;
+	UJsonSchema* pSchema = UJsonSchema::CompileSchemaFromString(TEXT(R"({
+		"type": "object",
+		"required": ["id", "name"],
+		"additionalProperties": false,
+		"properties": {
+			"id": { "type": "integer", "minimum": 1 },
+			"name": { "type": "string", "minLength": 1, "pattern": "^[a-z]+$" },
+			"kind": { "enum": ["a", "b", [1]] },
+			"tags": { "type": "array", "maxItems": 2, "items": { "type": "string" } }
+		}
+	})"), error);
+	TestNotNull(TEXT("compiled"), pSchema);
+	if (!pSchema)
+		return false;
+
+	const FString valid = TEXT(R"({"id":3,"name":"abc","kind":[1],"tags":["x"]})");
+	TArray<FJsonSchemaError> errors;
+	TestTrue(TEXT("valid value"), pSchema->Validate(UJsonValue::MakeFromString(valid), errors));
+	TestTrue(TEXT("valid text"), pSchema->ValidateString(valid, errors));
+	UJsonValue* pParsed = pSchema->ParseValidated(valid, errors);
+	TestTrue(TEXT("parse validated"), pParsed && pParsed->ToString(false) == valid);
+
+	//the same errors from a tree and from text
+	const FString invalid = TEXT(R"({"id":1.5,"name":"A","kind":"c","tags":["x",2,"z"],"extra":null})");
+	TArray<FJsonSchemaError> textErrors;
+	TestFalse(TEXT("invalid value"), pSchema->Validate(UJsonValue::MakeFromString(invalid), errors));
+	TestFalse(TEXT("invalid text"), pSchema->ValidateString(invalid, textErrors));
+	TestNull(TEXT("parse validated fails"), pSchema->ParseValidated(invalid, textErrors));
+	TestEqual(TEXT("error count"), errors.Num(), 6);
+	TestEqual(TEXT("same errors from text"), textErrors.Num(), errors.Num());
+
+	auto hasError = [&errors](const TCHAR* location, const TCHAR* keyword)
+	{
+		return errors.ContainsByPredicate([&](const FJsonSchemaError& e) { return e.Location == location && e.Keyword == keyword; });
+	};
+	TestTrue(TEXT("integer"), hasError(TEXT("/id"), TEXT("type")));
+	TestTrue(TEXT("pattern"), hasError(TEXT("/name"), TEXT("pattern")));
+	TestTrue(TEXT("enum"), hasError(TEXT("/kind"), TEXT("enum")));
+	TestTrue(TEXT("max items"), hasError(TEXT("/tags"), TEXT("maxItems")));
+	TestTrue(TEXT("items"), hasError(TEXT("/tags/1"), TEXT("type")));
+	TestTrue(TEXT("additional properties"), hasError(TEXT("/extra"), TEXT("additionalProperties")));
+
+	TestFalse(TEXT("required"), pSchema->ValidateString(TEXT(R"({"id":2})"), errors));
+	TestTrue(TEXT("required location"), errors.Num() == 1 && errors[0].Location.IsEmpty() && errors[0].Keyword == TEXT("required"));
+	TestFalse(TEXT("not json"), pSchema->ValidateString(TEXT("{\"id\":"), errors));
+	TestTrue(TEXT("json error"), errors.Num() == 1 && errors[0].Keyword == TEXT("json"));
+
+	pSchema->SetMaxErrors(1);
+	TestFalse(TEXT("stops early"), pSchema->ValidateString(invalid, errors));
+	TestEqual(TEXT("max errors"), errors.Num(), 1);
+
+	TestNull(TEXT("bad schema"), UJsonSchema::CompileSchemaFromString(TEXT(R"({"properties":{"a":{"type":"text"}}})"), error));
+	TestEqual(TEXT("schema error location"), error, FString(TEXT("/properties/a/type: unknown type")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPTextCacheTest, "JsonBP.TextCache", JsonBPTestFlags)
+bool FJsonBPTextCacheTest::RunTest(const FString& Parameters)
+{
+	UJsonValue* pValue = UJsonValue::MakeFromString(TEXT(R"({"a":{"b":1,"c":[1,2]},"d":{"e":"x"}})"));
+	pValue->SetTextCacheEnabled(true);
+	TestTrue(TEXT("enabled"), pValue->IsTextCacheEnabled());
+	TestEqual(TEXT("first write"), pValue->ToString(false), FString(TEXT(R"({"a":{"b":1,"c":[1,2]},"d":{"e":"x"}})")));
+	TestEqual(TEXT("cached write"), pValue->ToString(false), FString(TEXT(R"({"a":{"b":1,"c":[1,2]},"d":{"e":"x"}})")));
+
+	pValue->GetFieldValue(TEXT("a"))->GetFieldValue(TEXT("c"))->AddArrayElement(UJsonValue::MakeNumber(3));
+	TestEqual(TEXT("nested change"), pValue->ToString(false), FString(TEXT(R"({"a":{"b":1,"c":[1,2,3]},"d":{"e":"x"}})")));
+	pValue->GetFieldValue(TEXT("d"))->GetFieldValue(TEXT("e"))->SetValueString(TEXT("y"));
+	TestEqual(TEXT("scalar change"), pValue->ToString(false), FString(TEXT(R"({"a":{"b":1,"c":[1,2,3]},"d":{"e":"y"}})")));
+
+	//a value in two places is written fresh every time
+	UJsonValue* pShared = UJsonValue::MakeFromString(TEXT("[0]"));
+	pValue->GetFieldValue(TEXT("a"))->SetFieldValue(TEXT("s"), pShared);
+	pValue->GetFieldValue(TEXT("d"))->SetFieldValue(TEXT("s"), pShared);
+	pValue->ToString(false);
+	pShared->SetArrayElement(0, UJsonValue::MakeNumber(5));
+	TestEqual(TEXT("value in two places"), pValue->ToString(false), pValue->DeepCopy()->ToString(false));
+	TestEqual(TEXT("pretty doesn't use the cache"), pValue->ToString(true), pValue->DeepCopy()->ToString(true));
+
+	UJsonValue* pLazy = UJsonValue::MakeLazyFromString(TEXT(R"({"a":[1,2],"b":{"c":true}})"));
+	pLazy->SetTextCacheEnabled(true);
+	pLazy->ToString(false);
+	pLazy->GetFieldValue(TEXT("b"))->SetFieldNull(TEXT("c"));
+	TestEqual(TEXT("lazy tree"), pLazy->ToString(false), FString(TEXT(R"({"a":[1,2],"b":{"c":null}})")));
+
+	pLazy->SetTextCacheEnabled(false);
+	TestFalse(TEXT("disabled"), pLazy->GetFieldValue(TEXT("a"))->IsTextCacheEnabled());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPObjectOrderTest, "JsonBP.ObjectOrder", JsonBPTestFlags)
+bool FJsonBPObjectOrderTest::RunTest(const FString& Parameters)
+{
+	UJsonValue* pSmall = UJsonValue::MakeFromString(TEXT(R"({"z":1,"a":2,"m":3})"));
+	pSmall->RemoveField(TEXT("a"));
+	pSmall->SetFieldNumber(TEXT("b"), 4);
+	pSmall->SetFieldNumber(TEXT("z"), 5);
+	TestEqual(TEXT("insertion order kept"), pSmall->ToString(false), FString(TEXT(R"({"z":5,"m":3,"b":4})")));
+
+	//big enough for the hash index
+	UJsonValue* pBig = UJsonValue::MakeObject(TMap<FString, UJsonValue*>());
+	for (int32 i = 0; i < 40; i++)
+		pBig->SetFieldInteger(FString::Printf(TEXT("f%d"), 39 - i), i);
+	for (int32 i = 0; i < 40; i += 2)
+		pBig->RemoveField(FString::Printf(TEXT("f%d"), i));
+	pBig->SetFieldInteger(TEXT("f0"), 100);
+	FString expected;
+	for (int32 i = 0; i < 40; i++)
+	{
+		if (i % 2 == 0)
+			expected += FString::Printf(TEXT("\"f%d\":%d,"), 39 - i, i);
+	}
+	expected = TEXT("{") + expected + TEXT("\"f0\":100}");
+	TestEqual(TEXT("big object order"), pBig->ToString(false), expected);
+
+	int64 value = 0;
+	TestTrue(TEXT("indexed lookup"), pBig->GetFieldValueInteger(TEXT("f37"), value) && value == 2);
+	TestFalse(TEXT("removed field"), pBig->HasField(TEXT("f38")));
+	TestEqual(TEXT("field count"), pBig->GetFieldCount(), 21);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPPackedTest, "JsonBP.Packed", JsonBPTestFlags)
+bool FJsonBPPackedTest::RunTest(const FString& Parameters)
+{
+	const FString numbers = TEXT("[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,-18,0.5,20]");
+	UJsonValue* pNumbers = UJsonValue::MakeFromString(numbers);
+	TestTrue(TEXT("numbers packed"), pNumbers->IsPacked());
+	TestEqual(TEXT("packed length"), pNumbers->GetArrayLength(), 20);
+	TestEqual(TEXT("packed text"), pNumbers->ToString(false), numbers);
+
+	TArray<float> floats;
+	TestTrue(TEXT("bulk get"), pNumbers->GetValueAsNumberArray(floats) && floats.Num() == 20 && floats[18] == 0.5f);
+	TArray<FString> strings;
+	TestFalse(TEXT("not strings"), pNumbers->GetValueAsStringArray(strings));
+
+	double element = 0;
+	TestTrue(TEXT("element"), pNumbers->GetArrayElement(17)->GetValueAsDouble(element) && element == -18);
+	TestFalse(TEXT("expanded by element access"), pNumbers->IsPacked());
+	TestEqual(TEXT("expanded text"), pNumbers->ToString(false), numbers);
+
+	TestFalse(TEXT("mixed array"), UJsonValue::MakeFromString(TEXT("[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,\"a\"]"))->IsPacked());
+	TestFalse(TEXT("short array"), UJsonValue::MakeFromString(TEXT("[1,2,3]"))->IsPacked());
+
+	UJsonValue* pStrings = UJsonValue::MakeStringArray({ TEXT("a"), TEXT("b\"c") });
+	TestEqual(TEXT("string array text"), pStrings->ToString(false), FString(TEXT(R"(["a","b\"c"])")));
+	TestTrue(TEXT("string array"), pStrings->GetValueAsStringArray(strings) && strings.Num() == 2 && strings[1] == TEXT("b\"c"));
+
+	TArray<int32> integers = { 3, -1, 2000000000 };
+	TestEqual(TEXT("helper array"), HelperStringifyJSON(HelperToJSON(integers)), FString(TEXT("[3,-1,2000000000]")));
+	TestTrue(TEXT("cpp version stays packed"), UJsonValue::MakeFromCPPVersion(HelperToJSON(integers))->IsPacked());
+	TestEqual(TEXT("cpp version elements"), HelperToJSON(integers)->AsArray().Num(), 3);
+	TestTrue(TEXT("packed found"), FJsonBPValuePacked::Find(HelperToJSON(integers)) != nullptr);
+	TestNull(TEXT("plain array not packed"), FJsonBPValuePacked::Find(MakeShared<FJsonValueArray>(TArray<TSharedPtr<FJsonValue>>())));
+
+	UJsonValue* pCopy = UJsonValue::MakeIntegerArray(integers)->DeepCopy();
+	TArray<int32> copied;
+	TestTrue(TEXT("copied"), pCopy->IsPacked() && pCopy->GetValueAsIntegerArray(copied) && copied == integers);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPTypedTest, "JsonBP.Typed", JsonBPTestFlags)
+bool FJsonBPTypedTest::RunTest(const FString& Parameters)
+{
+	TMap<FString, TArray<int32>> map;
+	map.Add(TEXT("a"), TArray<int32>{ 1, -2 });
+	map.Add(TEXT("b"), TArray<int32>());
+	TestEqual(TEXT("map of arrays"), HelperToJSONString(map), FString(TEXT(R"({"a":[1,-2],"b":[]})")));
+
+	TArray<TOptional<float>> optionals = { 0.1f, TOptional<float>() };
+	TestEqual(TEXT("optionals"), HelperValueToJSONString(optionals), FString(TEXT("[0.1,null]")));
+	TestEqual(TEXT("enum by name"), HelperValueToJSONString(EJsonType::JSON_Number), FString(TEXT("\"JSON_Number\"")));
+
+	TMap<int32, TSet<FName>> readMap;
+	TestTrue(TEXT("read map"), HelperJSONStringToValue(TEXT(R"( {"7": ["x", "y", "x"], "-1": []} )"), readMap));
+	TestTrue(TEXT("read map content"), readMap.Num() == 2 && readMap.FindRef(7).Num() == 2 && readMap.FindRef(7).Contains(FName(TEXT("y"))) && readMap.Contains(-1));
+
+	TArray<TOptional<EJsonType>> readEnums;
+	TestTrue(TEXT("read enums"), HelperJSONStringToValue(TEXT(R"(["JSON_Array",null,2])"), readEnums));
+	TestTrue(TEXT("read enums content"), readEnums.Num() == 3 && readEnums[0].GetValue() == EJsonType::JSON_Array && !readEnums[1].IsSet()
+		&& readEnums[2].GetValue() == (EJsonType)2);
+
+	uint8 small = 0;
+	FString error;
+	TestFalse(TEXT("out of range"), HelperJSONStringToValue(TEXT("256"), small, &error));
+	TestFalse(TEXT("error text"), error.IsEmpty());
+	TArray<int64> wrongType;
+	TestFalse(TEXT("wrong type"), HelperJSONStringToValue(TEXT(R"([1,"2"])"), wrongType));
+	double number = 0;
+	TestTrue(TEXT("integer as double"), HelperJSONStringToValue(TEXT("12"), number) && number == 12);
+
+	TArray<uint8> bytes;
+	HelperValueToJSONUTF8(TArray<FString>{ TEXT("\u00e9") }, bytes);
+	TArray<FString> readStrings;
+	TestTrue(TEXT("utf8 round trip"), HelperJSONUTF8ToValue(bytes, readStrings) && readStrings.Num() == 1 && readStrings[0] == TEXT("\u00e9") && bytes.Num() == 6);
+	return true;
+}
+
+#if JSONBP_STATS
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPStatsTest, "JsonBP.Stats", JsonBPTestFlags)
+bool FJsonBPStatsTest::RunTest(const FString& Parameters)
+{
+	//the per frame counters are reset at the end of a frame, a test runs within one
+	const int32 valuesCreated = FJsonBPCounters::ValuesCreated.GetValue();
+	const int32 liveValues = FJsonBPCounters::LiveValues.GetValue();
+	const int32 bytesParsed = FJsonBPCounters::BytesParsed.GetValue();
+	const int32 bytesEmitted = FJsonBPCounters::BytesEmitted.GetValue();
+
+	const FString json = TEXT(R"([1,2,{"a":null}])");
+	UJsonValue* pValue = UJsonValue::MakeFromString(json);
+	TArray<uint8> bytes;
+	pValue->ToUTF8Bytes(false, bytes);
+
+	TestEqual(TEXT("values made"), FJsonBPCounters::ValuesCreated.GetValue() - valuesCreated, 5);
+	TestEqual(TEXT("live values"), FJsonBPCounters::LiveValues.GetValue() - liveValues, 5);
+	TestEqual(TEXT("bytes parsed"), FJsonBPCounters::BytesParsed.GetValue() - bytesParsed, json.Len() * (int32)sizeof(TCHAR));
+	TestEqual(TEXT("bytes written"), FJsonBPCounters::BytesEmitted.GetValue() - bytesEmitted, bytes.Num());
+	return true;
+}
+#endif
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsonBPStructTest, "JsonBP.Struct", JsonBPTestFlags)
+bool FJsonBPStructTest::RunTest(const FString& Parameters)
+{
+	const FVector vector(1.5f, -2.0f, 0.1f);
+	const FString json = HelperStructToJSONString(TBaseStructure<FVector>::Get(), &vector);
+	TestEqual(TEXT("struct to text"), json, FString(TEXT(R"({"X":1.5,"Y":-2,"Z":0.1})")));
+
+	FVector fromText = FVector::ZeroVector;
+	TestTrue(TEXT("text to struct"), HelperJSONStringToStruct(json, TBaseStructure<FVector>::Get(), &fromText));
+	TestEqual(TEXT("text round trip"), fromText, vector);
+
+	FVector fromValue = FVector::ZeroVector;
+	UJsonValue* pValue = HelperStructToJSONValue(TBaseStructure<FVector>::Get(), &vector);
+	TestTrue(TEXT("value to struct"), HelperJSONValueToStruct(pValue, TBaseStructure<FVector>::Get(), &fromValue));
+	TestEqual(TEXT("value round trip"), fromValue, vector);
+
+	FIntPoint point(3, 4);
+	TestFalse(TEXT("wrong field type"), HelperJSONStringToStruct(TEXT(R"({"X":"three"})"), TBaseStructure<FIntPoint>::Get(), &point));
+	TestEqual(TEXT("missing fields are kept"), point.Y, 4);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
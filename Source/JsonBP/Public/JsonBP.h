@@ -3,10 +3,20 @@
 #include "Modules/ModuleManager.h"
 #include "CoreMinimal.h"
 #include "Json.h"
+#include "JsonBPKey.h"
+#include "JsonBPObjectMap.h"
+#include "JsonBPPacked.h"
+#include "JsonBPTyped.h"
+#include "UObject/WeakObjectPtrTemplates.h"
 
 
 #include "JsonBP.generated.h"
 
+template<typename CharType> class TJsonBPWriter;
+class FJsonBPMsgPackWriter;
+struct FJsonBPDocumentData;
+class UJsonValue;
+
 
 
 class FJsonBPModule : public IModuleInterface
@@ -16,6 +26,10 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	//publishes the per frame stats
+	FDelegateHandle EndFrameHandle;
 };
 
 UENUM(BlueprintType)
@@ -30,6 +44,19 @@ enum class EJsonType : uint8
 	JSON_Object
 };
 
+//state of a value in a tree that keeps its text, see UJsonValue::SetTextCacheEnabled
+struct FJsonBPTextCache
+{
+	//the container this value was first added to, changes are reported up through it
+	TWeakObjectPtr<UJsonValue> Parent;
+	//compact text of an array/object, scalars are cheap enough to write again
+	FString Text;
+	//Text (or the scalar) is up to date and every child of it is too
+	bool bValid = false;
+	//added to a second container, never cached because only Parent hears about changes
+	bool bMultiParent = false;
+};
+
 /*
 an instance of this class represent a json value (null, boolean, number, string, ...)
 use UJsonValue::Make to create the instances  
@@ -39,18 +66,89 @@ class JSONBP_API UJsonValue : public UObject
 {
 	GENERATED_BODY()
 
+	friend class FJsonBPValueBuilder;
+	friend struct FJsonBPDocumentData;
+	friend class UJsonPath;
+	friend struct FJsonBPValueAccessor;
+	friend class UJsonPatchLibrary;
+	friend class UJsonValuePool;
+	friend class UJsonSchema;
+	friend class FJsonBPSchemaValidator;
+
 private:
 	EJsonType JsonType;
 	bool ValueBool;
 	FString ValueString;	
-	float ValueNumber;
+	//numbers are stored losslessly, integral literals that fit as int64 and everything else as double
+	bool bIntegerNumber;
+	int64 ValueInteger;
+	//set for integers too
+	double ValueNumber;
 	UPROPERTY()
 	TArray<UJsonValue*> ValueArray;
-	UPROPERTY()
-	TMap<FString, UJsonValue*> ValueObject;
+	//keys are interned and kept in the order they were added, not a UPROPERTY because of that. AddReferencedObjects reports the values
+	FJsonBPObjectMap ValueObject;
+	//set while the children of a lazy array/object are not created yet, they are made from this node of the document on first access
+	TSharedPtr<FJsonBPDocumentData, ESPMode::ThreadSafe> LazyDocument;
+	int32 LazyNode;
+	//sitting in the free list of a UJsonValuePool
+	bool bPooled;
+	//part of a read only tree shared by copy on write copies, see CopyOnWrite
+	bool bShared;
+
+	//elements of a packed array, their UJsonValues are made on first access like the children of a lazy container
+	TUniquePtr<FJsonBPPackedElements> Packed;
+
+	//creates the children of a lazy container or packed array. anything touching ValueArray or ValueObject calls this first
+	FORCEINLINE void Expand() const
+	{
+		if (LazyNode != INDEX_NONE)
+			ExpandLazy();
+		else if (Packed)
+			ExpandPacked();
+	}
+	void ExpandLazy() const;
+	void ExpandPacked() const;
+	void SetValuePacked(FJsonBPPackedElements&& elements);
+	//the packed numbers, or the numbers of the elements collected into scratch. null if this isn't an array of only numbers
+	const TArray<double>* GetNumberElements(TArray<double>& scratch) const;
+
+	//false (with a warning) if this value is shared and can't be changed
+	FORCEINLINE bool CanModify() const
+	{
+		return !bShared || ReportSharedModify();
+	}
+	bool ReportSharedModify() const;
+	//a shared child of a value that can change is replaced by a private copy of it before it is handed out
+	UJsonValue* UnshareChild(UJsonValue*& child) const;
+	//copy of this node without its children
+	UJsonValue* CopyNode() const;
+	//set by SetTextCacheEnabled, null for the usual values
+	TUniquePtr<FJsonBPTextCache> TextCache;
+	//a change of this value makes the text of it and of everything above it stale
+	FORCEINLINE void InvalidateText()
+	{
+		if (TextCache)
+			InvalidateTextCache();
+	}
+	void InvalidateTextCache();
+	void EnableTextCache(UJsonValue* parent);
+	//child was added to this container, it joins the cache. children of previousParent are taken over (MoveFrom)
+	void AttachToTextCache(UJsonValue* child, const UJsonValue* previousParent = nullptr);
+	void AttachChildrenToTextCache(const UJsonValue* previousParent = nullptr);
+	//child was removed from this container
+	void DetachFromTextCache(UJsonValue* child);
+	//compact writing that reuses and fills the text caches
+	void WriteCached(TJsonBPWriter<TCHAR>& writer) const;
+	//the recursive parts of ToCPPVersion and MakeFromCPPVersion
+	TSharedPtr<FJsonValue> MakeCPPValue() const;
+	static UJsonValue* MakeFromCPPValue(const TSharedPtr<FJsonValue>& value);
 
 public:
 	UJsonValue();
+	virtual ~UJsonValue();
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 
 
 	
@@ -64,6 +162,14 @@ public:
 	//returns true if this is a json number
 	UFUNCTION(BlueprintPure)
 	bool GetValueAsNumber(float& value);
+	//returns true if this is a json number. integers are exact, fractions are truncated
+	UFUNCTION(BlueprintPure)
+	bool GetValueAsInteger(int64& value) const;
+	//returns true if this is a json number. (double is not supported in blueprint)
+	bool GetValueAsDouble(double& value) const;
+	//returns true if this is a json number stored as int64
+	UFUNCTION(BlueprintPure)
+	bool IsInteger() const { return JsonType == EJsonType::JSON_Number && bIntegerNumber; }
 	//returns true if this is a json array
 	UFUNCTION(BlueprintPure)
 	bool GetValueAsArray(TArray<UJsonValue*>& value);
@@ -71,11 +177,26 @@ public:
 	UFUNCTION(BlueprintPure)
 	bool GetValueAsObject(TMap<FString, UJsonValue*>& value);
 
+	//all elements of an array of numbers at once, false if this is not an array or an element is not a number.
+	//packed arrays (see IsPacked) are copied without making any UJsonValue
+	UFUNCTION(BlueprintPure)
+	bool GetValueAsNumberArray(TArray<float>& values) const;
+	//fractions are truncated
+	UFUNCTION(BlueprintPure)
+	bool GetValueAsIntegerArray(TArray<int32>& values) const;
+	bool GetValueAsDoubleArray(TArray<double>& values) const;
+	//false if this is not an array or an element is not a string
+	UFUNCTION(BlueprintPure)
+	bool GetValueAsStringArray(TArray<FString>& values) const;
+
 	UFUNCTION(BlueprintPure)
 	static UJsonValue* MakeString(const FString& value);
 	UFUNCTION(BlueprintPure)
 	static UJsonValue* MakeNumber(float value);
 	UFUNCTION(BlueprintPure)
+	static UJsonValue* MakeInteger(int64 value);
+	static UJsonValue* MakeDouble(double value);
+	UFUNCTION(BlueprintPure)
 	static UJsonValue* MakeBoolean(bool value);
 	UFUNCTION(BlueprintPure)
 	static UJsonValue* MakeNull();
@@ -83,9 +204,37 @@ public:
 	static UJsonValue* MakeArray(const TArray<UJsonValue*>& value);
 	UFUNCTION(BlueprintPure, meta=(AutoCreateRefTerm="value"))
 	static UJsonValue* MakeObject(const TMap<FString, UJsonValue*>& value);
+	//take the container instead of copying it
+	static UJsonValue* MakeArray(TArray<UJsonValue*>&& value);
+	static UJsonValue* MakeObject(TMap<FString, UJsonValue*>&& value);
+	static UJsonValue* MakeObject(FJsonBPObjectMap&& value);
+	//packed arrays, one UJsonValue holding all the elements
+	UFUNCTION(BlueprintPure, meta=(AutoCreateRefTerm="values"))
+	static UJsonValue* MakeNumberArray(const TArray<float>& values);
+	UFUNCTION(BlueprintPure, meta=(AutoCreateRefTerm="values"))
+	static UJsonValue* MakeIntegerArray(const TArray<int32>& values);
+	static UJsonValue* MakeDoubleArray(TArray<double> values);
+	UFUNCTION(BlueprintPure, meta=(AutoCreateRefTerm="values"))
+	static UJsonValue* MakeStringArray(const TArray<FString>& values);
 	//parse the string and make a json from it. returns null if failed.
 	UFUNCTION(BlueprintPure)
 	static UJsonValue* MakeFromString(const FString& value);
+	//parse UTF-8 text and make a json from it. returns null if failed.
+	static UJsonValue* MakeFromUTF8(const ANSICHAR* text, int32 length);
+	static UJsonValue* MakeFromUTF8(TArrayView<const uint8> bytes);
+	//parse a json file. UTF-8 files are memory mapped and parsed in place, without loading them into a string. returns null if failed.
+	UFUNCTION(BlueprintCallable)
+	static UJsonValue* LoadJsonFromFile(const FString& filePath);
+	//parse the string but create only the root. children of arrays and objects are created level by level the first time they are accessed,
+	//so the values that are never read cost no UObjects. returns null if failed.
+	UFUNCTION(BlueprintPure)
+	static UJsonValue* MakeLazyFromString(const FString& value);
+	static UJsonValue* MakeLazyFromUTF8(const ANSICHAR* text, int32 length);
+	//a lazy value of the node, the document is kept alive until all its containers are expanded
+	static UJsonValue* MakeLazy(const TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe>& document, int32 index);
+	//parse UTF-8 bytes (an http response or file content) without converting them to a string first. returns null if failed or not valid UTF-8.
+	UFUNCTION(BlueprintPure)
+	static UJsonValue* MakeFromUTF8Bytes(const TArray<uint8>& bytes);
 
 	
 	//returns true if this is a json object and field was set.
@@ -96,6 +245,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	bool SetFieldNumber(const FString& field, float value);
 	UFUNCTION(BlueprintCallable)
+	bool SetFieldInteger(const FString& field, int64 value);
+	bool SetFieldDouble(const FString& field, double value);
+	UFUNCTION(BlueprintCallable)
 	bool SetFieldBoolean(const FString& field, bool value);
 	UFUNCTION(BlueprintCallable)
 	bool SetFieldNull(const FString& field);
@@ -103,18 +255,25 @@ public:
 	bool SetFieldArray(const FString& field, const TArray<UJsonValue*>& value);
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "value"))
 	bool SetFieldObject(const FString& field, const TMap<FString, UJsonValue*>& value);
+	bool SetFieldValue(FJsonBPKey field, const UJsonValue* value);
 
 
 
 	//returns the value of the specified field if any.
 	UFUNCTION(BlueprintPure)
 	UJsonValue* GetFieldValue(const FString& field) const;
+	//lookup by an interned key, no string hashing. keep the key around when looking up the same field often
+	UJsonValue* GetFieldValue(FJsonBPKey field) const;
 	//return true if this json object has the specified string field
 	UFUNCTION(BlueprintPure)
 	bool GetFieldValueString(const FString& field, FString& value) const;
 	//return true if this json object has the specified number field
 	UFUNCTION(BlueprintPure)
 	bool GetFieldValueNumber(const FString& field, float& value) const;
+	//return true if this json object has the specified number field
+	UFUNCTION(BlueprintPure)
+	bool GetFieldValueInteger(const FString& field, int64& value) const;
+	bool GetFieldValueDouble(const FString& field, double& value) const;
 	//return true if this json object has the specified boolean field
 	UFUNCTION(BlueprintPure)
 	bool GetFieldValueBoolean(const FString& field, bool& value) const;
@@ -125,6 +284,48 @@ public:
 	UFUNCTION(BlueprintPure)
 	bool GetFieldValueObject(const FString& field, TMap<FString, UJsonValue*>& value) const;
 
+	//number of elements if this is a json array, 0 otherwise
+	UFUNCTION(BlueprintPure)
+	int32 GetArrayLength() const;
+	//element of a json array without copying the array. returns null if out of range
+	UFUNCTION(BlueprintPure)
+	UJsonValue* GetArrayElement(int32 index) const;
+	//returns true if this is a json array and index is valid
+	UFUNCTION(BlueprintCallable)
+	bool SetArrayElement(int32 index, UJsonValue* value);
+	//returns true if this is a json array
+	UFUNCTION(BlueprintCallable)
+	bool AddArrayElement(UJsonValue* value);
+	//returns true if this is a json array and index is valid, index may be the length to add at the end
+	UFUNCTION(BlueprintCallable)
+	bool InsertArrayElement(int32 index, UJsonValue* value);
+	//returns true if this is a json array and index is valid
+	UFUNCTION(BlueprintCallable)
+	bool RemoveArrayElement(int32 index);
+
+	//number of fields if this is a json object, 0 otherwise
+	UFUNCTION(BlueprintPure)
+	int32 GetFieldCount() const;
+	//return true if this json object has the specified field
+	UFUNCTION(BlueprintPure)
+	bool HasField(const FString& field) const;
+	//names of the fields of a json object, the values are not copied
+	UFUNCTION(BlueprintPure)
+	void GetFieldNames(TArray<FString>& names) const;
+	//returns true if this is a json object and the field existed
+	UFUNCTION(BlueprintCallable)
+	bool RemoveField(const FString& field);
+
+	//direct read access for C++, empty if this is not an array/object
+	const TArray<UJsonValue*>& GetArrayRef() const;
+	const FJsonBPObjectMap& GetObjectRef() const;
+	//calls func for each field of a json object
+	void ForEachField(TFunctionRef<void(const FString&, UJsonValue*)> func) const;
+
+	//returns the value at the json pointer ("/a/0") or JSONPath ("$.a[0]"), null if not found. compiled paths are cached, see UJsonPath
+	UFUNCTION(BlueprintPure)
+	UJsonValue* FindByPath(const FString& path);
+
 
 	
 	UFUNCTION(BlueprintCallable)
@@ -134,29 +335,121 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SetValueNumber(float value);
 	UFUNCTION(BlueprintCallable)
+	void SetValueInteger(int64 value);
+	void SetValueDouble(double value);
+	UFUNCTION(BlueprintCallable)
 	void SetValueNull();
 	UFUNCTION(BlueprintCallable)
 	void SetValueArray(const TArray<UJsonValue*>& value);
 	UFUNCTION(BlueprintCallable)
 	void SetValueObject(const TMap<FString, UJsonValue*>& value);
+	//take the container instead of copying it
+	void SetValueArray(TArray<UJsonValue*>&& value);
+	void SetValueObject(TMap<FString, UJsonValue*>&& value);
+	void SetValueObject(FJsonBPObjectMap&& value);
+	//makes this a packed array of the values
+	UFUNCTION(BlueprintCallable)
+	void SetValueNumberArray(const TArray<float>& values);
+	UFUNCTION(BlueprintCallable)
+	void SetValueIntegerArray(const TArray<int32>& values);
+	void SetValueDoubleArray(TArray<double> values);
+	UFUNCTION(BlueprintCallable)
+	void SetValueStringArray(const TArray<FString>& values);
 
 	UFUNCTION(BlueprintCallable)
 	void Clear();
 
+	//a copy of the whole tree, node by node. the copy shares nothing with this and can be changed freely
+	UFUNCTION(BlueprintPure)
+	UJsonValue* DeepCopy() const;
+	//a copy of this value only, the elements/fields point to the same children as this one
+	UFUNCTION(BlueprintPure)
+	UJsonValue* ShallowCopy() const;
+	//takes the content of source without copying it, source is left empty (JSON_None). returns false if source is null, this or shared
+	UFUNCTION(BlueprintCallable)
+	bool MoveFrom(UJsonValue* source);
+
+	/*
+	makes this tree read only and returns a copy sharing it, for reusing a template (a default request body) many times.
+	the copy can be changed: a child reached through GetFieldValue/GetArrayElement of a value that can change is copied
+	(without its children) on that first access, so only the touched path is ever copied. ToString reads the shared nodes directly.
+	changing a shared value fails with a warning, SetFieldValue of a shared value into another tree is safe.
+	*/
+	UFUNCTION(BlueprintCallable)
+	UJsonValue* CopyOnWrite();
+	//makes the whole tree read only, so it can be referenced from many trees
+	UFUNCTION(BlueprintCallable)
+	void MarkShared();
+	//true if this value is part of a read only shared tree
+	UFUNCTION(BlueprintPure)
+	bool IsShared() const { return bShared; }
+
+	/*
+	keeps the compact text of every array/object in this tree, so ToString(false) after a small change writes only the changed values
+	and the path from them to the root again and copies the cached text of everything else.
+	SetValue*, SetField*, Clear and the array/field functions drop the text of the changed value and its parents.
+	the text of each container is kept, so this costs memory about the size of the text per level of nesting.
+	pretty and UTF-8 output don't use the cache. a tree that caches must not be written on several threads at once.
+	a value added to two containers (or to two caching trees) is never cached, neither are its parents.
+	*/
+	UFUNCTION(BlueprintCallable)
+	void SetTextCacheEnabled(bool bEnable);
+	UFUNCTION(BlueprintPure)
+	bool IsTextCacheEnabled() const { return TextCache.IsValid(); }
+
 	UFUNCTION(BlueprintPure)
 	EJsonType GetType() const { return JsonType; }
+	//true if this is an array or object made by MakeLazyFromString whose children are not created yet
+	UFUNCTION(BlueprintPure)
+	bool IsLazy() const { return LazyNode != INDEX_NONE; }
+	/*
+	true if this is an array of only numbers or only strings holding them in one flat array instead of a UJsonValue per element.
+	parsing packs arrays of 16 or more such elements, so do the Make*Array/SetValue*Array functions.
+	the bulk getters (GetValueAsNumberArray...) and the writers read the elements directly, the first access to a single element
+	makes the UJsonValues and the array is an ordinary one from then on. in arrays mixing integers and fractions every number is kept as a double
+	*/
+	UFUNCTION(BlueprintPure)
+	bool IsPacked() const { return Packed.IsValid(); }
 
 	//return an string containing json
 	UFUNCTION(BlueprintPure)
 	FString ToString(bool bPretty) const;
 
+	//writes the json to a UTF-8 file in chunks, the whole text is never in memory. returns false if failed.
+	UFUNCTION(BlueprintCallable)
+	bool SaveJsonToFile(const FString& filePath, bool bPretty) const;
+
+	//json as UTF-8 bytes, written directly without an FString in between
+	UFUNCTION(BlueprintPure)
+	void ToUTF8Bytes(bool bPretty, TArray<uint8>& bytes) const;
+	//appends the UTF-8 json to out
+	void AppendUTF8(TArray<uint8>& out, bool bPretty) const;
+
+	//MessagePack encoding of the json, smaller and faster to read than the text
+	UFUNCTION(BlueprintPure)
+	void ToMsgPack(TArray<uint8>& bytes) const;
+	//makes the same tree MakeFromString makes from the text. returns null if failed.
+	UFUNCTION(BlueprintPure)
+	static UJsonValue* MakeFromMsgPack(const TArray<uint8>& bytes);
+
+	//writes this value to the writer, walking the children directly. (TCHAR, ANSICHAR and uint8 writers are instantiated)
+	template<typename CharType> void WriteTo(TJsonBPWriter<CharType>& writer) const;
+	void WriteTo(FJsonBPMsgPackWriter& writer) const;
+	//a cheap guess of the text length, used to presize output buffers
+	int32 EstimateTextLength(bool bPretty) const;
+
 	TSharedPtr<FJsonValue> ToCPPVersion() const;
 	static UJsonValue* MakeFromCPPVersion(TSharedPtr<FJsonValue> value);
 	
 };
 
-JSONBP_API FString HelperStringifyJSON(TSharedPtr<FJsonValue> jsValue, bool bPretty = false);
-JSONBP_API TSharedPtr<FJsonValue> HelperParseJSON(const FString& jsonValue);
+//bParallel splits a large top level array/object into pieces handled on worker threads with ParallelFor,
+//the result is the same as without it. small inputs (see the JsonBP.Parallel.* console variables) are always done on the calling thread
+JSONBP_API FString HelperStringifyJSON(TSharedPtr<FJsonValue> jsValue, bool bPretty = false, bool bParallel = false);
+JSONBP_API TSharedPtr<FJsonValue> HelperParseJSON(const FString& jsonValue, bool bParallel = false);
+//UTF-8 versions, the bytes are decoded while reading and encoded while writing
+JSONBP_API void HelperStringifyJSONUTF8(TSharedPtr<FJsonValue> jsValue, TArray<uint8>& out, bool bPretty = false, bool bParallel = false);
+JSONBP_API TSharedPtr<FJsonValue> HelperParseJSONUTF8(TArrayView<const uint8> bytes, bool bParallel = false);
 
 
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const uint32 number);
@@ -165,7 +458,14 @@ JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const float number);
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const bool boolean);
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const FString& string);
 JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const FText& string);
+//arrays of numbers and strings become one FJsonBPValuePacked instead of an FJsonValue per element
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<float>& array);
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<double>& array);
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<int>& array);
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<uint32>& array);
+JSONBP_API TSharedPtr<FJsonValue> HelperToJSON(const TArray<FString>& array);
 
+//makes an FJsonValue per element, HelperValueToJSONString (JsonBPTyped.h) writes the text without any
 template<typename TValue> TSharedPtr<FJsonValue> HelperToJSON(const TArray<TValue>& array) 
 {
 	TArray<TSharedPtr<FJsonValue>> elements;
@@ -175,11 +475,8 @@ template<typename TValue> TSharedPtr<FJsonValue> HelperToJSON(const TArray<TValu
 	
 	return MakeShared<FJsonValueArray>(elements);
 }
-template<typename TValue> FString HelperToJSONString(const TMap<FString, TValue>& map)
+//written straight to text by TJsonBPTypeTraits, the values can be anything it supports
+template<typename TValue> FString HelperToJSONString(const TMap<FString, TValue>& map, bool bPretty = false)
 {
-	TSharedPtr<FJsonObject> jsObj = MakeShared<FJsonObject>();
-	for (const auto& mapPair : map) 
-		jsObj->Values.Add(mapPair.Key, HelperToJSON(mapPair.Value));
-
-	return MakeShared<FJsonValueObject>(jsObj);
+	return HelperValueToJSONString(map, bPretty);
 }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "JsonBP.h"
+
+#include "JsonBPAsync.generated.h"
+
+struct FJsonBPAsyncJob;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FJsonParseAsyncDelegate, UJsonValue*, Value);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FJsonStringifyAsyncDelegate, const FString&, Json);
+
+/*
+parses json text on a worker thread, only the UJsonValue objects are created on the game thread.
+at most JsonBP.Async.MaxConcurrentJobs jobs run at the same time, the others wait in a queue.
+*/
+UCLASS()
+class JSONBP_API UJsonParseAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable)
+	FJsonParseAsyncDelegate OnSuccess;
+	//called with null if the text is not valid json
+	UPROPERTY(BlueprintAssignable)
+	FJsonParseAsyncDelegate OnFailure;
+
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "worldContextObject"))
+	static UJsonParseAsyncAction* ParseJsonAsync(UObject* worldContextObject, const FString& json);
+
+	//stops the job if its still running, none of the outputs will be called
+	UFUNCTION(BlueprintCallable)
+	void Cancel();
+
+	virtual void Activate() override;
+
+private:
+	void OnCompleted();
+
+	TSharedPtr<FJsonBPAsyncJob, ESPMode::ThreadSafe> Job;
+};
+
+/*
+writes json text on a worker thread. the UJsonValue tree is copied to a compact FJsonBPDocumentData on the game thread first
+so the worker never touches UObjects.
+*/
+UCLASS()
+class JSONBP_API UJsonStringifyAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable)
+	FJsonStringifyAsyncDelegate OnCompleted;
+
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "worldContextObject"))
+	static UJsonStringifyAsyncAction* StringifyJsonAsync(UObject* worldContextObject, UJsonValue* value, bool bPretty);
+
+	//stops the job if its still running, OnCompleted will not be called
+	UFUNCTION(BlueprintCallable)
+	void Cancel();
+
+	virtual void Activate() override;
+
+private:
+	void OnJobCompleted();
+
+	TSharedPtr<FJsonBPAsyncJob, ESPMode::ThreadSafe> Job;
+	UPROPERTY()
+	UJsonValue* Value;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "JsonBP.h"
+#include "JsonBPWriter.h"
+
+#include "JsonBPDocument.generated.h"
+
+class FJsonBPDocumentBuilder;
+
+/*
+compact json document. all nodes live in one array and all strings in one character pool,
+children of a container are a contiguous range of nodes. no UObjects are involved so it can be built on any thread.
+*/
+struct JSONBP_API FJsonBPDocumentData
+{
+	struct FRange
+	{
+		int32 First;
+		int32 Count;
+	};
+
+	struct FNode
+	{
+		EJsonType Type;
+		//number stored in Integer instead of Number
+		bool bInteger;
+		//object with a key written more than once, the last one is the field like in UJsonValue
+		bool bDuplicateKeys;
+		//name of the node inside its parent object, in the string pool
+		FRange Key;
+		union
+		{
+			bool Bool;
+			double Number;
+			int64 Integer;
+			//characters in the string pool for strings, child nodes for arrays and objects
+			FRange Range;
+		};
+	};
+
+	TArray<FNode> Nodes;
+	TArray<TCHAR> Strings;
+	int32 Root = INDEX_NONE;
+
+	void Reset();
+
+	//parse the text replacing the current content. returns false and fills outError if failed.
+	bool Parse(const TCHAR* text, int32 length, FString* outError = nullptr);
+	bool ParseUTF8(const ANSICHAR* text, int32 length, FString* outError = nullptr);
+
+	bool IsValidIndex(int32 index) const { return Nodes.IsValidIndex(index); }
+	EJsonType GetType(int32 index) const { return Nodes.IsValidIndex(index) ? Nodes[index].Type : EJsonType::JSON_None; }
+	//number of elements or fields, 0 for other types. a repeated key counts every time, as in GetChild
+	int32 Num(int32 index) const;
+	//number of fields of an object the way UJsonValue has them, a repeated key once
+	int32 NumDistinctFields(int32 index) const;
+	FString GetString(int32 index) const;
+	//value of a number node as double or int64, 0 for other types
+	double GetNumber(int32 index) const;
+	int64 GetInteger(int32 index) const;
+	FString GetKey(int32 index) const;
+	//index of the element'th child of an array or object, INDEX_NONE if out of range
+	int32 GetChild(int32 index, int32 element) const;
+	//index of the child with the given key, linear search from the end so a repeated key finds its last value. INDEX_NONE if not found
+	int32 FindField(int32 index, const TCHAR* key, int32 keyLength) const;
+	int32 FindField(int32 index, const FString& key) const { return FindField(index, *key, key.Len()); }
+
+	//creates the UJsonValue tree of the node. game thread only
+	UJsonValue* MakeJsonValue(int32 index) const;
+	//replaces the content with a copy of the UJsonValue tree, packed and lazy values are copied without expanding them.
+	//empty for a JSON_None value, ToString writes nothing for it either. game thread only
+	void Assign(const UJsonValue* pValue);
+
+	template<typename CharType> void WriteTo(TJsonBPWriter<CharType>& writer, int32 index) const
+	{
+		const FNode& node = Nodes[index];
+		switch (node.Type)
+		{
+		case EJsonType::JSON_None:
+		case EJsonType::JSON_Null:
+			writer.WriteNull();
+			break;
+		case EJsonType::JSON_String:
+			writer.WriteString(Strings.GetData() + node.Range.First, node.Range.Count);
+			break;
+		case EJsonType::JSON_Number:
+			if (node.bInteger)
+				writer.WriteInteger(node.Integer);
+			else
+				writer.WriteNumber(node.Number);
+			break;
+		case EJsonType::JSON_Boolean:
+			writer.WriteBoolean(node.Bool);
+			break;
+		case EJsonType::JSON_Array:
+			writer.BeginArray();
+			for (int32 i = 0; i < node.Range.Count; i++)
+				WriteTo(writer, node.Range.First + i);
+			writer.EndArray();
+			break;
+		case EJsonType::JSON_Object:
+			writer.BeginObject();
+			for (int32 i = 0; i < node.Range.Count; i++)
+			{
+				const FNode& child = Nodes[node.Range.First + i];
+				writer.WriteKey(Strings.GetData() + child.Key.First, child.Key.Count);
+				WriteTo(writer, node.Range.First + i);
+			}
+			writer.EndObject();
+			break;
+		}
+	}
+
+	//a cheap guess of the text length of the node, like UJsonValue::EstimateTextLength
+	int32 EstimateTextLength(int32 index, bool bPretty) const;
+
+	SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize() + Strings.GetAllocatedSize(); }
+
+private:
+	static bool FeedJsonValue(FJsonBPDocumentBuilder& builder, const UJsonValue* pValue);
+	static bool FeedDocumentNode(FJsonBPDocumentBuilder& builder, const FJsonBPDocumentData& source, int32 index);
+};
+
+class UJsonDocument;
+
+/*
+lightweight handle to a node of a UJsonDocument. keeps the document alive.
+*/
+USTRUCT(BlueprintType)
+struct JSONBP_API FJsonNode
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UJsonDocument* Document = nullptr;
+	UPROPERTY()
+	int32 Index = INDEX_NONE;
+};
+
+/*
+a parsed json document stored as a FJsonBPDocumentData.
+parsing a large document costs a few allocations and a single UObject, nodes are accessed through FJsonNode handles.
+*/
+UCLASS(BlueprintType, Transient, NotBlueprintable)
+class JSONBP_API UJsonDocument : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UJsonDocument();
+
+	//parse the string into a document. returns null if failed.
+	UFUNCTION(BlueprintPure)
+	static UJsonDocument* MakeDocumentFromString(const FString& value);
+	static UJsonDocument* MakeDocumentFromUTF8(const ANSICHAR* text, int32 length);
+	//parse a json file into a document, memory mapped like UJsonValue::LoadJsonFromFile. returns null if failed.
+	UFUNCTION(BlueprintCallable)
+	static UJsonDocument* LoadDocumentFromFile(const FString& filePath);
+	//wraps already built data
+	static UJsonDocument* MakeDocument(TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> data);
+
+	UFUNCTION(BlueprintPure)
+	FJsonNode GetRoot();
+
+	//returns false if the handle doesn't point to a node
+	UFUNCTION(BlueprintPure)
+	static bool IsValidNode(const FJsonNode& node);
+	UFUNCTION(BlueprintPure)
+	static EJsonType GetNodeType(const FJsonNode& node);
+	//returns true if the node is a json string
+	UFUNCTION(BlueprintPure)
+	static bool GetNodeAsString(const FJsonNode& node, FString& value);
+	//returns true if the node is a json number
+	UFUNCTION(BlueprintPure)
+	static bool GetNodeAsNumber(const FJsonNode& node, float& value);
+	//returns true if the node is a json number, fractions are truncated
+	UFUNCTION(BlueprintPure)
+	static bool GetNodeAsInteger(const FJsonNode& node, int64& value);
+	//returns true if the node is a json boolean
+	UFUNCTION(BlueprintPure)
+	static bool GetNodeAsBoolean(const FJsonNode& node, bool& value);
+	//number of elements of an array or fields of an object
+	UFUNCTION(BlueprintPure)
+	static int32 GetNodeLength(const FJsonNode& node);
+	//element of an array. returns an invalid handle if out of range
+	UFUNCTION(BlueprintPure)
+	static FJsonNode GetNodeElement(const FJsonNode& node, int32 index);
+	//field of an object. returns an invalid handle if not found
+	UFUNCTION(BlueprintPure)
+	static FJsonNode GetNodeField(const FJsonNode& node, const FString& field);
+	//index'th field of an object with its name, for iterating
+	UFUNCTION(BlueprintPure)
+	static FJsonNode GetNodeFieldAt(const FJsonNode& node, int32 index, FString& field);
+
+	//creates a UJsonValue tree from the node
+	UFUNCTION(BlueprintPure)
+	static UJsonValue* NodeToJsonValue(const FJsonNode& node);
+	//return an string containing json of the node
+	UFUNCTION(BlueprintPure)
+	static FString NodeToString(const FJsonNode& node, bool bPretty);
+
+	const FJsonBPDocumentData& GetData() const { return *Data; }
+	TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> GetDataRef() const { return Data; }
+
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+private:
+	static const FJsonBPDocumentData* GetNodeData(const FJsonNode& node);
+
+	TSharedRef<FJsonBPDocumentData, ESPMode::ThreadSafe> Data;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+an interned json object key. every distinct key string is stored once in a table owned by the plugin,
+so objects sharing the same field names share the strings and keys compare and hash as integers.
+keys are case sensitive, as json requires. like FName, interned strings are never freed.
+the table is capped (number of keys, total length and length of one key), keys that don't fit once it is full
+keep their own string instead, so untrusted documents can't grow it without bound.
+*/
+struct JSONBP_API FJsonBPKey
+{
+	FJsonBPKey() : Id(INDEX_NONE) {}
+	//interns the string, or keeps a copy of it if the table can't take it
+	explicit FJsonBPKey(const FString& key) : FJsonBPKey(*key, key.Len()) {}
+	FJsonBPKey(const TCHAR* key, int32 length);
+
+	//the key if the string can be in an object, an invalid key otherwise. lookups use this so they don't grow the table
+	static FJsonBPKey Find(const FString& key) { return Find(*key, key.Len()); }
+	static FJsonBPKey Find(const TCHAR* key, int32 length);
+	//number of distinct keys interned so far
+	static int32 GetNumKeys();
+
+	bool IsValid() const { return Id != INDEX_NONE || Owned.IsValid(); }
+	//false for keys that didn't fit in the table
+	bool IsInterned() const { return Id != INDEX_NONE; }
+	//the interned string, or the key's own copy, empty for an invalid key.
+	//an interned string stays valid for the lifetime of the module, an owned one for the lifetime of the key
+	const FString& ToString() const;
+
+	//a string that didn't fit in the table never will, so an interned key and an owned key are never the same string
+	bool operator == (const FJsonBPKey& other) const
+	{
+		return Id == other.Id && (Owned == other.Owned || (Owned.IsValid() && other.Owned.IsValid() && Owned->Equals(*other.Owned, ESearchCase::CaseSensitive)));
+	}
+	bool operator != (const FJsonBPKey& other) const { return !(*this == other); }
+	friend uint32 GetTypeHash(const FJsonBPKey& key) { return key.Owned.IsValid() ? key.HashOwned() : (uint32)key.Id; }
+
+private:
+	uint32 HashOwned() const;
+
+	int32 Id;
+	//only set when the table was full
+	TSharedPtr<const FString, ESPMode::ThreadSafe> Owned;
+};
@@ -0,0 +1,265 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "JsonBPReader.h"
+#include "JsonBPWriter.h"
+
+/*
+MessagePack writer, the binary counterpart of TJsonBPWriter. containers are written with their size up front:
+
+	FJsonBPMsgPackWriter writer(bytes);
+	writer.BeginObject(1);
+	writer.WriteKey(TEXT("id"));
+	writer.WriteInteger(12);
+
+integers take the smallest MessagePack integer type, doubles are written as float32 when that is exact.
+strings are UTF-8, lone surrogates are written as U+FFFD.
+*/
+class JSONBP_API FJsonBPMsgPackWriter
+{
+public:
+	explicit FJsonBPMsgPackWriter(TArray<uint8>& out) : Out(out) {}
+
+	void WriteNull();
+	void WriteBoolean(bool value);
+	void WriteNumber(double value);
+	void WriteInteger(int64 value);
+	void WriteString(const TCHAR* value, int32 length);
+	void WriteString(const FString& value) { WriteString(*value, value.Len()); }
+	//the key goes right before its value
+	void WriteKey(const TCHAR* key, int32 length) { WriteString(key, length); }
+	void WriteKey(const FString& key) { WriteString(*key, key.Len()); }
+	//followed by count values
+	void BeginArray(int32 count);
+	//followed by count keys, each with its value
+	void BeginObject(int32 count);
+
+	TArray<uint8>& GetOutput() { return Out; }
+
+private:
+	void WriteHeader(uint32 count, uint8 fixCode, uint32 fixLimit, uint8 code8, uint8 code16, uint8 code32);
+	void AppendBigEndian(uint64 value, int32 numBytes);
+
+	TArray<uint8>& Out;
+};
+
+/*
+MessagePack reader reporting values to the same handlers as TJsonBPReader, so every builder works with both.
+integers are reported by OnInteger (uint64 values past the int64 range by OnNumber), floats by OnNumber,
+map keys must be strings. binary, extension and timestamp types are not part of json and are rejected.
+*/
+class FJsonBPMsgPackReader
+{
+public:
+	//deeper documents are rejected instead of blowing the stack
+	static constexpr int32 MaxDepth = 512;
+
+	FJsonBPMsgPackReader(const uint8* data, int32 length)
+		: Begin(data), Cur(data), End(data + length), Depth(0), ErrorMessage(nullptr), ErrorOffset(INDEX_NONE)
+	{
+	}
+
+	//reads exactly one value, nothing is allowed after it
+	template<typename HandlerType> bool ReadDocument(HandlerType& handler)
+	{
+		if (!ReadValue(handler))
+			return false;
+
+		if (Cur != End)
+			return SetError(TEXT("unexpected bytes after the value"));
+
+		return true;
+	}
+
+	template<typename HandlerType> bool ReadValue(HandlerType& handler)
+	{
+		if (Cur == End)
+			return SetError(TEXT("unexpected end of input"));
+
+		const uint8 code = *Cur++;
+		if (code <= 0x7F)
+			return CheckHandler(handler.OnInteger(code));
+		if (code >= 0xE0)
+			return CheckHandler(handler.OnInteger((int8)code));
+		if (code >= 0xA0 && code <= 0xBF)
+			return ReadString(code & 0x1F) && CheckHandler(handler.OnString(Scratch));
+		if (code >= 0x90 && code <= 0x9F)
+			return ReadArray(handler, code & 0x0F);
+		if (code >= 0x80 && code <= 0x8F)
+			return ReadObject(handler, code & 0x0F);
+
+		uint64 value;
+		switch (code)
+		{
+		case 0xC0: return CheckHandler(handler.OnNull());
+		case 0xC2: return CheckHandler(handler.OnBoolean(false));
+		case 0xC3: return CheckHandler(handler.OnBoolean(true));
+		case 0xCA:
+		{
+			if (!ReadBigEndian(4, value))
+				return false;
+			const uint32 bits = (uint32)value;
+			float number;
+			FMemory::Memcpy(&number, &bits, 4);
+			return CheckHandler(handler.OnNumber(number));
+		}
+		case 0xCB:
+		{
+			if (!ReadBigEndian(8, value))
+				return false;
+			double number;
+			FMemory::Memcpy(&number, &value, 8);
+			return CheckHandler(handler.OnNumber(number));
+		}
+		case 0xCC: return ReadBigEndian(1, value) && CheckHandler(handler.OnInteger((int64)value));
+		case 0xCD: return ReadBigEndian(2, value) && CheckHandler(handler.OnInteger((int64)value));
+		case 0xCE: return ReadBigEndian(4, value) && CheckHandler(handler.OnInteger((int64)value));
+		case 0xCF:
+			if (!ReadBigEndian(8, value))
+				return false;
+			//like the text reader, integers past the int64 range become doubles
+			return CheckHandler(value <= (uint64)MAX_int64 ? handler.OnInteger((int64)value) : handler.OnNumber((double)value));
+		case 0xD0: return ReadBigEndian(1, value) && CheckHandler(handler.OnInteger((int8)value));
+		case 0xD1: return ReadBigEndian(2, value) && CheckHandler(handler.OnInteger((int16)value));
+		case 0xD2: return ReadBigEndian(4, value) && CheckHandler(handler.OnInteger((int32)value));
+		case 0xD3: return ReadBigEndian(8, value) && CheckHandler(handler.OnInteger((int64)value));
+		case 0xD9: return ReadBigEndian(1, value) && ReadString(value) && CheckHandler(handler.OnString(Scratch));
+		case 0xDA: return ReadBigEndian(2, value) && ReadString(value) && CheckHandler(handler.OnString(Scratch));
+		case 0xDB: return ReadBigEndian(4, value) && ReadString(value) && CheckHandler(handler.OnString(Scratch));
+		case 0xDC: return ReadBigEndian(2, value) && ReadArray(handler, value);
+		case 0xDD: return ReadBigEndian(4, value) && ReadArray(handler, value);
+		case 0xDE: return ReadBigEndian(2, value) && ReadObject(handler, value);
+		case 0xDF: return ReadBigEndian(4, value) && ReadObject(handler, value);
+		}
+
+		--Cur;
+		return SetError(TEXT("unsupported MessagePack type"));
+	}
+
+	bool HasError() const { return ErrorMessage != nullptr; }
+	//null if there was no error
+	const TCHAR* GetErrorMessage() const { return ErrorMessage; }
+	//offset of the error in bytes
+	int64 GetErrorOffset() const { return ErrorOffset; }
+
+	FString GetErrorText() const
+	{
+		return HasError() ? FString::Printf(TEXT("%s at offset %lld"), ErrorMessage, ErrorOffset) : FString();
+	}
+
+private:
+	bool SetError(const TCHAR* message)
+	{
+		//keep the first error, the outer levels just unwind
+		if (!ErrorMessage)
+		{
+			ErrorMessage = message;
+			ErrorOffset = Cur - Begin;
+		}
+		return false;
+	}
+
+	FORCEINLINE bool CheckHandler(bool bContinue)
+	{
+		return bContinue ? true : SetError(TEXT("stopped by handler"));
+	}
+
+	bool ReadBigEndian(int32 numBytes, uint64& outValue)
+	{
+		if (End - Cur < numBytes)
+			return SetError(TEXT("unexpected end of input"));
+
+		outValue = 0;
+		for (int32 i = 0; i < numBytes; i++)
+			outValue = (outValue << 8) | *Cur++;
+		return true;
+	}
+
+	//every value takes at least one byte, so a count larger than the rest of the input can't be right
+	bool CheckCount(uint64 count, uint64 bytesPerItem)
+	{
+		return count <= (uint64)(End - Cur) / bytesPerItem ? true : SetError(TEXT("container size past the end of input"));
+	}
+
+	bool ReadString(uint64 length)
+	{
+		if ((uint64)(End - Cur) < length)
+			return SetError(TEXT("unexpected end of input"));
+
+		TArray<TCHAR>& chars = Scratch.GetCharArray();
+		chars.SetNumUninitialized((int32)length + 1, false);
+		const int32 numChars = JsonBPDecodeUTF8(Cur, (int32)length, chars.GetData());
+		if (numChars == INDEX_NONE)
+		{
+			chars.Reset();
+			return SetError(TEXT("invalid UTF-8"));
+		}
+
+		chars.SetNum(numChars + 1, false);
+		chars[numChars] = TEXT('\0');
+		Cur += length;
+		return true;
+	}
+
+	bool ReadKey()
+	{
+		if (Cur == End)
+			return SetError(TEXT("unexpected end of input"));
+
+		const uint8 code = *Cur++;
+		uint64 length;
+		if (code >= 0xA0 && code <= 0xBF)
+			return ReadString(code & 0x1F);
+		if (code == 0xD9)
+			return ReadBigEndian(1, length) && ReadString(length);
+		if (code == 0xDA)
+			return ReadBigEndian(2, length) && ReadString(length);
+		if (code == 0xDB)
+			return ReadBigEndian(4, length) && ReadString(length);
+
+		--Cur;
+		return SetError(TEXT("expected a string key"));
+	}
+
+	template<typename HandlerType> bool ReadArray(HandlerType& handler, uint64 count)
+	{
+		if (++Depth > MaxDepth)
+			return SetError(TEXT("maximum depth exceeded"));
+		if (!CheckCount(count, 1) || !CheckHandler(handler.OnArrayBegin()))
+			return false;
+
+		for (uint64 i = 0; i < count; i++)
+		{
+			if (!ReadValue(handler))
+				return false;
+		}
+
+		--Depth;
+		return CheckHandler(handler.OnArrayEnd());
+	}
+
+	template<typename HandlerType> bool ReadObject(HandlerType& handler, uint64 count)
+	{
+		if (++Depth > MaxDepth)
+			return SetError(TEXT("maximum depth exceeded"));
+		if (!CheckCount(count, 2) || !CheckHandler(handler.OnObjectBegin()))
+			return false;
+
+		for (uint64 i = 0; i < count; i++)
+		{
+			if (!ReadKey() || !CheckHandler(handler.OnObjectKey(Scratch)) || !ReadValue(handler))
+				return false;
+		}
+
+		--Depth;
+		return CheckHandler(handler.OnObjectEnd());
+	}
+
+	const uint8* Begin;
+	const uint8* Cur;
+	const uint8* End;
+	int32 Depth;
+	const TCHAR* ErrorMessage;
+	int64 ErrorOffset;
+	FString Scratch;
+};
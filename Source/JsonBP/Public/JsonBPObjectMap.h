@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "JsonBPKey.h"
+
+class UJsonValue;
+
+/*
+the fields of a json object, in the order they were added. removing a field keeps the order of the others,
+so the same edits always give the same text.
+the fields are a flat array searched linearly, most objects have a handful of them. objects with more than
+IndexThreshold fields get a hash index (positions in the array) on top.
+the TMap functions the plugin needs are here with the same meaning, Add replaces the value of an existing key in place.
+*/
+class JSONBP_API FJsonBPObjectMap
+{
+public:
+	typedef TPair<FJsonBPKey, UJsonValue*> ElementType;
+	//objects up to this size are searched without an index
+	static constexpr int32 IndexThreshold = 8;
+
+	int32 Num() const { return Entries.Num(); }
+	void Reserve(int32 number);
+	void Reset();
+	void Empty();
+
+	UJsonValue*& Add(FJsonBPKey key, UJsonValue* value);
+	UJsonValue*& FindOrAdd(FJsonBPKey key);
+	UJsonValue** Find(FJsonBPKey key)
+	{
+		const int32 index = IndexOf(key);
+		return index != INDEX_NONE ? &Entries[index].Value : nullptr;
+	}
+	UJsonValue* const* Find(FJsonBPKey key) const
+	{
+		return const_cast<FJsonBPObjectMap*>(this)->Find(key);
+	}
+	UJsonValue* FindRef(FJsonBPKey key) const
+	{
+		const int32 index = IndexOf(key);
+		return index != INDEX_NONE ? Entries[index].Value : nullptr;
+	}
+	bool Contains(FJsonBPKey key) const { return IndexOf(key) != INDEX_NONE; }
+	//returns the number of fields removed, 0 or 1
+	int32 Remove(FJsonBPKey key);
+	bool RemoveAndCopyValue(FJsonBPKey key, UJsonValue*& outValue);
+
+	//position of the key in the field order, INDEX_NONE if it isn't there
+	int32 IndexOf(FJsonBPKey key) const;
+	//field by position, in the order they were added
+	const ElementType& GetEntry(int32 index) const { return Entries[index]; }
+
+	//heap memory used by the fields and the index, not counting sizeof(FJsonBPObjectMap)
+	SIZE_T GetAllocatedSize() const { return Entries.GetAllocatedSize() + Buckets.GetAllocatedSize(); }
+
+	ElementType* begin() { return Entries.GetData(); }
+	ElementType* end() { return Entries.GetData() + Entries.Num(); }
+	const ElementType* begin() const { return Entries.GetData(); }
+	const ElementType* end() const { return Entries.GetData() + Entries.Num(); }
+
+private:
+	static uint32 HashKey(const FJsonBPKey& key) { return GetTypeHash(key) * 0x9E3779B9u; }
+	//builds the index for the current entries, or drops it when the object is small
+	void RebuildIndex();
+	void AddToIndex(int32 entry);
+
+	TArray<ElementType> Entries;
+	//open addressing, a power of two at least twice the number of fields. empty unless the object is bigger than IndexThreshold
+	TArray<int32> Buckets;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+
+//the elements of an array of only numbers or only strings, kept in one flat array instead of one value per element
+struct JSONBP_API FJsonBPPackedElements
+{
+	TArray<double> Numbers;
+	//the elements when bStrings
+	TArray<FString> Strings;
+	bool bStrings = false;
+	//every number is an integer a double holds exactly, they are written and read back as integers
+	bool bIntegers = false;
+
+	int32 Num() const { return bStrings ? Strings.Num() : Numbers.Num(); }
+
+	//the elements without the brackets, for TJsonBPWriter and FJsonBPMsgPackWriter
+	template<typename WriterType> void WriteElements(WriterType& writer) const
+	{
+		if (bStrings)
+		{
+			for (const FString& element : Strings)
+				writer.WriteString(element);
+		}
+		else if (bIntegers)
+		{
+			for (double element : Numbers)
+				writer.WriteInteger((int64)element);
+		}
+		else
+		{
+			for (double element : Numbers)
+				writer.WriteNumber(element);
+		}
+	}
+
+	int32 EstimateTextLength() const
+	{
+		//separators, quotes and a few digits per number
+		int32 length = 2 + Num();
+		if (!bStrings)
+			return length + Numbers.Num() * (bIntegers ? 4 : 10);
+		for (const FString& element : Strings)
+			length += element.Len() + 2;
+		return length;
+	}
+};
+
+/*
+an FJsonValue array of numbers or strings holding them packed, made by HelperToJSON(TArray) without an FJsonValue per element.
+the plugin's writers and MakeFromCPPVersion read the packed elements directly. AsArray makes the element values on first use
+for the code that needs them, that first call must not race with other readers of the value.
+*/
+class JSONBP_API FJsonBPValuePacked : public FJsonValue
+{
+public:
+	//every instance is registered for Find while it lives, so it can't be copied
+	explicit FJsonBPValuePacked(FJsonBPPackedElements&& elements);
+	FJsonBPValuePacked(const FJsonBPValuePacked&) = delete;
+	FJsonBPValuePacked& operator = (const FJsonBPValuePacked&) = delete;
+	virtual ~FJsonBPValuePacked();
+
+	virtual const TArray<TSharedPtr<FJsonValue>>& AsArray() const override;
+	virtual bool TryGetArray(const TArray<TSharedPtr<FJsonValue>>*& OutArray) const override;
+
+	const FJsonBPPackedElements& GetElements() const { return Elements; }
+	//the packed array behind value, null for every other FJsonValue. no allocation, it runs for every array the writers see
+	static const FJsonBPValuePacked* Find(const TSharedPtr<FJsonValue>& value);
+
+protected:
+	virtual FString GetType() const override { return TEXT("Array"); }
+
+private:
+	FJsonBPPackedElements Elements;
+	mutable TArray<TSharedPtr<FJsonValue>> ElementValues;
+	mutable bool bHasElementValues = false;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "JsonBP.h"
+#include "JsonBPPath.h"
+
+#include "JsonBPPatch.generated.h"
+
+/*
+structural diff and patching of UJsonValue trees, so only the changes of a state need to be sent and applied.
+supports RFC 6902 json patch (add, remove, replace, move, copy, test) and RFC 7396 json merge patch.
+*/
+UCLASS()
+class JSONBP_API UJsonPatchLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	//json patch turning a into b, an array of operations. the values of the operations are subtrees of b, not copies.
+	//arrays are compared element by element, elements are added or removed at the end
+	UFUNCTION(BlueprintPure)
+	static UJsonValue* Diff(const UJsonValue* a, const UJsonValue* b);
+
+	//applies a json patch to target in place, values of the patch are copied. returns false if any operation failed.
+	//operations are applied one by one, the ones before the failing operation stay applied
+	UFUNCTION(BlueprintCallable)
+	static bool ApplyPatch(UJsonValue* target, const UJsonValue* patch, FString& outError);
+
+	//applies a json merge patch to target in place: null removes a field, objects are merged, anything else replaces
+	UFUNCTION(BlueprintCallable)
+	static bool ApplyMergePatch(UJsonValue* target, const UJsonValue* patch);
+
+	//true if both are the same json. numbers are compared by value so 1 and 1.0 are equal, the order of fields doesn't matter
+	UFUNCTION(BlueprintPure)
+	static bool JsonEquals(const UJsonValue* a, const UJsonValue* b);
+
+	//a copy of the tree sharing nothing with it, null if value is null
+	UFUNCTION(BlueprintPure)
+	static UJsonValue* CloneValue(const UJsonValue* value);
+
+private:
+	static void DiffValues(const UJsonValue* a, const UJsonValue* b, const FString& path, TArray<UJsonValue*>& operations);
+	static UJsonValue* MakeOperation(const TCHAR* op, const FString& path, const UJsonValue* value);
+	static bool ApplyOperation(UJsonValue* target, const UJsonValue* operation, FString& outError);
+	static bool AddValue(UJsonValue* target, const TArray<FJsonBPPathSegment>& path, UJsonValue* value, FString& outError);
+	static UJsonValue* RemoveValue(UJsonValue* target, const TArray<FJsonBPPathSegment>& path, FString& outError);
+	static void AssignValue(UJsonValue* target, UJsonValue* source);
+	static void MergeValue(UJsonValue* target, const UJsonValue* patch);
+};
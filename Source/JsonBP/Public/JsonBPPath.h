@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "JsonBP.h"
+
+#include "JsonBPPath.generated.h"
+
+//one step of a compiled path
+struct JSONBP_API FJsonBPPathSegment
+{
+	enum class EKind : uint8
+	{
+		//field of an object
+		Key,
+		//element of an array, negative counts from the end
+		Index,
+		//json pointer token, a field of an object or an element of an array
+		KeyOrIndex,
+		//all fields or elements
+		Wildcard,
+	};
+
+	EKind Kind = EKind::Key;
+	FString Key;
+	//Key interned when the path is made, objects are searched with this
+	FJsonBPKey InternedKey;
+	int32 Index = INDEX_NONE;
+};
+
+/*
+a json path compiled once and evaluated many times without copying any container.
+supports RFC 6901 json pointers ("/a/0/b") and a JSONPath subset: $ .name ['name'] [index] [-index] .* [*]
+*/
+UCLASS(BlueprintType, Transient, NotBlueprintable)
+class JSONBP_API UJsonPath : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//compiles a json pointer ("" is the root). returns null if its not valid.
+	UFUNCTION(BlueprintPure)
+	static UJsonPath* CompilePointer(const FString& pointer);
+	//compiles a JSONPath starting with $. returns null if its not valid.
+	UFUNCTION(BlueprintPure)
+	static UJsonPath* CompileJsonPath(const FString& path);
+	//compiles a pointer or a JSONPath (if it starts with $) and keeps it in a cache, so the same string is compiled only once.
+	UFUNCTION(BlueprintPure)
+	static UJsonPath* GetCachedPath(const FString& path);
+
+	//the first value matching the path, null if none
+	UFUNCTION(BlueprintPure)
+	UJsonValue* Find(UJsonValue* root) const;
+	//returns true if any value matched the path
+	UFUNCTION(BlueprintPure)
+	bool FindAll(UJsonValue* root, TArray<UJsonValue*>& matches) const;
+
+	UFUNCTION(BlueprintPure)
+	bool HasWildcards() const { return bHasWildcards; }
+	UFUNCTION(BlueprintPure)
+	FString GetSource() const { return Source; }
+
+	const TArray<FJsonBPPathSegment>& GetSegments() const { return Segments; }
+
+	static bool ParsePointer(const FString& pointer, TArray<FJsonBPPathSegment>& outSegments);
+	static bool ParseJsonPath(const FString& path, TArray<FJsonBPPathSegment>& outSegments);
+
+	//one step of the path from value, null if it doesn't exist. wildcards are not handled here
+	static UJsonValue* Step(const UJsonValue* value, const FJsonBPPathSegment& segment);
+
+	//frees the cached paths
+	static void ClearCache();
+
+private:
+	static UJsonPath* MakePath(const FString& source, TArray<FJsonBPPathSegment>&& segments);
+	void Collect(UJsonValue* value, int32 segmentIndex, TArray<UJsonValue*>& outMatches, bool bFirstOnly) const;
+
+	FString Source;
+	TArray<FJsonBPPathSegment> Segments;
+	bool bHasWildcards = false;
+};
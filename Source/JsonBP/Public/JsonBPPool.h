@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "JsonBP.h"
+
+#include "JsonBPPool.generated.h"
+
+USTRUCT(BlueprintType)
+struct JSONBP_API FJsonValuePoolStats
+{
+	GENERATED_BODY()
+
+	//values handed out from the free list
+	UPROPERTY(BlueprintReadOnly)
+	int64 Hits = 0;
+	//values that had to be created because the free list was empty
+	UPROPERTY(BlueprintReadOnly)
+	int64 Misses = 0;
+	//values given back by Reclaim
+	UPROPERTY(BlueprintReadOnly)
+	int64 Reclaimed = 0;
+	//reclaimed values dropped because the free list was full, the GC takes them
+	UPROPERTY(BlueprintReadOnly)
+	int64 Dropped = 0;
+	//values handed out and not reclaimed yet
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumInUse = 0;
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumFree = 0;
+	//most values in use at the same time
+	UPROPERTY(BlueprintReadOnly)
+	int32 HighWaterMark = 0;
+};
+
+/*
+keeps cleared UJsonValue objects around for reuse instead of creating new ones and leaving the old ones to the GC.
+opt-in: while a pool is active every UJsonValue made by the plugin (Make*, SetField*, parsing) comes from it.
+
+	FJsonValuePoolScope scope(pool);
+	UJsonValue* pMessage = UJsonValue::MakeFromString(text);
+	...
+	pool->Reclaim(pMessage);
+
+Reclaim clears the whole tree and puts every node back, nothing may reference those values afterwards.
+pools only work on the game thread, values made on other threads are always new. keep the pool referenced (UPROPERTY or AddToRoot).
+*/
+UCLASS(BlueprintType, Transient, NotBlueprintable)
+class JSONBP_API UJsonValuePool : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//maxFree is the most cleared values kept, the rest of the reclaimed ones are left to the GC
+	UFUNCTION(BlueprintCallable)
+	static UJsonValuePool* MakeJsonValuePool(int32 maxFree = 4096);
+
+	//a cleared (JSON_None) value, from the free list if there is one
+	UFUNCTION(BlueprintCallable)
+	UJsonValue* Acquire();
+	//clears value and all its children and keeps them for reuse. values already in the pool and shared ones are skipped
+	UFUNCTION(BlueprintCallable)
+	void Reclaim(UJsonValue* value);
+	//creates values up to count free ones, so the first messages don't miss
+	UFUNCTION(BlueprintCallable)
+	void Reserve(int32 count);
+	//lets the GC take the free values
+	UFUNCTION(BlueprintCallable)
+	void Trim();
+
+	//makes this the pool all new values come from, until Deactivate. pools can be nested, the last activated one is used
+	UFUNCTION(BlueprintCallable)
+	void Activate();
+	UFUNCTION(BlueprintCallable)
+	void Deactivate();
+	//the innermost active pool, null if there is none or this is not the game thread
+	static UJsonValuePool* GetActivePool()
+	{
+		return ActivePools.Num() > 0 && IsInGameThread() ? ActivePools.Last() : nullptr;
+	}
+
+	UFUNCTION(BlueprintPure)
+	FJsonValuePoolStats GetStats() const;
+	UFUNCTION(BlueprintCallable)
+	void ResetStats();
+
+	virtual void BeginDestroy() override;
+
+private:
+	UPROPERTY()
+	TArray<UJsonValue*> FreeValues;
+	int32 MaxFree = 4096;
+	FJsonValuePoolStats Stats;
+
+	static TArray<UJsonValuePool*> ActivePools;
+};
+
+//activates the pool for the lifetime of the scope
+struct FJsonValuePoolScope
+{
+	explicit FJsonValuePoolScope(UJsonValuePool* pool) : Pool(pool)
+	{
+		if (Pool)
+			Pool->Activate();
+	}
+	~FJsonValuePoolScope()
+	{
+		if (Pool)
+			Pool->Deactivate();
+	}
+
+	UJsonValuePool* Pool;
+};
@@ -0,0 +1,734 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//decodes UTF-8, returns the number of characters written or INDEX_NONE if the text is not valid UTF-8. dest needs room for count characters
+inline int32 JsonBPDecodeUTF8(const uint8* pCur, int32 count, TCHAR* pDest)
+{
+	TCHAR* const pBegin = pDest;
+	const uint8* const pEnd = pCur + count;
+	while (pCur != pEnd)
+	{
+		uint32 codePoint = *pCur++;
+		if (codePoint >= 0x80)
+		{
+			int32 numTrail;
+			uint32 minimum;
+			if (codePoint >= 0xC2 && codePoint <= 0xDF) { numTrail = 1; minimum = 0x80; codePoint &= 0x1F; }
+			else if (codePoint >= 0xE0 && codePoint <= 0xEF) { numTrail = 2; minimum = 0x800; codePoint &= 0x0F; }
+			else if (codePoint >= 0xF0 && codePoint <= 0xF4) { numTrail = 3; minimum = 0x10000; codePoint &= 0x07; }
+			else return INDEX_NONE;
+
+			for (int32 i = 0; i < numTrail; i++)
+			{
+				if (pCur == pEnd || (*pCur & 0xC0) != 0x80)
+					return INDEX_NONE;
+				codePoint = (codePoint << 6) | (*pCur++ & 0x3F);
+			}
+
+			//overlong forms, surrogates and values past the unicode range
+			if (codePoint < minimum || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+				return INDEX_NONE;
+
+			if (codePoint > 0xFFFF && sizeof(TCHAR) == 2)
+			{
+				//2 characters for a 4 byte sequence, the output never gets longer than the input
+				codePoint -= 0x10000;
+				*pDest++ = (TCHAR)(0xD800 + (codePoint >> 10));
+				codePoint = 0xDC00 + (codePoint & 0x3FF);
+			}
+		}
+		*pDest++ = (TCHAR)codePoint;
+	}
+	return (int32)(pDest - pBegin);
+}
+
+/*
+supplies text to TJsonBPReader in chunks, so documents don't need to be in memory as a whole.
+UTF-8 chunks must end on a code point boundary.
+*/
+template<typename CharType>
+class IJsonBPInputSource
+{
+public:
+	virtual ~IJsonBPInputSource() {}
+
+	//returns the next chunk, false at the end of the input. the previous chunk is not used anymore once this is called.
+	virtual bool Read(const CharType*& outChunk, int32& outLength) = 0;
+};
+
+/*
+single pass json reader working directly on TCHAR or UTF-8 (ANSICHAR or uint8) text.
+UTF-8 is validated and decoded while reading, strings are scanned 8 bytes at a time.
+it doesn't build anything itself, values are reported to a handler as they are read:
+
+	struct FMyHandler
+	{
+		bool OnNull();
+		bool OnBoolean(bool value);
+		bool OnNumber(double value);
+		bool OnInteger(int64 value);
+		bool OnString(const FString& value);
+		bool OnArrayBegin();
+		bool OnArrayEnd();
+		bool OnObjectBegin();
+		bool OnObjectKey(const FString& key);
+		bool OnObjectEnd();
+	};
+
+numbers without fraction or exponent that fit in an int64 are reported by OnInteger, all others by OnNumber.
+strings and keys are decoded into a scratch buffer owned by the reader, copy them if you need them.
+returning false from any callback stops the reader.
+the text is either one buffer or comes from an IJsonBPInputSource chunk by chunk.
+*/
+template<typename CharType>
+class TJsonBPReader
+{
+	static_assert(sizeof(CharType) == 1 || TIsSame<CharType, TCHAR>::Value, "TJsonBPReader supports TCHAR or UTF-8 text");
+
+public:
+	//deeper documents are rejected instead of blowing the stack
+	static constexpr int32 MaxDepth = 512;
+
+	TJsonBPReader(const CharType* text, int32 length)
+		: Source(nullptr), Begin(text), Cur(text), End(text + length), ChunkOffset(0), Depth(0), ErrorMessage(nullptr), ErrorOffset(INDEX_NONE), bFirstElement(true)
+	{
+	}
+
+	TJsonBPReader(IJsonBPInputSource<CharType>& source)
+		: Source(&source), Begin(nullptr), Cur(nullptr), End(nullptr), ChunkOffset(0), Depth(0), ErrorMessage(nullptr), ErrorOffset(INDEX_NONE), bFirstElement(true)
+	{
+	}
+
+	//reads exactly one value, only whitespace is allowed after it
+	template<typename HandlerType> bool ReadDocument(HandlerType& handler)
+	{
+		SkipByteOrderMark();
+		if (!ReadValue(handler))
+			return false;
+
+		SkipWhitespace();
+		if (HasMore())
+			return SetError(TEXT("unexpected characters after the value"));
+
+		return true;
+	}
+
+	//reads one value cut out of a larger document where it was depth levels deep, only whitespace is allowed after it.
+	//the depth limit counts the levels above it, so the result is the same as reading it in place
+	template<typename HandlerType> bool ReadFragment(HandlerType& handler, int32 depth)
+	{
+		Depth = depth;
+		if (!ReadValue(handler))
+			return false;
+
+		SkipWhitespace();
+		if (HasMore())
+			return SetError(TEXT("unexpected characters after the value"));
+
+		return true;
+	}
+
+	//reads the next value and reports it to the handler
+	template<typename HandlerType> bool ReadValue(HandlerType& handler)
+	{
+		SkipWhitespace();
+		if (!HasMore())
+			return SetError(TEXT("unexpected end of input"));
+
+		switch (ToCode(*Cur))
+		{
+		case '{': return ReadObject(handler);
+		case '[': return ReadArray(handler);
+		case '"':
+			if (!ReadString(Scratch))
+				return false;
+			return CheckHandler(handler.OnString(Scratch));
+		case 't':
+			if (!ReadLiteral("true", 4))
+				return false;
+			return CheckHandler(handler.OnBoolean(true));
+		case 'f':
+			if (!ReadLiteral("false", 5))
+				return false;
+			return CheckHandler(handler.OnBoolean(false));
+		case 'n':
+			if (!ReadLiteral("null", 4))
+				return false;
+			return CheckHandler(handler.OnNull());
+		default:
+		{
+			double number;
+			int64 integer;
+			bool bInteger;
+			if (!ReadNumber(number, integer, bInteger))
+				return false;
+			return CheckHandler(bInteger ? handler.OnInteger(integer) : handler.OnNumber(number));
+		}
+		}
+	}
+
+	/*
+	reading a top level array one element at a time:
+
+		reader.BeginArrayStream();
+		bool bHasElement;
+		while (reader.NextArrayElement(bHasElement) && bHasElement)
+			reader.ReadValue(handler);
+	*/
+	bool BeginArrayStream()
+	{
+		SkipByteOrderMark();
+		SkipWhitespace();
+		if (!HasMore() || ToCode(*Cur) != '[')
+			return SetError(TEXT("expected '['"));
+
+		++Cur;
+		bFirstElement = true;
+		return true;
+	}
+
+	//bHasElement is false once the closing ']' is read
+	bool NextArrayElement(bool& bHasElement)
+	{
+		bHasElement = false;
+		SkipWhitespace();
+		if (!HasMore())
+			return SetError(TEXT("unterminated array"));
+
+		if (ToCode(*Cur) == ']')
+		{
+			++Cur;
+			return true;
+		}
+
+		if (!bFirstElement)
+		{
+			if (ToCode(*Cur) != ',')
+				return SetError(TEXT("expected ',' or ']'"));
+			++Cur;
+		}
+
+		bFirstElement = false;
+		bHasElement = true;
+		return true;
+	}
+
+	//for NDJSON and other whitespace separated values. bHasValue is false at the end of the input
+	bool NextValue(bool& bHasValue)
+	{
+		if (bFirstElement)
+		{
+			SkipByteOrderMark();
+			bFirstElement = false;
+		}
+
+		SkipWhitespace();
+		bHasValue = HasMore();
+		return !HasError();
+	}
+
+	bool HasError() const { return ErrorMessage != nullptr; }
+	//null if there was no error
+	const TCHAR* GetErrorMessage() const { return ErrorMessage; }
+	//offset of the error in characters (bytes for UTF-8)
+	int64 GetErrorOffset() const { return ErrorOffset; }
+
+	FString GetErrorText() const
+	{
+		return HasError() ? FString::Printf(TEXT("%s at offset %lld"), ErrorMessage, ErrorOffset) : FString();
+	}
+
+protected:
+	static FORCEINLINE uint32 ToCode(CharType c)
+	{
+		return sizeof(CharType) == 1 ? (uint32)(uint8)c : (uint32)c;
+	}
+
+	static FORCEINLINE bool IsWhitespace(uint32 c)
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+	}
+
+	static FORCEINLINE bool IsDigit(uint32 c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	//true if there is at least one more character, pulls the next chunk from the source if required
+	FORCEINLINE bool HasMore()
+	{
+		return Cur != End || Refill();
+	}
+
+	bool Refill()
+	{
+		if (!Source)
+			return false;
+
+		const CharType* chunk;
+		int32 length;
+		while (Source->Read(chunk, length))
+		{
+			if (length > 0)
+			{
+				ChunkOffset += End - Begin;
+				Begin = Cur = chunk;
+				End = chunk + length;
+				return true;
+			}
+		}
+
+		Source = nullptr;
+		return false;
+	}
+
+	bool SetError(const TCHAR* message)
+	{
+		//keep the first error, the outer levels just unwind
+		if (!ErrorMessage)
+		{
+			ErrorMessage = message;
+			ErrorOffset = ChunkOffset + (Cur - Begin);
+		}
+		return false;
+	}
+
+	FORCEINLINE bool CheckHandler(bool bContinue)
+	{
+		return bContinue ? true : SetError(TEXT("stopped by handler"));
+	}
+
+	FORCEINLINE void SkipWhitespace()
+	{
+		while (HasMore() && IsWhitespace(ToCode(*Cur)))
+			++Cur;
+	}
+
+	void SkipByteOrderMark()
+	{
+		if (!HasMore())
+			return;
+
+		if (sizeof(CharType) == 1)
+		{
+			//0xEF can't start a json value so there is nothing to give back if the rest doesn't match
+			if (ToCode(*Cur) == 0xEF)
+			{
+				++Cur;
+				if (HasMore() && ToCode(*Cur) == 0xBB)
+					++Cur;
+				if (HasMore() && ToCode(*Cur) == 0xBF)
+					++Cur;
+			}
+		}
+		else if (ToCode(*Cur) == 0xFEFF)
+		{
+			++Cur;
+		}
+	}
+
+	bool ReadLiteral(const ANSICHAR* literal, int32 length)
+	{
+		for (int32 i = 0; i < length; i++)
+		{
+			if (!HasMore() || ToCode(*Cur) != (uint32)literal[i])
+				return SetError(TEXT("invalid literal"));
+			++Cur;
+		}
+		return true;
+	}
+
+	template<typename HandlerType> bool ReadArray(HandlerType& handler)
+	{
+		if (++Depth > MaxDepth)
+			return SetError(TEXT("maximum depth exceeded"));
+
+		++Cur; // [
+		if (!CheckHandler(handler.OnArrayBegin()))
+			return false;
+
+		SkipWhitespace();
+		if (HasMore() && ToCode(*Cur) == ']')
+		{
+			++Cur;
+			--Depth;
+			return CheckHandler(handler.OnArrayEnd());
+		}
+
+		for (;;)
+		{
+			if (!ReadValue(handler))
+				return false;
+
+			SkipWhitespace();
+			if (!HasMore())
+				return SetError(TEXT("unterminated array"));
+
+			const uint32 c = ToCode(*Cur);
+			if (c == ']')
+			{
+				++Cur;
+				break;
+			}
+			if (c != ',')
+				return SetError(TEXT("expected ',' or ']'"));
+			++Cur;
+		}
+
+		--Depth;
+		return CheckHandler(handler.OnArrayEnd());
+	}
+
+	template<typename HandlerType> bool ReadObject(HandlerType& handler)
+	{
+		if (++Depth > MaxDepth)
+			return SetError(TEXT("maximum depth exceeded"));
+
+		++Cur; // {
+		if (!CheckHandler(handler.OnObjectBegin()))
+			return false;
+
+		SkipWhitespace();
+		if (HasMore() && ToCode(*Cur) == '}')
+		{
+			++Cur;
+			--Depth;
+			return CheckHandler(handler.OnObjectEnd());
+		}
+
+		for (;;)
+		{
+			SkipWhitespace();
+			if (!HasMore() || ToCode(*Cur) != '"')
+				return SetError(TEXT("expected a string key"));
+
+			if (!ReadString(Scratch) || !CheckHandler(handler.OnObjectKey(Scratch)))
+				return false;
+
+			SkipWhitespace();
+			if (!HasMore() || ToCode(*Cur) != ':')
+				return SetError(TEXT("expected ':'"));
+			++Cur;
+
+			if (!ReadValue(handler))
+				return false;
+
+			SkipWhitespace();
+			if (!HasMore())
+				return SetError(TEXT("unterminated object"));
+
+			const uint32 c = ToCode(*Cur);
+			if (c == '}')
+			{
+				++Cur;
+				break;
+			}
+			if (c != ',')
+				return SetError(TEXT("expected ',' or '}'"));
+			++Cur;
+		}
+
+		--Depth;
+		return CheckHandler(handler.OnObjectEnd());
+	}
+
+	static FORCEINLINE uint64 HasZeroByte(uint64 word)
+	{
+		return (word - 0x0101010101010101ull) & ~word & 0x8080808080808080ull;
+	}
+
+	//moves Cur to the first '"', '\\' or control character of the buffer, or to End. bNonAscii is set if any byte >= 0x80 was passed
+	FORCEINLINE void ScanRun(bool& bNonAscii)
+	{
+		if (sizeof(CharType) == 1)
+		{
+			//8 bytes at a time, the exact position is found by the byte loop below
+			uint64 highBits = 0;
+			while (End - Cur >= 8)
+			{
+				uint64 word;
+				FMemory::Memcpy(&word, Cur, 8);
+				const uint64 stops = HasZeroByte(word ^ 0x2222222222222222ull) | HasZeroByte(word ^ 0x5C5C5C5C5C5C5C5Cull)
+					| ((word - 0x2020202020202020ull) & ~word & 0x8080808080808080ull);
+				if (stops)
+					break;
+				highBits |= word;
+				Cur += 8;
+			}
+			bNonAscii |= (highBits & 0x8080808080808080ull) != 0;
+		}
+
+		while (Cur != End)
+		{
+			const uint32 c = ToCode(*Cur);
+			if (c == '"' || c == '\\' || c < 0x20)
+				break;
+			bNonAscii |= c >= 0x80;
+			++Cur;
+		}
+	}
+
+	static FORCEINLINE bool AppendRun(FString& out, const TCHAR* run, int32 count, bool bNonAscii)
+	{
+		out.AppendChars(run, count);
+		return true;
+	}
+
+	//decodes UTF-8 straight into the string without a temporary conversion buffer. false if the run is not valid UTF-8
+	template<typename ByteType> static bool AppendRun(FString& out, const ByteType* run, int32 count, bool bNonAscii)
+	{
+		TArray<TCHAR>& chars = out.GetCharArray();
+		if (chars.Num() > 0)
+			chars.Pop(false);
+
+		//never more characters than bytes
+		const int32 start = chars.AddUninitialized(count);
+		TCHAR* pDest = chars.GetData() + start;
+
+		int32 numChars = count;
+		if (!bNonAscii)
+		{
+			for (int32 i = 0; i < count; i++)
+				pDest[i] = (TCHAR)(uint8)run[i];
+		}
+		else
+		{
+			//runs never split a multi byte sequence since they only stop at ascii characters or chunk ends
+			numChars = JsonBPDecodeUTF8((const uint8*)run, count, pDest);
+		}
+
+		chars.SetNum(start + FMath::Max(numChars, 0), false);
+		chars.Add(TEXT('\0'));
+		return numChars != INDEX_NONE;
+	}
+
+	static void AppendCodePoint(FString& out, uint32 codePoint)
+	{
+		if (codePoint > 0xFFFF && sizeof(TCHAR) == 2)
+		{
+			codePoint -= 0x10000;
+			out.AppendChar((TCHAR)(0xD800 + (codePoint >> 10)));
+			out.AppendChar((TCHAR)(0xDC00 + (codePoint & 0x3FF)));
+		}
+		else
+		{
+			out.AppendChar((TCHAR)codePoint);
+		}
+	}
+
+	//a high surrogate waits for the low one, if it doesn't come its kept as it is
+	static FORCEINLINE void FlushSurrogate(FString& out, uint32& highSurrogate)
+	{
+		if (highSurrogate)
+		{
+			AppendCodePoint(out, highSurrogate);
+			highSurrogate = 0;
+		}
+	}
+
+	bool ReadHex4(uint32& value)
+	{
+		value = 0;
+		for (int32 i = 0; i < 4; i++)
+		{
+			if (!HasMore())
+				return SetError(TEXT("invalid unicode escape"));
+
+			const uint32 c = ToCode(*Cur++);
+			value <<= 4;
+			if (c >= '0' && c <= '9')
+				value |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				value |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				value |= c - 'A' + 10;
+			else
+				return SetError(TEXT("invalid unicode escape"));
+		}
+		return true;
+	}
+
+	bool ReadEscape(FString& out, uint32& highSurrogate)
+	{
+		++Cur; // backslash
+		if (!HasMore())
+			return SetError(TEXT("unterminated string"));
+
+		const uint32 c = ToCode(*Cur++);
+		if (c == 'u')
+		{
+			uint32 codePoint;
+			if (!ReadHex4(codePoint))
+				return false;
+
+			if (highSurrogate && codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+			{
+				AppendCodePoint(out, 0x10000 + ((highSurrogate - 0xD800) << 10) + (codePoint - 0xDC00));
+				highSurrogate = 0;
+				return true;
+			}
+
+			FlushSurrogate(out, highSurrogate);
+			if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+				highSurrogate = codePoint;
+			else
+				AppendCodePoint(out, codePoint);
+			return true;
+		}
+
+		FlushSurrogate(out, highSurrogate);
+		switch (c)
+		{
+		case '"': out.AppendChar(TEXT('"')); return true;
+		case '\\': out.AppendChar(TEXT('\\')); return true;
+		case '/': out.AppendChar(TEXT('/')); return true;
+		case 'b': out.AppendChar(TEXT('\b')); return true;
+		case 'f': out.AppendChar(TEXT('\f')); return true;
+		case 'n': out.AppendChar(TEXT('\n')); return true;
+		case 'r': out.AppendChar(TEXT('\r')); return true;
+		case 't': out.AppendChar(TEXT('\t')); return true;
+		}
+
+		--Cur;
+		return SetError(TEXT("invalid escape sequence"));
+	}
+
+	bool ReadString(FString& out)
+	{
+		++Cur; // "
+		out.Reset();
+		uint32 highSurrogate = 0;
+
+		for (;;)
+		{
+			const CharType* runStart = Cur;
+			bool bNonAscii = false;
+			ScanRun(bNonAscii);
+
+			if (Cur != runStart)
+			{
+				FlushSurrogate(out, highSurrogate);
+				if (!AppendRun(out, runStart, (int32)(Cur - runStart), bNonAscii))
+				{
+					Cur = runStart;
+					return SetError(TEXT("invalid UTF-8"));
+				}
+			}
+
+			if (!HasMore())
+				return SetError(TEXT("unterminated string"));
+
+			const uint32 c = ToCode(*Cur);
+			if (c == '"')
+			{
+				FlushSurrogate(out, highSurrogate);
+				++Cur;
+				return true;
+			}
+			if (c == '\\')
+			{
+				if (!ReadEscape(out, highSurrogate))
+					return false;
+			}
+			else if (c < 0x20)
+			{
+				return SetError(TEXT("control character in string"));
+			}
+			//otherwise the run ended with the chunk, continue with the next one
+		}
+	}
+
+	FORCEINLINE void AcceptDigits(TArray<ANSICHAR, TInlineAllocator<64>>& buffer)
+	{
+		while (HasMore() && IsDigit(ToCode(*Cur)))
+			buffer.Add((ANSICHAR)*Cur++);
+	}
+
+	//parses an optionally negative run of digits, false if it doesn't fit in an int64
+	static bool ParseInteger(const ANSICHAR* text, int64& outValue)
+	{
+		const bool bNegative = *text == '-';
+		if (bNegative)
+			++text;
+
+		//magnitude of INT64_MIN
+		const uint64 limit = bNegative ? (uint64)MAX_int64 + 1 : (uint64)MAX_int64;
+		uint64 value = 0;
+		for (; *text; ++text)
+		{
+			const uint64 digit = (uint64)(*text - '0');
+			if (value > (limit - digit) / 10)
+				return false;
+			value = value * 10 + digit;
+		}
+
+		//-0 stays a double to keep its sign
+		if (bNegative && value == 0)
+			return false;
+
+		outValue = bNegative ? (int64)(0 - value) : (int64)value;
+		return true;
+	}
+
+	bool ReadNumber(double& value, int64& outInteger, bool& bOutInteger)
+	{
+		//validate the json number grammar and copy it to a null terminated ansi buffer for Atod
+		TArray<ANSICHAR, TInlineAllocator<64>> buffer;
+
+		if (ToCode(*Cur) == '-')
+		{
+			buffer.Add('-');
+			++Cur;
+		}
+
+		if (!HasMore() || !IsDigit(ToCode(*Cur)))
+			return SetError(TEXT("invalid value"));
+
+		if (ToCode(*Cur) == '0')
+			buffer.Add((ANSICHAR)*Cur++);
+		else
+			AcceptDigits(buffer);
+
+		bool bIntegral = true;
+		if (HasMore() && ToCode(*Cur) == '.')
+		{
+			bIntegral = false;
+			buffer.Add((ANSICHAR)*Cur++);
+			if (!HasMore() || !IsDigit(ToCode(*Cur)))
+				return SetError(TEXT("invalid number"));
+			AcceptDigits(buffer);
+		}
+
+		if (HasMore() && (ToCode(*Cur) == 'e' || ToCode(*Cur) == 'E'))
+		{
+			bIntegral = false;
+			buffer.Add((ANSICHAR)*Cur++);
+			if (HasMore() && (ToCode(*Cur) == '+' || ToCode(*Cur) == '-'))
+				buffer.Add((ANSICHAR)*Cur++);
+			if (!HasMore() || !IsDigit(ToCode(*Cur)))
+				return SetError(TEXT("invalid number"));
+			AcceptDigits(buffer);
+		}
+
+		buffer.Add(0);
+		bOutInteger = bIntegral && ParseInteger(buffer.GetData(), outInteger);
+		if (!bOutInteger)
+			value = FCStringAnsi::Atod(buffer.GetData());
+		return true;
+	}
+
+protected:
+	IJsonBPInputSource<CharType>* Source;
+	const CharType* Begin;
+	const CharType* Cur;
+	const CharType* End;
+	//characters consumed by the previous chunks
+	int64 ChunkOffset;
+	int32 Depth;
+	const TCHAR* ErrorMessage;
+	int64 ErrorOffset;
+	//first element of an array stream or first value of a value stream
+	bool bFirstElement;
+	FString Scratch;
+};
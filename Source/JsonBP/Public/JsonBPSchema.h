@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Internationalization/Regex.h"
+#include "JsonBP.h"
+
+#include "JsonBPSchema.generated.h"
+
+USTRUCT(BlueprintType)
+struct JSONBP_API FJsonSchemaError
+{
+	GENERATED_BODY()
+
+	//json pointer to the value that failed, "" is the root
+	UPROPERTY(BlueprintReadOnly)
+	FString Location;
+	//the keyword that failed (type, required, minimum...), "json" if the text could not be read
+	UPROPERTY(BlueprintReadOnly)
+	FString Keyword;
+	UPROPERTY(BlueprintReadOnly)
+	FString Message;
+};
+
+//a field named by properties and/or required
+struct FJsonBPSchemaProperty
+{
+	//schema of the field, INDEX_NONE if it is only required
+	int32 Node = INDEX_NONE;
+	//index in Required, INDEX_NONE if it is not required
+	int32 RequiredIndex = INDEX_NONE;
+};
+
+//one compiled schema, nested schemas are referenced by their index
+struct FJsonBPSchemaNode
+{
+	//EJsonBPSchemaType bits, 0 allows every type
+	uint8 Types = 0;
+	//the false schema, nothing matches it
+	bool bNever = false;
+
+	TOptional<double> Minimum;
+	TOptional<double> Maximum;
+	TOptional<double> ExclusiveMinimum;
+	TOptional<double> ExclusiveMaximum;
+	//string lengths are counted in TCHARs
+	int32 MinLength = 0;
+	int32 MaxLength = MAX_int32;
+	int32 MinItems = 0;
+	int32 MaxItems = MAX_int32;
+	int32 MinProperties = 0;
+	int32 MaxProperties = MAX_int32;
+	//index in UJsonSchema::Patterns
+	int32 Pattern = INDEX_NONE;
+
+	//schema of all elements of an array
+	int32 Items = INDEX_NONE;
+	TMap<FJsonBPKey, FJsonBPSchemaProperty> Properties;
+	TArray<FJsonBPKey> Required;
+	//schema of the fields not in properties, INDEX_NONE allows anything
+	int32 AdditionalProperties = INDEX_NONE;
+	bool bNoAdditionalProperties = false;
+
+	//range in UJsonSchema::EnumValues, const is an enum of one value
+	bool bHasEnum = false;
+	//arrays/objects in the enum, values are only built for those while validating text
+	bool bEnumHasContainers = false;
+	int32 EnumFirst = 0;
+	int32 EnumCount = 0;
+};
+
+/*
+a JSON Schema compiled once and run against many values or texts.
+supports a draft-07 subset: type, enum, const, minimum, maximum, exclusiveMinimum, exclusiveMaximum, minLength, maxLength, pattern,
+items (one schema for all elements), minItems, maxItems, properties, additionalProperties, required, minProperties, maxProperties
+and the true/false schemas. other keywords are ignored.
+
+	UJsonSchema* pSchema = UJsonSchema::CompileSchemaFromString(schemaText, error);
+	TArray<FJsonSchemaError> errors;
+	UJsonValue* pMessage = pSchema->ParseValidated(text, errors);
+
+text is validated while it is read, ValidateString doesn't create any UJsonValue.
+*/
+UCLASS(BlueprintType, Transient, NotBlueprintable)
+class JSONBP_API UJsonSchema : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//returns null and the reason if the schema is not valid or uses unsupported keyword forms
+	UFUNCTION(BlueprintCallable)
+	static UJsonSchema* CompileSchema(const UJsonValue* schema, FString& outError);
+	UFUNCTION(BlueprintCallable)
+	static UJsonSchema* CompileSchemaFromString(const FString& schema, FString& outError);
+
+	//returns true if value matches, otherwise outErrors lists what failed
+	UFUNCTION(BlueprintCallable)
+	bool Validate(const UJsonValue* value, TArray<FJsonSchemaError>& outErrors) const;
+	//validates the text while reading it, nothing is built. text that isn't json fails with a "json" error
+	UFUNCTION(BlueprintCallable)
+	bool ValidateString(const FString& text, TArray<FJsonSchemaError>& outErrors) const;
+	bool ValidateUTF8(const ANSICHAR* text, int32 length, TArray<FJsonSchemaError>& outErrors) const;
+	//parses and validates in one pass, null if the text is not json or doesn't match
+	UFUNCTION(BlueprintCallable)
+	UJsonValue* ParseValidated(const FString& text, TArray<FJsonSchemaError>& outErrors) const;
+	UJsonValue* ParseValidatedUTF8(const ANSICHAR* text, int32 length, TArray<FJsonSchemaError>& outErrors) const;
+
+	//validation stops after this many errors, 0 for no limit
+	UFUNCTION(BlueprintCallable)
+	void SetMaxErrors(int32 maxErrors) { MaxErrors = FMath::Max(maxErrors, 0); }
+
+private:
+	friend class FJsonBPSchemaValidator;
+
+	int32 CompileNode(const UJsonValue* schema, const FString& location, FString& outError);
+	template<typename CharType> bool ValidateText(const CharType* text, int32 length, TArray<FJsonSchemaError>& outErrors) const;
+	template<typename CharType> UJsonValue* ParseValidatedText(const CharType* text, int32 length, TArray<FJsonSchemaError>& outErrors) const;
+
+	TArray<FJsonBPSchemaNode> Nodes;
+	TArray<FRegexPattern> Patterns;
+	//copies of the enum and const values
+	UPROPERTY()
+	TArray<UJsonValue*> EnumValues;
+	int32 MaxErrors = 100;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "JsonBP.h"
+#include "JsonBPReader.h"
+#include "JsonBPWriter.h"
+
+#include "JsonBPStream.generated.h"
+
+UENUM(BlueprintType)
+enum class EJsonStreamFormat : uint8
+{
+	//a single array, its elements are read one by one
+	JSON_TopLevelArray,
+	//one value per line (any whitespace between values is accepted)
+	JSON_NDJSON,
+};
+
+/*
+UTF-8 input source reading an archive chunk by chunk.
+only one chunk is in memory at a time, chunks are cut before incomplete UTF-8 sequences.
+*/
+class JSONBP_API FJsonBPArchiveSource : public IJsonBPInputSource<ANSICHAR>
+{
+public:
+	FJsonBPArchiveSource(FArchive& archive, int32 chunkSize = 64 * 1024);
+
+	virtual bool Read(const ANSICHAR*& outChunk, int32& outLength) override;
+
+private:
+	FArchive& Archive;
+	int32 ChunkSize;
+	TArray<ANSICHAR> Buffer;
+	//bytes of a sequence that was cut by the end of the previous chunk
+	ANSICHAR Carry[4];
+	int32 NumCarry;
+};
+
+/*
+UTF-8 output sink writing to an archive, used with a TJsonBPWriter so large documents are written in chunks.
+*/
+class JSONBP_API FJsonBPArchiveSink : public IJsonBPOutputSink<uint8>
+{
+public:
+	FJsonBPArchiveSink(FArchive& archive) : Archive(archive) {}
+
+	virtual void Write(const uint8* chunk, int32 length) override
+	{
+		Archive.Serialize(const_cast<uint8*>(chunk), length);
+	}
+
+private:
+	FArchive& Archive;
+};
+
+/*
+event callbacks for reading documents that are too large to keep as a tree.
+all callbacks return true to continue, false to stop reading.
+*/
+class JSONBP_API IJsonBPEventHandler
+{
+public:
+	virtual ~IJsonBPEventHandler() {}
+
+	virtual bool OnNull() { return true; }
+	virtual bool OnBoolean(bool value) { return true; }
+	virtual bool OnNumber(double value) { return true; }
+	//integral numbers that fit in an int64, reported as doubles unless overridden
+	virtual bool OnInteger(int64 value) { return OnNumber((double)value); }
+	virtual bool OnString(const FString& value) { return true; }
+	virtual bool OnArrayBegin() { return true; }
+	virtual bool OnArrayEnd() { return true; }
+	virtual bool OnObjectBegin() { return true; }
+	virtual bool OnObjectKey(const FString& key) { return true; }
+	virtual bool OnObjectEnd() { return true; }
+	//called between the records of NDJSON input and the elements of a top level array
+	virtual bool OnRecordEnd() { return true; }
+};
+
+//reads a UTF-8 file chunk by chunk reporting every value to the handler. returns false if failed or stopped.
+JSONBP_API bool HelperReadJSONFileEvents(const FString& filePath, IJsonBPEventHandler& handler, EJsonStreamFormat format, FString* outError = nullptr);
+//same as HelperReadJSONFileEvents reading from any source
+JSONBP_API bool HelperReadJSONEvents(IJsonBPInputSource<ANSICHAR>& source, IJsonBPEventHandler& handler, EJsonStreamFormat format, FString* outError = nullptr);
+
+/*
+reads the records of a large UTF-8 file one at a time, only the current record is kept in memory.
+*/
+UCLASS(BlueprintType, Transient, NotBlueprintable)
+class JSONBP_API UJsonStreamReader : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//opens the file for reading. returns null if the file could not be opened.
+	UFUNCTION(BlueprintCallable)
+	static UJsonStreamReader* OpenJsonStream(const FString& filePath, EJsonStreamFormat format);
+
+	//reads the next record. returns false at the end of the stream or if failed, see GetError.
+	UFUNCTION(BlueprintCallable)
+	bool ReadNext(UJsonValue*& value);
+
+	UFUNCTION(BlueprintCallable)
+	void Close();
+
+	UFUNCTION(BlueprintPure)
+	bool HasError() const { return !Error.IsEmpty(); }
+	UFUNCTION(BlueprintPure)
+	FString GetError() const { return Error; }
+
+	virtual void BeginDestroy() override;
+
+private:
+	EJsonStreamFormat Format;
+	bool bStarted = false;
+	bool bFinished = false;
+	FString Error;
+	TUniquePtr<FArchive> Archive;
+	TUniquePtr<FJsonBPArchiveSource> Source;
+	TUniquePtr<TJsonBPReader<ANSICHAR>> Reader;
+};
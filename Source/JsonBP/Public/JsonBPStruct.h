@@ -0,0 +1,186 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UnrealType.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "JsonBP.h"
+
+#include "JsonBPStruct.generated.h"
+
+struct FJsonBPStructPlan;
+
+/*
+how a property is converted, decided once when the plan of its struct is built
+*/
+enum class EJsonBPPropertyKind : uint8
+{
+	Bool,
+	Int32,
+	Float,
+	//any other integer or floating point property
+	Numeric,
+	//enum property or byte property with an enum, written as the name of the value
+	Enum,
+	String,
+	Name,
+	Text,
+	Struct,
+	//hard object reference, written as the path name of the object
+	Object,
+	SoftObject,
+	Array,
+	Set,
+	Map,
+	//anything else goes through ExportText/ImportText as a string
+	Other,
+};
+
+struct JSONBP_API FJsonBPPropertyPlan
+{
+	EJsonBPPropertyKind Kind = EJsonBPPropertyKind::Other;
+	const FProperty* Property = nullptr;
+	//json field name, only for struct members
+	FString Key;
+	FJsonBPKey InternedKey;
+	//plan of the struct for Struct properties
+	const FJsonBPStructPlan* Struct = nullptr;
+	const UEnum* Enum = nullptr;
+	//element of arrays and sets, key of maps
+	TUniquePtr<FJsonBPPropertyPlan> Inner;
+	//value of maps
+	TUniquePtr<FJsonBPPropertyPlan> Value;
+};
+
+/*
+the properties of a UStruct (or UClass) in the order they are written.
+plans are built once per type and cached, so converting many values of the same type doesn't walk the reflection data again.
+Transient and Deprecated properties are skipped.
+*/
+struct JSONBP_API FJsonBPStructPlan
+{
+	TWeakObjectPtr<const UStruct> Struct;
+	int32 PropertiesSize = 0;
+	TArray<FJsonBPPropertyPlan> Properties;
+
+	//returns the cached plan of the struct, building it if needed. thread safe
+	static const FJsonBPStructPlan* Get(const UStruct* structType);
+	//forgets the cached plans. plans in use stay alive until shutdown
+	static void ClearCache();
+};
+
+//converts the struct (or object if structType is its class) to a json object
+JSONBP_API UJsonValue* HelperStructToJSONValue(const UStruct* structType, const void* data);
+//fills the struct from a json object, fields that are missing in the json keep their value. returns false if any field could not be converted
+JSONBP_API bool HelperJSONValueToStruct(const UJsonValue* value, const UStruct* structType, void* outData);
+//writes the struct as json text directly, no UJsonValue is created
+JSONBP_API FString HelperStructToJSONString(const UStruct* structType, const void* data, bool bPretty = false);
+JSONBP_API void HelperStructToJSONUTF8(const UStruct* structType, const void* data, TArray<ANSICHAR>& out, bool bPretty = false);
+//parses the text and fills the struct, no UJsonValue is created
+JSONBP_API bool HelperJSONStringToStruct(const FString& json, const UStruct* structType, void* outData);
+JSONBP_API bool HelperJSONUTF8ToStruct(const ANSICHAR* text, int32 length, const UStruct* structType, void* outData);
+
+template<typename TStruct> UJsonValue* HelperStructToJSONValue(const TStruct& data)
+{
+	return HelperStructToJSONValue(TStruct::StaticStruct(), &data);
+}
+template<typename TStruct> bool HelperJSONValueToStruct(const UJsonValue* value, TStruct& outData)
+{
+	return HelperJSONValueToStruct(value, TStruct::StaticStruct(), &outData);
+}
+template<typename TStruct> FString HelperStructToJSONString(const TStruct& data, bool bPretty = false)
+{
+	return HelperStructToJSONString(TStruct::StaticStruct(), &data, bPretty);
+}
+template<typename TStruct> bool HelperJSONStringToStruct(const FString& json, TStruct& outData)
+{
+	return HelperJSONStringToStruct(json, TStruct::StaticStruct(), &outData);
+}
+
+/*
+blueprint nodes converting any struct or object to and from json using reflection.
+*/
+UCLASS()
+class JSONBP_API UJsonStructLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	//converts any struct to a json object
+	UFUNCTION(BlueprintPure, CustomThunk, meta = (CustomStructureParam = "value"))
+	static UJsonValue* StructToJsonValue(const int32& value);
+	//fills the struct from a json object. returns false if any field could not be converted
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "value"))
+	static bool JsonValueToStruct(UJsonValue* json, int32& value);
+	//converts any struct to json text
+	UFUNCTION(BlueprintPure, CustomThunk, meta = (CustomStructureParam = "value"))
+	static FString StructToJsonString(const int32& value, bool bPretty);
+	//parses the text and fills the struct. returns false if failed
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "value"))
+	static bool JsonStringToStruct(const FString& json, int32& value);
+
+	//converts the properties of the object to a json object
+	UFUNCTION(BlueprintPure)
+	static UJsonValue* ObjectToJsonValue(UObject* object);
+	//sets the properties of the object from a json object
+	UFUNCTION(BlueprintCallable)
+	static bool JsonValueToObject(UJsonValue* json, UObject* object);
+	UFUNCTION(BlueprintPure)
+	static FString ObjectToJsonString(UObject* object, bool bPretty);
+	UFUNCTION(BlueprintCallable)
+	static bool JsonStringToObject(const FString& json, UObject* object);
+
+	DECLARE_FUNCTION(execStructToJsonValue)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(nullptr);
+		const FStructProperty* pProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		const void* pData = Stack.MostRecentPropertyAddress;
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		*(UJsonValue**)RESULT_PARAM = pProperty && pData ? HelperStructToJSONValue(pProperty->Struct, pData) : nullptr;
+		P_NATIVE_END;
+	}
+
+	DECLARE_FUNCTION(execJsonValueToStruct)
+	{
+		P_GET_OBJECT(UJsonValue, json);
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(nullptr);
+		const FStructProperty* pProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		void* pData = Stack.MostRecentPropertyAddress;
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		*(bool*)RESULT_PARAM = pProperty && pData && HelperJSONValueToStruct(json, pProperty->Struct, pData);
+		P_NATIVE_END;
+	}
+
+	DECLARE_FUNCTION(execStructToJsonString)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(nullptr);
+		const FStructProperty* pProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		const void* pData = Stack.MostRecentPropertyAddress;
+		P_GET_UBOOL(bPretty);
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		*(FString*)RESULT_PARAM = pProperty && pData ? HelperStructToJSONString(pProperty->Struct, pData, bPretty) : FString();
+		P_NATIVE_END;
+	}
+
+	DECLARE_FUNCTION(execJsonStringToStruct)
+	{
+		P_GET_PROPERTY(FStrProperty, json);
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(nullptr);
+		const FStructProperty* pProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		void* pData = Stack.MostRecentPropertyAddress;
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		*(bool*)RESULT_PARAM = pProperty && pData && HelperJSONStringToStruct(json, pProperty->Struct, pData);
+		P_NATIVE_END;
+	}
+};
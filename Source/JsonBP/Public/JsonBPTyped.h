@@ -0,0 +1,620 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Optional.h"
+#include "Templates/IsEnum.h"
+#include "Templates/IsFloatingPoint.h"
+#include "Templates/IsIntegral.h"
+#include "Templates/IsSigned.h"
+#include "Templates/IsUEnumClass.h"
+#include "UObject/Class.h"
+#include "JsonBPReader.h"
+#include "JsonBPWriter.h"
+
+/*
+writes C++ values straight to json text and reads them back, no FJsonValue or UJsonValue is made in between.
+the conversion is chosen at compile time by TJsonBPTypeTraits<T>:
+
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const T& value);
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, T& outValue);
+
+bool, integers, float, double, FString, FName, FText, enums, TArray, TSet, TMap, TOptional and any nesting of them are built in.
+enums declared with UENUM are written by name like struct properties, other enums as numbers. maps are objects, their keys
+go through TJsonBPKeyTraits (strings, names, integers and enums). other types specialize TJsonBPTypeTraits:
+
+	template<> struct TJsonBPTypeTraits<FMyPoint>
+	{
+		template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const FMyPoint& value)
+		{
+			writer.BeginObject();
+			writer.WriteKey(TEXT("x"));
+			JsonBPWriteTyped(writer, value.X);
+			writer.WriteKey(TEXT("y"));
+			JsonBPWriteTyped(writer, value.Y);
+			writer.EndObject();
+		}
+		template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, FMyPoint& outValue)
+		{
+			return reader.ReadObjectFields([&](const FString& key)
+			{
+				if (key == TEXT("x"))
+					return reader.Read(outValue.X);
+				if (key == TEXT("y"))
+					return reader.Read(outValue.Y);
+				return reader.SkipValue();
+			});
+		}
+	};
+*/
+template<typename T, typename Enable = void>
+struct TJsonBPTypeTraits
+{
+	static_assert(sizeof(T) == 0, "no json conversion for this type, specialize TJsonBPTypeTraits for it");
+};
+
+//converts map keys to and from the json key, specialize it for other key types
+template<typename T, typename Enable = void>
+struct TJsonBPKeyTraits
+{
+	static_assert(sizeof(T) == 0, "no json key conversion for this type, specialize TJsonBPKeyTraits for it");
+};
+
+//handler that accepts any value, for skipping the values nothing reads
+struct FJsonBPSkipHandler
+{
+	bool OnNull() { return true; }
+	bool OnBoolean(bool value) { return true; }
+	bool OnNumber(double value) { return true; }
+	bool OnInteger(int64 value) { return true; }
+	bool OnString(const FString& value) { return true; }
+	bool OnArrayBegin() { return true; }
+	bool OnArrayEnd() { return true; }
+	bool OnObjectBegin() { return true; }
+	bool OnObjectKey(const FString& key) { return true; }
+	bool OnObjectEnd() { return true; }
+};
+
+/*
+TJsonBPReader that is asked for the values it expects instead of reporting whatever comes, for TJsonBPTypeTraits.
+a value of an unexpected kind is an error, the first one is kept like in TJsonBPReader.
+*/
+template<typename CharType>
+class TJsonBPTypedReader : public TJsonBPReader<CharType>
+{
+	typedef TJsonBPReader<CharType> Super;
+
+public:
+	TJsonBPTypedReader(const CharType* text, int32 length) : Super(text, length) {}
+	TJsonBPTypedReader(IJsonBPInputSource<CharType>& source) : Super(source) {}
+
+	//reads the next value into outValue with its TJsonBPTypeTraits
+	template<typename T> bool Read(T& outValue)
+	{
+		return TJsonBPTypeTraits<T>::Read(*this, outValue);
+	}
+
+	//reads exactly one value, only whitespace is allowed after it
+	template<typename T> bool ReadTypedDocument(T& outValue)
+	{
+		this->SkipByteOrderMark();
+		if (!Read(outValue))
+			return false;
+
+		this->SkipWhitespace();
+		if (this->HasMore())
+			return this->SetError(TEXT("unexpected characters after the value"));
+
+		return true;
+	}
+
+	bool SkipValue()
+	{
+		FJsonBPSkipHandler handler;
+		return this->ReadValue(handler);
+	}
+
+	//true if the next value is null, nothing is read
+	bool PeekNull()
+	{
+		this->SkipWhitespace();
+		return this->HasMore() && this->ToCode(*this->Cur) == 'n';
+	}
+
+	//true if the next value is a string, nothing is read
+	bool PeekString()
+	{
+		this->SkipWhitespace();
+		return this->HasMore() && this->ToCode(*this->Cur) == '"';
+	}
+
+	bool ReadNull()
+	{
+		if (!PeekNull())
+			return this->SetError(TEXT("expected null"));
+		return this->ReadLiteral("null", 4);
+	}
+
+	bool ReadBoolean(bool& outValue)
+	{
+		this->SkipWhitespace();
+		const uint32 c = this->HasMore() ? this->ToCode(*this->Cur) : 0;
+		if (c == 't')
+		{
+			outValue = true;
+			return this->ReadLiteral("true", 4);
+		}
+		if (c == 'f')
+		{
+			outValue = false;
+			return this->ReadLiteral("false", 5);
+		}
+		return this->SetError(TEXT("expected a boolean"));
+	}
+
+	//bOutInteger and outInteger like TJsonBPReader::OnInteger, value is set either way
+	bool ReadNumber(double& outValue, int64& outInteger, bool& bOutInteger)
+	{
+		this->SkipWhitespace();
+		const uint32 c = this->HasMore() ? this->ToCode(*this->Cur) : 0;
+		if (c != '-' && !this->IsDigit(c))
+			return this->SetError(TEXT("expected a number"));
+
+		if (!Super::ReadNumber(outValue, outInteger, bOutInteger))
+			return false;
+		if (bOutInteger)
+			outValue = (double)outInteger;
+		return true;
+	}
+
+	//whole numbers that fit in T, written as integers or not ("1e3", "2.0")
+	template<typename T> bool ReadInteger(T& outValue)
+	{
+		double number;
+		int64 integer;
+		bool bInteger;
+		if (!ReadNumber(number, integer, bInteger))
+			return false;
+
+		if (bInteger)
+		{
+			const bool bFits = TIsSigned<T>::Value
+				? integer >= (int64)TNumericLimits<T>::Min() && integer <= (int64)TNumericLimits<T>::Max()
+				: integer >= 0 && (uint64)integer <= (uint64)TNumericLimits<T>::Max();
+			if (!bFits)
+				return this->SetError(TEXT("integer out of range"));
+
+			outValue = (T)integer;
+			return true;
+		}
+
+		//the upper bound rounds to a power of two as a double, which is just past the range
+		if (number != FMath::FloorToDouble(number) || !(number >= (double)TNumericLimits<T>::Min() && number < (double)TNumericLimits<T>::Max() + 1.0))
+			return this->SetError(TEXT("expected an integer"));
+
+		outValue = TIsSigned<T>::Value ? (T)(int64)number : (T)(uint64)number;
+		return true;
+	}
+
+	bool ReadString(FString& outValue)
+	{
+		if (!PeekString())
+			return this->SetError(TEXT("expected a string"));
+		return Super::ReadString(outValue);
+	}
+
+	//calls func(index) for every element, func reads the element. false from func stops reading
+	template<typename FuncType> bool ReadArrayElements(FuncType&& func)
+	{
+		this->SkipWhitespace();
+		if (!this->HasMore() || this->ToCode(*this->Cur) != '[')
+			return this->SetError(TEXT("expected '['"));
+		if (++this->Depth > Super::MaxDepth)
+			return this->SetError(TEXT("maximum depth exceeded"));
+		++this->Cur;
+
+		this->SkipWhitespace();
+		if (this->HasMore() && this->ToCode(*this->Cur) == ']')
+		{
+			++this->Cur;
+			--this->Depth;
+			return true;
+		}
+
+		for (int32 index = 0; ; index++)
+		{
+			if (!func(index))
+				return this->SetError(TEXT("invalid element"));
+
+			this->SkipWhitespace();
+			if (!this->HasMore())
+				return this->SetError(TEXT("unterminated array"));
+
+			const uint32 c = this->ToCode(*this->Cur);
+			if (c == ']')
+			{
+				++this->Cur;
+				break;
+			}
+			if (c != ',')
+				return this->SetError(TEXT("expected ',' or ']'"));
+			++this->Cur;
+		}
+
+		--this->Depth;
+		return true;
+	}
+
+	/*
+	calls func(key) for every field, func reads the value (SkipValue for unknown keys). false from func stops reading.
+	the key is in the reader's scratch buffer, it changes once a string of the value is read
+	*/
+	template<typename FuncType> bool ReadObjectFields(FuncType&& func)
+	{
+		this->SkipWhitespace();
+		if (!this->HasMore() || this->ToCode(*this->Cur) != '{')
+			return this->SetError(TEXT("expected '{'"));
+		if (++this->Depth > Super::MaxDepth)
+			return this->SetError(TEXT("maximum depth exceeded"));
+		++this->Cur;
+
+		this->SkipWhitespace();
+		if (this->HasMore() && this->ToCode(*this->Cur) == '}')
+		{
+			++this->Cur;
+			--this->Depth;
+			return true;
+		}
+
+		for (;;)
+		{
+			if (!PeekString())
+				return this->SetError(TEXT("expected a string key"));
+			if (!Super::ReadString(this->Scratch))
+				return false;
+
+			this->SkipWhitespace();
+			if (!this->HasMore() || this->ToCode(*this->Cur) != ':')
+				return this->SetError(TEXT("expected ':'"));
+			++this->Cur;
+
+			if (!func(this->Scratch))
+				return this->SetError(TEXT("invalid field"));
+
+			this->SkipWhitespace();
+			if (!this->HasMore())
+				return this->SetError(TEXT("unterminated object"));
+
+			const uint32 c = this->ToCode(*this->Cur);
+			if (c == '}')
+			{
+				++this->Cur;
+				break;
+			}
+			if (c != ',')
+				return this->SetError(TEXT("expected ',' or '}'"));
+			++this->Cur;
+		}
+
+		--this->Depth;
+		return true;
+	}
+
+	//public for traits reporting their own errors, always returns false
+	using Super::SetError;
+};
+
+template<typename T, typename CharType> void JsonBPWriteTyped(TJsonBPWriter<CharType>& writer, const T& value)
+{
+	TJsonBPTypeTraits<T>::Write(writer, value);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//built in types
+
+template<>
+struct TJsonBPTypeTraits<bool>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, bool value) { writer.WriteBoolean(value); }
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, bool& outValue) { return reader.ReadBoolean(outValue); }
+};
+
+template<typename T>
+struct TJsonBPTypeTraits<T, typename TEnableIf<TIsIntegral<T>::Value && !TIsSame<T, bool>::Value>::Type>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, T value)
+	{
+		//uint64 values past int64 only fit a double
+		if (TIsSigned<T>::Value || (uint64)value <= (uint64)MAX_int64)
+			writer.WriteInteger((int64)value);
+		else
+			writer.WriteNumber((double)value);
+	}
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, T& outValue) { return reader.ReadInteger(outValue); }
+};
+
+template<typename T>
+struct TJsonBPTypeTraits<T, typename TEnableIf<TIsFloatingPoint<T>::Value>::Type>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, T value)
+	{
+		//floats print the way they were typed, see JsonBPFloatToDouble
+		writer.WriteNumber(sizeof(T) == sizeof(float) ? JsonBPFloatToDouble((float)value) : (double)value);
+	}
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, T& outValue)
+	{
+		double number;
+		int64 integer;
+		bool bInteger;
+		if (!reader.ReadNumber(number, integer, bInteger))
+			return false;
+		outValue = (T)number;
+		return true;
+	}
+};
+
+template<>
+struct TJsonBPTypeTraits<FString>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const FString& value) { writer.WriteString(value); }
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, FString& outValue) { return reader.ReadString(outValue); }
+};
+
+template<>
+struct TJsonBPTypeTraits<FName>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const FName& value) { writer.WriteString(value.ToString()); }
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, FName& outValue)
+	{
+		FString value;
+		if (!reader.ReadString(value))
+			return false;
+		outValue = FName(*value);
+		return true;
+	}
+};
+
+template<>
+struct TJsonBPTypeTraits<FText>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const FText& value) { writer.WriteString(value.ToString()); }
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, FText& outValue)
+	{
+		FString value;
+		if (!reader.ReadString(value))
+			return false;
+		outValue = FText::FromString(MoveTemp(value));
+		return true;
+	}
+};
+
+//the UEnum of enum classes declared with UENUM, null for other enums
+template<typename T> typename TEnableIf<TIsUEnumClass<T>::Value, const UEnum*>::Type JsonBPStaticEnum() { return StaticEnum<T>(); }
+template<typename T> typename TEnableIf<!TIsUEnumClass<T>::Value, const UEnum*>::Type JsonBPStaticEnum() { return nullptr; }
+
+template<typename T>
+struct TJsonBPTypeTraits<T, typename TEnableIf<TIsEnum<T>::Value>::Type>
+{
+	//values without a name are numbers, like enum properties of structs
+	static FString ToName(T value)
+	{
+		const UEnum* pEnum = JsonBPStaticEnum<T>();
+		return pEnum ? pEnum->GetNameStringByValue((int64)value) : FString();
+	}
+	static bool FromName(const FString& name, T& outValue)
+	{
+		const UEnum* pEnum = JsonBPStaticEnum<T>();
+		const int64 value = pEnum ? pEnum->GetValueByNameString(name) : INDEX_NONE;
+		if (value == INDEX_NONE)
+			return false;
+		outValue = (T)value;
+		return true;
+	}
+
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, T value)
+	{
+		const FString name = ToName(value);
+		if (name.IsEmpty())
+			writer.WriteInteger((int64)value);
+		else
+			writer.WriteString(name);
+	}
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, T& outValue)
+	{
+		if (reader.PeekString())
+		{
+			FString name;
+			if (!reader.ReadString(name))
+				return false;
+			return FromName(name, outValue) ? true : reader.SetError(TEXT("unknown enum name"));
+		}
+
+		int64 value;
+		if (!reader.ReadInteger(value))
+			return false;
+		outValue = (T)value;
+		return true;
+	}
+};
+
+template<typename T, typename Allocator>
+struct TJsonBPTypeTraits<TArray<T, Allocator>>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const TArray<T, Allocator>& value)
+	{
+		writer.BeginArray();
+		for (const T& element : value)
+			TJsonBPTypeTraits<T>::Write(writer, element);
+		writer.EndArray();
+	}
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, TArray<T, Allocator>& outValue)
+	{
+		outValue.Reset();
+		return reader.ReadArrayElements([&reader, &outValue](int32 index)
+		{
+			return reader.Read(outValue.AddDefaulted_GetRef());
+		});
+	}
+};
+
+template<typename T, typename KeyFuncs, typename Allocator>
+struct TJsonBPTypeTraits<TSet<T, KeyFuncs, Allocator>>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const TSet<T, KeyFuncs, Allocator>& value)
+	{
+		writer.BeginArray();
+		for (const T& element : value)
+			TJsonBPTypeTraits<T>::Write(writer, element);
+		writer.EndArray();
+	}
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, TSet<T, KeyFuncs, Allocator>& outValue)
+	{
+		outValue.Reset();
+		return reader.ReadArrayElements([&reader, &outValue](int32 index)
+		{
+			T element;
+			if (!reader.Read(element))
+				return false;
+			outValue.Add(MoveTemp(element));
+			return true;
+		});
+	}
+};
+
+template<typename K, typename V, typename Allocator, typename KeyFuncs>
+struct TJsonBPTypeTraits<TMap<K, V, Allocator, KeyFuncs>>
+{
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const TMap<K, V, Allocator, KeyFuncs>& value)
+	{
+		writer.BeginObject();
+		for (const auto& pair : value)
+		{
+			writer.WriteKey(TJsonBPKeyTraits<K>::ToKey(pair.Key));
+			TJsonBPTypeTraits<V>::Write(writer, pair.Value);
+		}
+		writer.EndObject();
+	}
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, TMap<K, V, Allocator, KeyFuncs>& outValue)
+	{
+		outValue.Reset();
+		return reader.ReadObjectFields([&reader, &outValue](const FString& name)
+		{
+			K key;
+			if (!TJsonBPKeyTraits<K>::FromKey(name, key))
+				return reader.SetError(TEXT("invalid key"));
+			//a repeated key keeps the last value
+			return reader.Read(outValue.Add(MoveTemp(key)));
+		});
+	}
+};
+
+template<typename T>
+struct TJsonBPTypeTraits<TOptional<T>>
+{
+	//unset is null
+	template<typename CharType> static void Write(TJsonBPWriter<CharType>& writer, const TOptional<T>& value)
+	{
+		if (value.IsSet())
+			TJsonBPTypeTraits<T>::Write(writer, value.GetValue());
+		else
+			writer.WriteNull();
+	}
+	template<typename CharType> static bool Read(TJsonBPTypedReader<CharType>& reader, TOptional<T>& outValue)
+	{
+		if (reader.PeekNull())
+		{
+			outValue.Reset();
+			return reader.ReadNull();
+		}
+		outValue.Emplace();
+		return reader.Read(outValue.GetValue());
+	}
+};
+
+template<>
+struct TJsonBPKeyTraits<FString>
+{
+	static const FString& ToKey(const FString& key) { return key; }
+	static bool FromKey(const FString& name, FString& outKey) { outKey = name; return true; }
+};
+
+template<>
+struct TJsonBPKeyTraits<FName>
+{
+	static FString ToKey(const FName& key) { return key.ToString(); }
+	static bool FromKey(const FString& name, FName& outKey) { outKey = FName(*name); return true; }
+};
+
+template<typename T>
+struct TJsonBPKeyTraits<T, typename TEnableIf<TIsIntegral<T>::Value && !TIsSame<T, bool>::Value>::Type>
+{
+	static FString ToKey(T key) { return LexToString(key); }
+	static bool FromKey(const FString& name, T& outKey) { return LexTryParseString(outKey, *name); }
+};
+
+template<typename T>
+struct TJsonBPKeyTraits<T, typename TEnableIf<TIsEnum<T>::Value>::Type>
+{
+	static FString ToKey(T key)
+	{
+		const FString name = TJsonBPTypeTraits<T>::ToName(key);
+		return name.IsEmpty() ? LexToString((int64)key) : name;
+	}
+	static bool FromKey(const FString& name, T& outKey)
+	{
+		if (TJsonBPTypeTraits<T>::FromName(name, outKey))
+			return true;
+
+		int64 value;
+		if (!LexTryParseString(value, *name))
+			return false;
+		outKey = (T)value;
+		return true;
+	}
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//entry points
+
+//writes the value as json text directly, nothing but the text is allocated
+template<typename T> FString HelperValueToJSONString(const T& value, bool bPretty = false)
+{
+	FString result;
+	TArray<TCHAR>& chars = result.GetCharArray();
+	TJsonBPWriter<TCHAR> writer(chars, bPretty);
+	TJsonBPTypeTraits<T>::Write(writer, value);
+	chars.Add(TEXT('\0'));
+	return result;
+}
+
+template<typename T> void HelperValueToJSONUTF8(const T& value, TArray<uint8>& out, bool bPretty = false)
+{
+	out.Reset();
+	TJsonBPWriter<uint8> writer(out, bPretty);
+	TJsonBPTypeTraits<T>::Write(writer, value);
+}
+
+template<typename T, typename CharType> bool HelperJSONTextToValue(const CharType* text, int32 length, T& outValue, FString* outError)
+{
+	TJsonBPTypedReader<CharType> reader(text, length);
+	if (reader.ReadTypedDocument(outValue))
+		return true;
+
+	if (outError)
+		*outError = reader.GetErrorText();
+	return false;
+}
+
+//parses the text straight into the value. on failure outValue is partly filled and outError (if given) says where it failed
+template<typename T> bool HelperJSONStringToValue(const FString& json, T& outValue, FString* outError = nullptr)
+{
+	return HelperJSONTextToValue(*json, json.Len(), outValue, outError);
+}
+
+template<typename T> bool HelperJSONUTF8ToValue(TArrayView<const uint8> bytes, T& outValue, FString* outError = nullptr)
+{
+	return HelperJSONTextToValue(bytes.GetData(), bytes.Num(), outValue, outError);
+}
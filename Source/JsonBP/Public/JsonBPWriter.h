@@ -0,0 +1,426 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//float values are kept as the shortest decimal that round trips, so they print the way they were typed
+JSONBP_API double JsonBPFloatToDouble(float value);
+
+//a UTF-16 unit is at most 3 bytes (a pair is 4), a UTF-32 one at most 4
+static const int32 JsonBPMaxUTF8BytesPerChar = sizeof(TCHAR) == 2 ? 3 : 4;
+
+/*
+encodes TCHAR text as UTF-8, dest needs room for length * JsonBPMaxUTF8BytesPerChar bytes.
+stops before a lone surrogate or an invalid code point since they have no UTF-8 form.
+returns the number of bytes written, outNumEncoded is the number of characters consumed.
+*/
+inline int32 JsonBPEncodeUTF8(const TCHAR* text, int32 length, uint8* dest, int32& outNumEncoded)
+{
+	uint8* pDest = dest;
+	int32 i = 0;
+	for (; i < length; i++)
+	{
+		uint32 codePoint = (uint32)text[i];
+		if (codePoint < 0x80)
+		{
+			*pDest++ = (uint8)codePoint;
+			continue;
+		}
+
+		if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < length && (uint32)text[i + 1] >= 0xDC00 && (uint32)text[i + 1] <= 0xDFFF)
+			codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + ((uint32)text[++i] - 0xDC00);
+		else if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+			break;
+
+		if (codePoint < 0x800)
+		{
+			*pDest++ = (uint8)(0xC0 | (codePoint >> 6));
+		}
+		else if (codePoint < 0x10000)
+		{
+			*pDest++ = (uint8)(0xE0 | (codePoint >> 12));
+			*pDest++ = (uint8)(0x80 | ((codePoint >> 6) & 0x3F));
+		}
+		else
+		{
+			*pDest++ = (uint8)(0xF0 | (codePoint >> 18));
+			*pDest++ = (uint8)(0x80 | ((codePoint >> 12) & 0x3F));
+			*pDest++ = (uint8)(0x80 | ((codePoint >> 6) & 0x3F));
+		}
+		*pDest++ = (uint8)(0x80 | (codePoint & 0x3F));
+	}
+
+	outNumEncoded = i;
+	return (int32)(pDest - dest);
+}
+
+/*
+receives the output of a TJsonBPWriter in chunks, so documents don't need to be in memory as a whole.
+*/
+template<typename CharType>
+class IJsonBPOutputSink
+{
+public:
+	virtual ~IJsonBPOutputSink() {}
+
+	//the chunk is only valid during the call
+	virtual void Write(const CharType* chunk, int32 length) = 0;
+};
+
+/*
+streaming json writer appending to a TCHAR or UTF-8 (ANSICHAR or uint8) buffer.
+commas, indentation and key/value separators are handled by the writer so callers just emit values in order:
+
+	TJsonBPWriter<TCHAR> writer(buffer, false);
+	writer.BeginObject();
+	writer.WriteKey(TEXT("id"));
+	writer.WriteNumber(12);
+	writer.EndObject();
+
+pretty mode uses tabs and the platform line terminator like TPrettyJsonPrintPolicy.
+with a sink the buffer is handed to the sink and emptied whenever it grows past flushSize, call Flush() once done.
+*/
+template<typename CharType>
+class TJsonBPWriter
+{
+	static_assert(sizeof(CharType) == 1 || TIsSame<CharType, TCHAR>::Value, "TJsonBPWriter supports TCHAR or UTF-8 output");
+
+public:
+	TJsonBPWriter(TArray<CharType>& out, bool bPretty)
+		: Out(out), Sink(nullptr), FlushSize(0), bPretty(bPretty), bAfterKey(false)
+	{
+	}
+
+	TJsonBPWriter(TArray<CharType>& buffer, bool bPretty, IJsonBPOutputSink<CharType>& sink, int32 flushSize = 64 * 1024)
+		: Out(buffer), Sink(&sink), FlushSize(flushSize), bPretty(bPretty), bAfterKey(false)
+	{
+		Out.Reserve(flushSize + 1024);
+	}
+
+	//hands everything written so far to the sink
+	void Flush()
+	{
+		if (Sink && Out.Num() > 0)
+		{
+			Sink->Write(Out.GetData(), Out.Num());
+			Out.Reset();
+		}
+	}
+
+	void WriteNull()
+	{
+		BeforeValue();
+		AppendAscii("null", 4);
+	}
+
+	void WriteBoolean(bool value)
+	{
+		BeforeValue();
+		if (value)
+			AppendAscii("true", 4);
+		else
+			AppendAscii("false", 5);
+	}
+
+	//writes the shortest text that reads back as the same double. json has no nan or infinity, they are written as null
+	void WriteNumber(double value)
+	{
+		BeforeValue();
+		if (!FMath::IsFinite(value))
+		{
+			AppendAscii("null", 4);
+			return;
+		}
+
+		//whole numbers below 10^15 print the same as with %.15g, without the formatting and reading back
+		if (FMath::Abs(value) < 1e15 && value == (double)(int64)value && !(value == 0 && FMath::IsNegativeDouble(value)))
+		{
+			AppendInteger((int64)value);
+			return;
+		}
+
+		//17 significant digits always round trip, fewer are tried first
+		ANSICHAR buffer[64];
+		int32 length = 0;
+		for (int32 precision = 15; precision <= 17; precision++)
+		{
+			length = FCStringAnsi::Snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+			if (precision == 17 || FCStringAnsi::Atod(buffer) == value)
+				break;
+		}
+		AppendAscii(buffer, length);
+	}
+
+	void WriteInteger(int64 value)
+	{
+		BeforeValue();
+		AppendInteger(value);
+	}
+
+	void WriteString(const TCHAR* value, int32 length)
+	{
+		BeforeValue();
+		AppendQuoted(value, length);
+	}
+
+	void WriteString(const FString& value)
+	{
+		WriteString(*value, value.Len());
+	}
+
+	void WriteKey(const TCHAR* key, int32 length)
+	{
+		BeforeValue();
+		AppendQuoted(key, length);
+		Out.Add(CharType(':'));
+		if (bPretty)
+			Out.Add(CharType(' '));
+		bAfterKey = true;
+	}
+
+	void WriteKey(const FString& key)
+	{
+		WriteKey(*key, key.Len());
+	}
+
+	void BeginArray()
+	{
+		BeforeValue();
+		Out.Add(CharType('['));
+		Levels.Add(false);
+	}
+
+	void EndArray()
+	{
+		EndContainer(CharType(']'));
+	}
+
+	void BeginObject()
+	{
+		BeforeValue();
+		Out.Add(CharType('{'));
+		Levels.Add(false);
+	}
+
+	void EndObject()
+	{
+		EndContainer(CharType('}'));
+	}
+
+	/*
+	writing the items of a container in separate pieces, ParallelFor writes them on different threads:
+	each piece's writer calls BeginFragment(depth of the container, true if pieces come before it) and writes its items,
+	then the pieces are added to the writer of the container with AppendFragment. the text is the same as writing the items in one go
+	*/
+	void BeginFragment(int32 depth, bool bHasItemsBefore)
+	{
+		Levels.Reset();
+		Levels.AddZeroed(depth);
+		if (depth > 0)
+			Levels.Last() = bHasItemsBefore;
+	}
+
+	void AppendFragment(const CharType* text, int32 length)
+	{
+		if (length == 0)
+			return;
+
+		if (Sink && Out.Num() >= FlushSize)
+			Flush();
+		Out.Append(text, length);
+		if (Levels.Num() > 0)
+			Levels.Last() = true;
+	}
+
+	/*
+	cutting the text of one value out of the output (the text caches of UJsonValue): MarkValueStart writes the separator the next value needs
+	and returns where its text starts, the value is then written as usual. WriteRawValue writes such a text back as one value.
+	only for writers without a sink, the output must stay in the buffer
+	*/
+	int32 MarkValueStart()
+	{
+		check(!Sink);
+		BeforeValue();
+		bAfterKey = true;
+		return Out.Num();
+	}
+
+	void WriteRawValue(const CharType* text, int32 length)
+	{
+		BeforeValue();
+		Out.Append(text, length);
+	}
+
+	bool IsPretty() const { return bPretty; }
+	TArray<CharType>& GetOutput() { return Out; }
+
+private:
+	//digits by hand, numeric arrays write a lot of them
+	void AppendInteger(int64 value)
+	{
+		ANSICHAR buffer[24];
+		ANSICHAR* pEnd = buffer + sizeof(buffer);
+		ANSICHAR* pDigit = pEnd;
+		uint64 magnitude = value < 0 ? 0 - (uint64)value : (uint64)value;
+		do
+		{
+			*--pDigit = (ANSICHAR)('0' + magnitude % 10);
+			magnitude /= 10;
+		} while (magnitude != 0);
+		if (value < 0)
+			*--pDigit = '-';
+		AppendAscii(pDigit, (int32)(pEnd - pDigit));
+	}
+
+	void BeforeValue()
+	{
+		if (Sink && Out.Num() >= FlushSize)
+			Flush();
+
+		if (bAfterKey)
+		{
+			bAfterKey = false;
+			return;
+		}
+
+		if (Levels.Num() == 0)
+			return;
+
+		bool& bHasItems = Levels.Last();
+		if (bHasItems)
+			Out.Add(CharType(','));
+		bHasItems = true;
+
+		if (bPretty)
+			NewLine(Levels.Num());
+	}
+
+	void EndContainer(CharType closing)
+	{
+		const bool bHadItems = Levels.Pop(false);
+		if (bPretty && bHadItems)
+			NewLine(Levels.Num());
+		Out.Add(closing);
+	}
+
+	void NewLine(int32 indent)
+	{
+		for (const TCHAR* pTerminator = LINE_TERMINATOR; *pTerminator; ++pTerminator)
+			Out.Add((CharType)*pTerminator);
+		for (int32 i = 0; i < indent; i++)
+			Out.Add(CharType('\t'));
+	}
+
+	void AppendAscii(const ANSICHAR* text, int32 length)
+	{
+		const int32 start = Out.AddUninitialized(length);
+		CharType* pDest = Out.GetData() + start;
+		for (int32 i = 0; i < length; i++)
+			pDest[i] = (CharType)text[i];
+	}
+
+	static FORCEINLINE bool NeedsEscape(TCHAR c)
+	{
+		return c == TEXT('"') || c == TEXT('\\') || (uint32)c < 0x20;
+	}
+
+	void AppendRun(const TCHAR* run, int32 count, TCHAR*)
+	{
+		Out.Append(run, count);
+	}
+
+	//encodes UTF-8 straight into the output, no temporary conversion buffer
+	template<typename ByteType> void AppendRun(const TCHAR* run, int32 count, ByteType*)
+	{
+		while (count > 0)
+		{
+			const int32 start = Out.AddUninitialized(count * JsonBPMaxUTF8BytesPerChar);
+			int32 numEncoded;
+			const int32 numBytes = JsonBPEncodeUTF8(run, count, (uint8*)Out.GetData() + start, numEncoded);
+			Out.SetNum(start + numBytes, false);
+			run += numEncoded;
+			count -= numEncoded;
+
+			if (count > 0)
+			{
+				//a lone surrogate has no UTF-8 form, the escape keeps the text valid json
+				ANSICHAR buffer[8];
+				FCStringAnsi::Snprintf(buffer, sizeof(buffer), "\\u%04x", (uint32)*run & 0xFFFF);
+				AppendAscii(buffer, 6);
+				++run;
+				--count;
+			}
+		}
+	}
+
+	void AppendQuoted(const TCHAR* value, int32 length)
+	{
+		Out.Add(CharType('"'));
+
+		const TCHAR* pCur = value;
+		const TCHAR* pEnd = value + length;
+		while (pCur != pEnd)
+		{
+			const TCHAR* runStart = pCur;
+			while (pCur != pEnd && !NeedsEscape(*pCur))
+				++pCur;
+
+			if (pCur != runStart)
+				AppendRun(runStart, (int32)(pCur - runStart), (CharType*)nullptr);
+
+			if (pCur == pEnd)
+				break;
+
+			switch (*pCur)
+			{
+			case TEXT('"'): AppendAscii("\\\"", 2); break;
+			case TEXT('\\'): AppendAscii("\\\\", 2); break;
+			case TEXT('\n'): AppendAscii("\\n", 2); break;
+			case TEXT('\r'): AppendAscii("\\r", 2); break;
+			case TEXT('\t'): AppendAscii("\\t", 2); break;
+			case TEXT('\b'): AppendAscii("\\b", 2); break;
+			case TEXT('\f'): AppendAscii("\\f", 2); break;
+			default:
+			{
+				ANSICHAR buffer[8];
+				FCStringAnsi::Snprintf(buffer, sizeof(buffer), "\\u%04x", (uint32)*pCur);
+				AppendAscii(buffer, 6);
+			}
+			}
+			++pCur;
+		}
+
+		Out.Add(CharType('"'));
+	}
+
+	TArray<CharType>& Out;
+	IJsonBPOutputSink<CharType>* Sink;
+	int32 FlushSize;
+	bool bPretty;
+	bool bAfterKey;
+	//one entry per open container, true once it has an item
+	TArray<bool, TInlineAllocator<32>> Levels;
+};
+
+/*
+reader handler forwarding every event to a TJsonBPWriter, so anything that produces handler events can write text.
+*/
+template<typename CharType>
+class TJsonBPWriterHandler
+{
+public:
+	explicit TJsonBPWriterHandler(TJsonBPWriter<CharType>& writer) : Writer(writer) {}
+
+	bool OnNull() { Writer.WriteNull(); return true; }
+	bool OnBoolean(bool value) { Writer.WriteBoolean(value); return true; }
+	bool OnNumber(double value) { Writer.WriteNumber(value); return true; }
+	bool OnInteger(int64 value) { Writer.WriteInteger(value); return true; }
+	bool OnString(const FString& value) { Writer.WriteString(value); return true; }
+	bool OnArrayBegin() { Writer.BeginArray(); return true; }
+	bool OnArrayEnd() { Writer.EndArray(); return true; }
+	bool OnObjectBegin() { Writer.BeginObject(); return true; }
+	bool OnObjectKey(const FString& key) { Writer.WriteKey(key); return true; }
+	bool OnObjectEnd() { Writer.EndObject(); return true; }
+
+private:
+	TJsonBPWriter<CharType>& Writer;
+};